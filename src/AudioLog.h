@@ -0,0 +1,337 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * AudioLog - Lock-free diagnostics for the audio thread
+ *
+ * Audio-path code used to build juce::Strings for DBG and append to a log file from
+ * inside the callback, which allocates and blocks on disk. Instead the audio thread
+ * (and the layer workers when layers render in parallel) pushes fixed-size binary
+ * records (event id + numeric args) into a per-engine lock-free ring, and one
+ * process-wide AudioLogWriter thread drains every ring, formats the records and
+ * appends them to the debug log. Logging stays on in release builds at the cost of
+ * one 64-byte copy per event.
+ *
+ * When a ring is full the record is dropped and counted; the writer reports the loss.
+ */
+namespace AudioLogEvents
+{
+    enum class Event : juce::uint32
+    {
+        RecordingStarted = 0,
+        RecordingStopped,
+        RecordingBudgetExhausted,
+        OverdubStartedOnNewLayer,
+        OverdubFadeOutStarted,
+        OverdubStoppedImmediate,
+        OverdubFadeOutComplete,
+        PlaybackRateChanged,
+        PitchGrainState,
+        CrossfadeLengthAdjusted,
+        CrossfadeRealtime,
+        LayerRenderedWithEffects,
+        BufferSoftClipped,
+        DCOffsetRemoved,
+        BufferSet,
+        BufferSetSeamless,
+        LayerShared,
+        LayerMoved,
+        MasterLengthRecovered,
+        LayerBounceStart,
+        LayerBounceComplete,
+        LayerBounceReset,
+        CrossfadeCheck,
+        CrossfadeZone,
+        FlattenStarted,
+        FlattenComplete,
+        FlattenAborted,
+        AdditiveLayerCommitted,
+        AdditiveLayerSkipped,
+        CommandApplied,
+        CommandDropped,
+        PlaybackCacheInstalled,
+        PlaybackCacheFailed,
+        PitchShiftChanged,
+        LoopStartChanged,
+        LoopEndChanged,
+        ReverseChanged,
+        FlattenBusy,
+        NumEvents
+    };
+
+    static constexpr int MAX_ARGS = 6;
+
+    struct EventInfo
+    {
+        const char* name;
+        std::array<const char*, MAX_ARGS> argNames;  // nullptr = unused
+    };
+
+    // Indexed by Event - keep in the same order
+    inline const EventInfo& getInfo(Event event)
+    {
+        static const EventInfo infos[] = {
+            { "recording started",        { "targetLength" } },
+            { "recording stopped",        { "loopLength", "sampleRate", "continueToOverdub", "rateTarget" } },
+            { "recording budget exhausted", { "writeHead" } },
+            { "overdub started on new layer", { "loopLength" } },
+            { "overdub fade out started", {} },
+            { "overdub stopped immediately", {} },
+            { "overdub fade-out complete", {} },
+            { "playback rate changed",    { "requested", "clamped" } },
+            { "pitch grain state",        { "pitchRatio", "readPos1", "playHead", "grainPhase" } },
+            { "crossfade length adjusted", { "oldLength", "newLength" } },
+            { "crossfade realtime",       {} },
+            { "layer rendered with effects", { "volume", "pan", "pitchSemitones", "reversed", "eqActive" } },
+            { "buffer soft clipped",      { "loopLength" } },
+            { "DC offset removed",        { "dcL", "dcR" } },
+            { "buffer set",               { "loopLength" } },
+            { "buffer set seamless",      { "loopLength", "playhead" } },
+            { "layer shared",             { "loopLength" } },
+            { "layer moved",              { "loopLength" } },
+            { "master length recovered",  { "masterLoopLength" } },
+            { "layer bounce start",       { "layer", "startSample", "loopLength" } },
+            { "layer bounce complete",    { "recorded" } },
+            { "layer bounce reset",       {} },
+            { "crossfade check",          { "loopLength", "content", "state", "highestLayer" } },
+            { "crossfade zone",           { "pos", "preThreshold", "inPre", "countdown", "filterFreq", "filterMix" } },
+            { "flatten started",          { "layers" } },
+            { "flatten complete",         {} },
+            { "flatten aborted",          { "loopLength" } },
+            { "ADD+ layer committed",     { "loopLength" } },
+            { "ADD+ layer skipped",       { "captured", "loopLength" } },
+            { "command applied",          { "command", "layer", "flag", "state", "currentLayer", "highestLayer" } },
+            { "command dropped",          { "command", "layer" } },
+            { "playback cache installed", { "regionLength", "pitchRatio", "reversed", "eqActive" } },
+            { "playback cache failed",    { "regionLength" } },
+            { "pitch shift changed",      { "semitones", "ratio" } },
+            { "loop start changed",       { "normalizedPos" } },
+            { "loop end changed",         { "normalizedPos" } },
+            { "reverse changed",          { "reversed" } },
+            { "flatten ignored - one in progress", { "highestLayer" } },
+        };
+        static_assert(sizeof(infos) / sizeof(infos[0]) == static_cast<size_t>(Event::NumEvents),
+                      "AudioLog event table out of sync with Event");
+        return infos[static_cast<size_t>(event)];
+    }
+}
+
+class AudioLog
+{
+public:
+    using Event = AudioLogEvents::Event;
+    static constexpr int MAX_ARGS = AudioLogEvents::MAX_ARGS;
+    static constexpr int RING_SIZE = 2048;  // Power of two
+
+    struct Record
+    {
+        double timeMs = 0.0;
+        Event event = Event::NumEvents;
+        juce::int32 source = -1;  // Layer index, or -1 for the engine
+        std::array<double, MAX_ARGS> args {};
+    };
+
+    // Bounded multi-producer/single-consumer ring (per-cell sequence numbers): layers can
+    // log from the audio thread and from parallel layer workers, the writer pops
+    class Ring
+    {
+    public:
+        Ring()
+        {
+            for (juce::uint32 i = 0; i < static_cast<juce::uint32>(RING_SIZE); ++i)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        bool push(const Record& record) noexcept
+        {
+            juce::uint32 write = writeIndex.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Cell& cell = cells[write & (RING_SIZE - 1)];
+                const auto diff = static_cast<juce::int32>(cell.sequence.load(std::memory_order_acquire) - write);
+
+                if (diff == 0)
+                {
+                    // Cell is free for this position - claim it
+                    if (writeIndex.compare_exchange_weak(write, write + 1, std::memory_order_relaxed))
+                    {
+                        cell.record = record;
+                        cell.sequence.store(write + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // Writer hasn't popped this cell's previous record yet
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                else
+                {
+                    write = writeIndex.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool pop(Record& record) noexcept
+        {
+            Cell& cell = cells[readIndex & (RING_SIZE - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != readIndex + 1)
+                return false;
+
+            record = cell.record;
+            cell.sequence.store(readIndex + static_cast<juce::uint32>(RING_SIZE), std::memory_order_release);
+            ++readIndex;
+            return true;
+        }
+
+        int takeDroppedCount() noexcept { return dropped.exchange(0); }
+
+    private:
+        struct Cell
+        {
+            std::atomic<juce::uint32> sequence { 0 };
+            Record record;
+        };
+
+        std::array<Cell, RING_SIZE> cells;
+        std::atomic<juce::uint32> writeIndex { 0 };
+        juce::uint32 readIndex = 0;  // Writer thread only
+        std::atomic<int> dropped { 0 };
+    };
+
+    AudioLog() { writer->registerRing(&ring); }
+    ~AudioLog() { writer->unregisterRing(&ring); }
+
+    // Lock-free, allocation-free: safe anywhere on the audio thread
+    void log(Event event, juce::int32 source = -1,
+             double a0 = 0.0, double a1 = 0.0, double a2 = 0.0,
+             double a3 = 0.0, double a4 = 0.0, double a5 = 0.0) noexcept
+    {
+        Record record;
+        record.timeMs = juce::Time::getMillisecondCounterHiRes();
+        record.event = event;
+        record.source = source;
+        record.args = { a0, a1, a2, a3, a4, a5 };
+        ring.push(record);
+    }
+
+private:
+    // Process-wide background writer shared by every engine's ring
+    class Writer : private juce::Thread
+    {
+    public:
+        Writer() : juce::Thread("AudioLogWriter")
+        {
+            startThread(juce::Thread::Priority::background);
+        }
+
+        ~Writer() override
+        {
+            stopThread(2000);
+            drainAll();  // Whatever arrived after the last pass
+        }
+
+        void registerRing(Ring* ring)
+        {
+            const juce::ScopedLock lock(ringLock);
+            rings.push_back(ring);
+        }
+
+        // Drains the ring first so nothing logged before destruction is lost
+        void unregisterRing(Ring* ring)
+        {
+            const juce::ScopedLock lock(ringLock);
+            drainRing(*ring);
+            rings.erase(std::remove(rings.begin(), rings.end(), ring), rings.end());
+            flushOutput();
+        }
+
+    private:
+        juce::CriticalSection ringLock;  // Registration vs draining - never taken by the audio thread
+        std::vector<Ring*> rings;
+        std::unique_ptr<juce::FileOutputStream> output;
+
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                drainAll();
+                wait(50);
+            }
+        }
+
+        void drainAll()
+        {
+            const juce::ScopedLock lock(ringLock);
+            for (Ring* ring : rings)
+                drainRing(*ring);
+            flushOutput();
+        }
+
+        void drainRing(Ring& ring)
+        {
+            Record record;
+            while (ring.pop(record))
+                writeLine(format(record));
+
+            if (const int dropped = ring.takeDroppedCount())
+                writeLine("AudioLog: " + juce::String(dropped) + " records dropped (ring full)");
+        }
+
+        static juce::String format(const Record& record)
+        {
+            const auto& info = AudioLogEvents::getInfo(record.event);
+            juce::String line = "[audio " + juce::String(record.timeMs, 1) + "ms]";
+            if (record.source >= 0)
+                line << " layer " << (record.source + 1) << ":";
+            line << " " << info.name;
+
+            for (int i = 0; i < MAX_ARGS; ++i)
+            {
+                if (info.argNames[static_cast<size_t>(i)] == nullptr)
+                    break;
+                line << " " << info.argNames[static_cast<size_t>(i)] << "="
+                     << juce::String(record.args[static_cast<size_t>(i)], 3);
+            }
+            return line;
+        }
+
+        void writeLine(const juce::String& line)
+        {
+            DBG(line);
+
+            if (output == nullptr)
+            {
+                // Same file the audio path used to append to directly
+                const auto logFile = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                    .getChildFile("LoopEngine_debug.log");
+                output = std::make_unique<juce::FileOutputStream>(logFile);
+                if (output->failedToOpen())
+                    return;
+            }
+
+            if (output->openedOk())
+                *output << juce::Time::getCurrentTime().toString(true, true) << " - " << line << "\n";
+        }
+
+        void flushOutput()
+        {
+            if (output != nullptr && output->openedOk())
+                output->flush();
+        }
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Writer)
+    };
+
+    Ring ring;
+    juce::SharedResourcePointer<Writer> writer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioLog)
+};
@@ -0,0 +1,521 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "LoopBuffer.h"
+#include "LoopMemoryManager.h"
+#include "OutputMixKernel.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+/**
+ * LayerRenderService - Flatten and export renders off the audio thread
+ *
+ * These renders used to walk whole loops synchronously: flatten inside the audio callback,
+ * export on the message thread while the audio thread kept writing the layers it was
+ * reading. Each engine now owns one service with a job slot per kind,
+ * and a job moves through:
+ *
+ *   Idle -> Requested       the message thread asks for a render
+ *   Requested -> Capturing  the audio thread snapshots the layers - chunk references and
+ *   -> Rendering            effect parameters, O(layers x chunks), no audio copied - and
+ *                           hands the job over
+ *   Rendering -> Done       worker threads render the layers in parallel; the last one to
+ *                           finish sums, soft clips and writes the result
+ *   Done -> Idle            the consumer takes the result. A flatten result is a chunk
+ *                           table the audio thread swaps into layer 0 in O(1).
+ *
+ * Each layer also has a playback cache job (see LoopBuffer::renderPlaybackCache): the audio
+ * thread captures and submits it directly (Idle -> Rendering), one worker renders it, and
+ * the audio thread swaps the result into the layer (Done -> Idle).
+ *
+ * The worker threads are shared by every engine in the process (SharedResourcePointer)
+ * and poll the registered services, so the audio thread never signals, locks or
+ * allocates. Layers are split across slots (layer l goes to slot l % numSlots), workers
+ * claim slots through an atomic counter, and partial sums are added in slot order - the
+ * output is the same whichever worker rendered what.
+ */
+class LayerRenderService
+{
+public:
+    static constexpr int MAX_LAYERS = 8;
+    static constexpr int MAX_WORKERS = 4;
+
+    enum class Kind
+    {
+        Flatten = 0,     // All audible layers -> chunk table for layer 0
+        Export           // All audible layers -> AudioBuffer for the WAV writer
+    };
+
+    static constexpr int NUM_KINDS = 2;
+
+    enum class Stage
+    {
+        Idle = 0,
+        Requested,
+        Capturing,
+        Rendering,
+        Done
+    };
+
+    // One layer's audio (retained copy-on-write) and effect parameters at capture time
+    struct LayerSnapshot
+    {
+        LoopStorage::Snapshot audio;
+        LoopBuffer::EffectsRenderState params;
+    };
+
+    struct Job
+    {
+        std::atomic<Stage> stage { Stage::Idle };
+
+        // Filled in by the capturing thread before submit()
+        int length = 0;
+        int numLayers = 0;
+        int tag = 0;                       // Caller data carried through to the consumer
+        std::array<juce::uint32, MAX_LAYERS> contentVersions {};  // Caller data: layer audio versions at capture
+        std::array<LayerSnapshot, MAX_LAYERS> layers;
+
+        // Output
+        LoopStorage result;                // Flatten
+        WaveformPyramid resultPeaks;
+        juce::AudioBuffer<float> mix;      // Export
+        juce::int64 mixBytes = 0;          // Budget charged for mix, released by finish()
+        bool failed = false;               // Memory budget ran out for the partials or the result
+
+        // Worker bookkeeping
+        int numSlots = 0;
+        std::atomic<int> nextSlot { 0 };
+        std::atomic<int> slotsDone { 0 };
+        std::atomic<bool> overBudget { false };  // A slot couldn't charge its partial to the budget
+        std::array<juce::AudioBuffer<float>, MAX_WORKERS> partials;  // Each charged to the budget while sized
+    };
+
+    // One layer's pre-rendered playback cache
+    struct CacheJob
+    {
+        std::atomic<Stage> stage { Stage::Idle };
+        std::atomic<bool> claimed { false };  // A worker has taken it
+
+        std::atomic<bool> stale { false };    // Audio thread: the layer moved on - abandon the render
+
+        LoopStorage::Snapshot audio;
+        LoopBuffer::PlaybackCacheRender render;
+        LoopStorage result;
+        bool failed = false;                  // Memory budget (or its headroom) ran out
+        bool cancelled = false;               // Abandoned - nothing to install, nothing to remember
+    };
+
+    // Cache renders leave this many chunks of the memory budget free for recording
+    static constexpr int CACHE_HEADROOM_CHUNKS = 16;
+
+    LayerRenderService()
+    {
+        memoryManager->registerClient(&memoryClient);
+        workers->registerService(this);
+    }
+
+    ~LayerRenderService()
+    {
+        pausing.store(true);
+        workers->unregisterService(this);
+        for (auto& job : jobs)
+            releaseMix(job);
+        memoryManager->unregisterClient(&memoryClient);
+    }
+
+    // Give pool memory back before the engine re-prepares its chunk pool (message thread)
+    void detach()
+    {
+        const ScopedPause pause(*this);
+        for (auto& job : jobs)
+        {
+            for (auto& layer : job.layers)
+                layer.audio.reset();
+            job.result.detach();
+            job.resultPeaks.reset();
+            job.stage.store(Stage::Idle);
+        }
+        for (auto& job : cacheJobs)
+        {
+            job.audio.reset();
+            job.result.detach();
+            job.stage.store(Stage::Idle);
+        }
+    }
+
+    // Size snapshots and result tables for the pool's max loop length (message thread)
+    void prepare(LoopChunkPool& chunkPool, int maxSamples)
+    {
+        const ScopedPause pause(*this);
+        for (int k = 0; k < NUM_KINDS; ++k)
+        {
+            auto& job = jobs[static_cast<size_t>(k)];
+            const Kind kind = static_cast<Kind>(k);
+
+            for (auto& layer : job.layers)
+                layer.audio.prepare(chunkPool, maxSamples);
+
+            if (kind != Kind::Export)
+            {
+                job.result.prepare(chunkPool, maxSamples);
+                job.result.setBackgroundWriter(0);  // Written by a worker - keep off the audio thread's spares
+                job.resultPeaks.prepare(job.result, maxSamples);
+            }
+            job.stage.store(Stage::Idle);
+        }
+        for (auto& job : cacheJobs)
+        {
+            job.audio.prepare(chunkPool, maxSamples);
+            job.result.prepare(chunkPool, maxSamples);
+            job.result.setBackgroundWriter(CACHE_HEADROOM_CHUNKS);
+            job.stage.store(Stage::Idle);
+        }
+    }
+
+    Job& getJob(Kind kind) { return jobs[static_cast<size_t>(kind)]; }
+    const Job& getJob(Kind kind) const { return jobs[static_cast<size_t>(kind)]; }
+
+    Stage getStage(Kind kind) const { return getJob(kind).stage.load(std::memory_order_acquire); }
+    bool isIdle(Kind kind) const { return getStage(kind) == Stage::Idle; }
+
+    // Ask the audio thread to capture a job. Fails if one of this kind is already in flight.
+    bool request(Kind kind)
+    {
+        Stage expected = Stage::Idle;
+        return getJob(kind).stage.compare_exchange_strong(expected, Stage::Requested);
+    }
+
+    // Withdraw a request the audio thread hasn't captured yet. Fails once it has.
+    bool cancelRequest(Kind kind)
+    {
+        Stage expected = Stage::Requested;
+        return getJob(kind).stage.compare_exchange_strong(expected, Stage::Idle);
+    }
+
+    // Audio thread: claim a requested job for capture, or nullptr if none is pending
+    Job* takeRequest(Kind kind)
+    {
+        Stage expected = Stage::Requested;
+        auto& job = getJob(kind);
+        return job.stage.compare_exchange_strong(expected, Stage::Capturing) ? &job : nullptr;
+    }
+
+    // Captured job turned out to have nothing to render
+    void cancelCapture(Job& job)
+    {
+        for (auto& layer : job.layers)
+            layer.audio.reset();
+        job.stage.store(Stage::Idle);
+    }
+
+    // layers/length/tag are filled in - start rendering
+    void submit(Job& job)
+    {
+        job.failed = false;
+        job.numSlots = std::max(1, std::min(job.numLayers, workers->getNumWorkers()));
+        job.nextSlot.store(0);
+        job.slotsDone.store(0);
+        job.overBudget.store(false);
+        job.stage.store(Stage::Rendering, std::memory_order_release);
+    }
+
+    // Consumer: the result has been taken (or swapped for a layer's old audio) - drop it.
+    // release() is O(1); old chunks are zeroed by the pool's maintenance thread.
+    void finish(Job& job)
+    {
+        job.result.release();
+        job.resultPeaks.reset();
+        releaseMix(job);
+        job.stage.store(Stage::Idle, std::memory_order_release);
+    }
+
+    CacheJob& getCacheJob(int layer) { return cacheJobs[static_cast<size_t>(layer)]; }
+
+    // Audio thread: audio and render parameters are captured - start rendering
+    void submitCache(CacheJob& job)
+    {
+        job.failed = false;
+        job.cancelled = false;
+        job.stale.store(false);
+        job.claimed.store(false);
+        job.stage.store(Stage::Rendering, std::memory_order_release);
+    }
+
+    // Audio thread: the result has been installed (swapped for the layer's old cache) or
+    // discarded - drop it. O(1), as for finish().
+    void finishCache(CacheJob& job)
+    {
+        job.result.release();
+        job.stage.store(Stage::Idle, std::memory_order_release);
+    }
+
+private:
+    std::array<Job, NUM_KINDS> jobs;
+    std::array<CacheJob, MAX_LAYERS> cacheJobs;
+    std::atomic<int> activeWorkers { 0 };
+    std::atomic<bool> pausing { false };  // Cache renders bail out so ScopedPause doesn't wait on them
+
+    // Partials and export mixes are leased from the same budget as the chunk pools
+    juce::SharedResourcePointer<LoopMemoryManager> memoryManager;
+    LoopMemoryManager::Client memoryClient;
+
+    static juce::int64 partialBytes(int length)
+    {
+        return 2 * static_cast<juce::int64>(length) * static_cast<juce::int64>(sizeof(float));
+    }
+
+    // Free a partial and give its lease back (no-op if it was never sized)
+    void releasePartial(juce::AudioBuffer<float>& partial)
+    {
+        if (partial.getNumSamples() > 0)
+            memoryManager->release(memoryClient, partialBytes(partial.getNumSamples()));
+        partial.setSize(0, 0);
+    }
+
+    void releaseMix(Job& job)
+    {
+        if (job.mixBytes > 0)
+            memoryManager->release(memoryClient, job.mixBytes);
+        job.mixBytes = 0;
+        job.mix.setSize(0, 0);
+    }
+
+    // Called by a worker between register and unregister; renders every flatten/export slot
+    // it can claim, then at most one playback cache - a cache render takes a while, and the
+    // next call checks jobs[] again first. cacheScratch belongs to the calling worker.
+    void work(LoopBuffer::PlaybackCacheScratch& cacheScratch)
+    {
+        for (auto& job : jobs)
+        {
+            if (job.stage.load(std::memory_order_acquire) != Stage::Rendering)
+                continue;
+
+            for (int slot = job.nextSlot.fetch_add(1); slot < job.numSlots; slot = job.nextSlot.fetch_add(1))
+            {
+                renderSlot(job, slot);
+                if (job.slotsDone.fetch_add(1) + 1 == job.numSlots)
+                    finishRender(job);
+            }
+        }
+
+        if (hasPendingRender())
+            return;  // Flatten/export first - caches wait
+
+        for (auto& job : cacheJobs)
+        {
+            if (job.stage.load(std::memory_order_acquire) != Stage::Rendering || job.claimed.exchange(true))
+                continue;
+
+            // Abandon the render when the service pauses, the layer's settings or audio moved
+            // on, or a flatten/export is waiting for the workers
+            const auto shouldCancel = [this, &job]
+            {
+                return pausing.load(std::memory_order_relaxed) || job.stale.load(std::memory_order_relaxed)
+                    || hasPendingRender();
+            };
+
+            const bool rendered = LoopBuffer::renderPlaybackCache(job.audio, job.render, job.result, cacheScratch,
+                                                                  shouldCancel);
+            job.cancelled = !rendered && shouldCancel();
+            job.failed = !rendered && !job.cancelled;
+            job.audio.reset();
+            job.stage.store(Stage::Done, std::memory_order_release);
+            return;
+        }
+    }
+
+    // A flatten or export has been requested, is being captured or is rendering
+    bool hasPendingRender() const
+    {
+        for (const auto& job : jobs)
+        {
+            const Stage stage = job.stage.load(std::memory_order_acquire);
+            if (stage == Stage::Requested || stage == Stage::Capturing || stage == Stage::Rendering)
+                return true;
+        }
+        return false;
+    }
+
+    void renderSlot(Job& job, int slot)
+    {
+        auto& partial = job.partials[static_cast<size_t>(slot)];
+
+        // A full-loop stereo partial per slot adds up - lease it like chunk memory, and fail
+        // the whole job rather than render past the budget
+        if (job.overBudget.load() || !memoryManager->reserve(memoryClient, partialBytes(job.length)))
+        {
+            job.overBudget.store(true);
+            for (int l = slot; l < job.numLayers; l += job.numSlots)
+                job.layers[static_cast<size_t>(l)].audio.reset();
+            return;
+        }
+
+        partial.setSize(2, job.length, false, false, true);
+        partial.clear();
+
+        for (int l = slot; l < job.numLayers; l += job.numSlots)
+        {
+            auto& layer = job.layers[static_cast<size_t>(l)];
+            LoopBuffer::renderWithEffects(layer.audio, layer.params,
+                                          partial.getWritePointer(0), partial.getWritePointer(1),
+                                          job.length, job.length);
+            layer.audio.reset();
+        }
+    }
+
+    // Last slot done: sum, soft clip, write the output and publish it
+    void finishRender(Job& job)
+    {
+        if (job.overBudget.load())
+        {
+            for (auto& partial : job.partials)
+                releasePartial(partial);
+
+            job.result.release();
+            job.failed = true;
+            job.stage.store(Stage::Done, std::memory_order_release);
+            return;
+        }
+
+        auto& sum = job.partials[0];
+        for (int s = 1; s < job.numSlots; ++s)
+            for (int ch = 0; ch < 2; ++ch)
+                sum.addFrom(ch, 0, job.partials[static_cast<size_t>(s)], ch, 0, job.length);
+
+        for (int ch = 0; ch < 2; ++ch)
+            OutputMixKernel::softClipBlock(sum.getWritePointer(ch), job.length);
+
+        if (job.result.getMaxSamples() > 0)
+        {
+            job.result.release();
+            for (int ch = 0; ch < 2; ++ch)
+                job.result.copyFrom(ch, 0, sum.getReadPointer(ch), job.length);
+
+            job.failed = job.result.getNumCommittedChunks() < LoopChunkPool::chunksForSamples(job.length);
+            job.resultPeaks.rebuild(job.length);
+        }
+        else
+        {
+            releaseMix(job);
+            job.mixBytes = partialBytes(job.length);  // The lease moves with the buffer
+            std::swap(job.mix, sum);
+        }
+
+        for (auto& partial : job.partials)
+            releasePartial(partial);
+
+        job.stage.store(Stage::Done, std::memory_order_release);
+    }
+
+    // Process-wide render threads, polling every registered service
+    class Workers
+    {
+    public:
+        Workers()
+        {
+            const int numThreads = juce::jlimit(1, MAX_WORKERS, juce::SystemStats::getNumCpus() / 2);
+            for (int i = 0; i < numThreads; ++i)
+                threads.push_back(std::make_unique<Worker>(*this, i));
+            for (auto& thread : threads)
+                thread->startThread(juce::Thread::Priority::low);
+        }
+
+        ~Workers()
+        {
+            for (auto& thread : threads)
+                thread->signalThreadShouldExit();
+            for (auto& thread : threads)
+                thread->stopThread(4000);
+        }
+
+        int getNumWorkers() const { return static_cast<int>(threads.size()); }
+
+        void registerService(LayerRenderService* service)
+        {
+            const juce::ScopedLock lock(serviceLock);
+            services.push_back(service);
+        }
+
+        // Returns once no worker is inside the service any more
+        void unregisterService(LayerRenderService* service)
+        {
+            {
+                const juce::ScopedLock lock(serviceLock);
+                services.erase(std::remove(services.begin(), services.end(), service), services.end());
+            }
+            while (service->activeWorkers.load() > 0)
+                juce::Thread::sleep(1);
+        }
+
+    private:
+        class Worker : public juce::Thread
+        {
+        public:
+            Worker(Workers& ownerRef, int index)
+                : juce::Thread("LayerRender " + juce::String(index + 1)), owner(ownerRef) {}
+
+            void run() override
+            {
+                while (!threadShouldExit())
+                {
+                    owner.runServices(cacheScratch);
+                    wait(5);
+                }
+            }
+
+        private:
+            Workers& owner;
+            LoopBuffer::PlaybackCacheScratch cacheScratch;  // Prepared lazily by this thread's first pitched cache render
+        };
+
+        juce::CriticalSection serviceLock;  // Registration vs lookup - never taken by the audio thread
+        std::vector<LayerRenderService*> services;
+        std::vector<std::unique_ptr<Worker>> threads;
+
+        void runServices(LoopBuffer::PlaybackCacheScratch& cacheScratch)
+        {
+            for (size_t i = 0;; ++i)
+            {
+                LayerRenderService* service = nullptr;
+                {
+                    const juce::ScopedLock lock(serviceLock);
+                    if (i >= services.size())
+                        return;
+                    service = services[i];
+                    service->activeWorkers.fetch_add(1);  // Under the lock: unregister waits for it
+                }
+
+                service->work(cacheScratch);
+                service->activeWorkers.fetch_sub(1);
+            }
+        }
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Workers)
+    };
+
+    // Keeps workers out of this service while jobs are reset or re-prepared
+    struct ScopedPause
+    {
+        explicit ScopedPause(LayerRenderService& s) : service(s)
+        {
+            service.pausing.store(true);
+            service.workers->unregisterService(&service);
+        }
+
+        ~ScopedPause()
+        {
+            service.pausing.store(false);
+            service.workers->registerService(&service);
+        }
+
+        LayerRenderService& service;
+    };
+
+    juce::SharedResourcePointer<Workers> workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LayerRenderService)
+};
@@ -2,10 +2,16 @@
 
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_dsp/juce_dsp.h>
-#include "PhaseVocoder.h"
+#include "PitchShifterPool.h"
+#include "LoopStorage.h"
+#include "LoopReadKernel.h"
+#include "LoopPhase.h"
+#include "WaveformPyramid.h"
+#include "AudioLog.h"
 #include <vector>
 #include <atomic>
 #include <array>
+#include <memory>
 
 class LoopBuffer
 {
@@ -13,6 +19,10 @@ public:
     // 60 seconds max loop time at 48kHz
     static constexpr int MAX_LOOP_SECONDS = 60;
     static constexpr int CROSSFADE_SAMPLES = 2048;  // Long crossfade for click-free looping (~42ms at 48kHz)
+    static constexpr double PITCH_SHIFTER_TAIL_SECONDS = 0.25;  // Unity time before a leased shifter goes back
+    static constexpr double PITCH_QUALITY_FADE_SECONDS = 0.03;  // Crossfade between shifters when HQ is toggled
+    static constexpr int PITCH_PRIME_MARGIN = 1024;             // Fed past its latency before a restarted shifter is heard
+    static constexpr double PITCH_PRIME_FADE_SECONDS = 0.01;    // Dry -> pitched fade once it is
 
     enum class State
     {
@@ -32,7 +42,7 @@ public:
 
     LoopBuffer() = default;
 
-    void prepare(double sampleRate, int samplesPerBlock)
+    void prepare(double sampleRate, int samplesPerBlock, LoopChunkPool& chunkPool, PitchShifterPool& pitchShifterPool)
     {
         juce::String msg = "LoopBuffer::prepare() sampleRate=" + juce::String(sampleRate);
         DBG(msg);
@@ -42,9 +52,10 @@ public:
         currentBlockSize = samplesPerBlock;
         maxLoopSamples = static_cast<int>(MAX_LOOP_SECONDS * sampleRate);
 
-        // Pre-allocate buffers
-        bufferL.resize(maxLoopSamples, 0.0f);
-        bufferR.resize(maxLoopSamples, 0.0f);
+        // Size the chunk table - audio memory is committed from the pool as recording advances
+        storage.prepare(chunkPool, maxLoopSamples);
+        waveformPeaks.prepare(storage, maxLoopSamples);
+        playbackCache.prepare(chunkPool, maxLoopSamples);
 
         // Pre-allocate pitch processing buffers for block-based processing
         pitchInputL.resize(samplesPerBlock * 2, 0.0f);
@@ -52,6 +63,21 @@ public:
         pitchOutputL.resize(samplesPerBlock * 2, 0.0f);
         pitchOutputR.resize(samplesPerBlock * 2, 0.0f);
 
+        // Block read kernel scratch (playhead positions, fade gains, rates, Hermite taps)
+        blockReadIndices.resize(samplesPerBlock * 2, 0);
+        blockReadFracs.resize(samplesPerBlock * 2, 0.0f);
+        aheadReadIndices.resize(samplesPerBlock * 2, 0);
+        aheadReadFracs.resize(samplesPerBlock * 2, 0.0f);
+        switchReadIndices.resize(samplesPerBlock * 2, 0);
+        switchReadFracs.resize(samplesPerBlock * 2, 0.0f);
+        switchOutputL.resize(samplesPerBlock * 2, 0.0f);
+        switchOutputR.resize(samplesPerBlock * 2, 0.0f);
+        blockFadeGains.resize(samplesPerBlock * 2, 0.0f);
+        blockRates.resize(samplesPerBlock * 2, 0.0f);
+        readScratch.prepare(samplesPerBlock * 2);
+        cacheReadL.resize(samplesPerBlock * 2, 0.0f);
+        cacheReadR.resize(samplesPerBlock * 2, 0.0f);
+
         // Reset state
         clear();
 
@@ -69,23 +95,71 @@ public:
         muteGainSmoothed.reset(sampleRate, 0.015);
         muteGainSmoothed.setCurrentAndTargetValue(isMuted.load() ? 0.0f : 1.0f);
 
-        // Prepare block-based phase vocoder for efficient pitch shifting
-        blockPitchShifter.prepare(sampleRate, samplesPerBlock);
+        // Pitch shifters are leased from the engine's pool while the layer is off unity
+        shifterPool = &pitchShifterPool;
+        pitchShifterTailSamples = static_cast<int>(PITCH_SHIFTER_TAIL_SECONDS * sampleRate);
+        qualityFadeSamples = static_cast<int>(PITCH_QUALITY_FADE_SECONDS * sampleRate);
+        primeFadeSamples = static_cast<int>(PITCH_PRIME_FADE_SECONDS * sampleRate);
 
-        // Keep legacy sample-by-sample vocoder for compatibility
-        phaseVocoder.prepare(sampleRate);
+        playbackCacheSettleSamples = static_cast<int>(PLAYBACK_CACHE_SETTLE_SECONDS * sampleRate);
+        playbackCacheFadeSamples = static_cast<int>(PLAYBACK_CACHE_FADE_SECONDS * sampleRate);
 
         // Initialize granular pitch shifter grains (for monitoring/lower latency)
         initGrains();
     }
 
+    // Route this layer's audio-thread diagnostics into the engine's log ring
+    void setAudioLog(AudioLog* log, int sourceIndex)
+    {
+        audioLog = log;
+        logSource = sourceIndex;
+    }
+
+    // Give the chunk table back to the pool (before the engine re-prepares it)
+    void releaseStorage()
+    {
+        storage.detach();
+        playbackCache.detach();
+        playbackCacheValid = false;
+        playbackCacheBlend = 0.0f;
+    }
+
+    // Give a leased pitch shifter back to the pool (the pool resets it off this thread)
+    void releasePitchShifter()
+    {
+        if (pitchShifter != nullptr)
+        {
+            shifterPool->release(pitchShifter);
+            pitchShifter = nullptr;
+        }
+        releaseIncomingShifter();
+        pitchShifterIdleSamples = 0;
+        mainFeed.needsRestart = true;
+        pitchWetBlend = 0.0f;
+        pitchDryTail = 0.0f;
+    }
+
+    // Whether this layer will want a pitch shifter: it has (or is getting) audio and its
+    // combined global * layer pitch target is off unity. Used to size the shifter pool.
+    bool wantsPitchShifter() const
+    {
+        if (state.load() == State::Idle && loopLength <= 0)
+            return false;
+
+        const float ratio = pitchRatioSmoothed.getTargetValue() * std::pow(2.0f, layerPitchSemitones.load() / 12.0f);
+        return std::abs(ratio - 1.0f) >= 0.002f;
+    }
+
     void clear()
     {
-        std::fill(bufferL.begin(), bufferL.end(), 0.0f);
-        std::fill(bufferR.begin(), bufferR.end(), 0.0f);
+        // O(1): swap in a clean chunk table - the old chunks are released and zeroed
+        // by the pool's maintenance thread, never on the calling (often audio) thread
+        storage.release();
+        waveformPeaks.reset();
+        invalidatePlaybackCache();
 
         writeHead = 0;
-        playHead = 0.0f;
+        playHead = LoopPhase();
         loopLength = 0;
         loopStart = 0;
         loopEnd = 0;
@@ -102,9 +176,9 @@ public:
         lastPlayheadPosition = 0.0f;
         skipFirstBlock = false;
 
-        // Reset pitch shifters
-        blockPitchShifter.reset();
-        phaseVocoder.reset();
+        // Hand the pitch shifter back (the pool resets it)
+        releasePitchShifter();
+        pitchShifterCold = false;
         initGrains();
 
         // Reset layer type to Regular
@@ -128,41 +202,40 @@ public:
         resetEQState();
     }
 
-    // Copy content from another LoopBuffer (for layer shuffling)
+    // Copy content from another LoopBuffer (for duplicating a layer)
+    // Audio is shared copy-on-write: chunks are only copied when either layer overdubs them
     void copyFrom(const LoopBuffer& other)
     {
-        // Copy audio data
         loopLength = other.loopLength;
         if (loopLength > 0 && loopLength <= maxLoopSamples)
         {
-            std::copy(other.bufferL.begin(), other.bufferL.begin() + loopLength, bufferL.begin());
-            std::copy(other.bufferR.begin(), other.bufferR.begin() + loopLength, bufferR.begin());
+            storage.shareFrom(other.storage, loopLength);
+            waveformPeaks.copyFrom(other.waveformPeaks);
+        }
+        else
+        {
+            storage.release();
+            waveformPeaks.reset();
         }
 
-        // Copy state
-        writeHead = other.writeHead;
-        playHead = other.playHead;
-        loopStart = other.loopStart;
-        loopEnd = other.loopEnd;
-        targetLoopLength = other.targetLoopLength;
-        state.store(other.state.load());
-        isReversed.store(other.isReversed.load());
-        isMuted.store(other.isMuted.load());
-        // Sync mute gain smoother with muted state
-        muteGainSmoothed.setCurrentAndTargetValue(other.isMuted.load() ? 0.0f : 1.0f);
-        fadeActive.store(other.fadeActive.load());
-        currentFadeMultiplier.store(other.currentFadeMultiplier.load());
-        lastPlayheadPosition = other.lastPlayheadPosition;
+        copyStateFrom(other);
 
-        // Reset pitch shifters (they have internal state that shouldn't be copied)
-        blockPitchShifter.reset();
-        phaseVocoder.reset();
-        initGrains();
+        logEvent(AudioLog::Event::LayerShared, loopLength);
+    }
 
-        // Invalidate waveform cache since content changed
-        waveformCacheDirty = true;
+    // Move content from another LoopBuffer (for layer shuffling)
+    // Swaps chunk tables in O(1) - the other layer is left holding this layer's old audio,
+    // so callers normally clear() it afterwards
+    void moveFrom(LoopBuffer& other)
+    {
+        loopLength = other.loopLength;
+        storage.swapWith(other.storage);
+        waveformPeaks.swapWith(other.waveformPeaks);
+        other.invalidatePlaybackCache();
 
-        DBG("LoopBuffer::copyFrom() - Copied " + juce::String(loopLength) + " samples");
+        copyStateFrom(other);
+
+        logEvent(AudioLog::Event::LayerMoved, loopLength);
     }
 
     // Add this layer's buffer content to an external buffer (for flattening)
@@ -183,7 +256,7 @@ public:
             float* destL = destBuffer.getWritePointer(0);
             for (int i = 0; i < numSamples; ++i)
             {
-                destL[i] += bufferL[i] * fadeMultiplier;
+                destL[i] += storage.getSample(0, i) * fadeMultiplier;
             }
         }
 
@@ -192,75 +265,95 @@ public:
             float* destR = destBuffer.getWritePointer(1);
             for (int i = 0; i < numSamples; ++i)
             {
-                destR[i] += bufferR[i] * fadeMultiplier;
+                destR[i] += storage.getSample(1, i) * fadeMultiplier;
             }
         }
     }
 
-    // Add this layer's buffer content WITH all per-layer effects applied
-    // This renders the layer as it would sound during playback, including:
-    // - Volume & Pan
-    // - EQ (3-band)
-    // - Pitch shift (per-layer)
-    // - Reverse
-    // - Loop bounds (start/end)
-    // - Fade multiplier
-    void addToBufferWithEffects(juce::AudioBuffer<float>& destBuffer, double sampleRate) const
+    // Resumable offline render of this layer with its effects (for flattening).
+    // beginEffectsRender() snapshots the parameters and EQ coefficients once; each
+    // renderWithEffects() call then adds the next span of output and carries the EQ
+    // history and resampler position in the state, so a layer can be rendered in
+    // bounded chunks across audio callbacks and still match a one-shot render exactly.
+    struct EffectsRenderState
     {
-        if (loopLength <= 0)
-            return;
+        // Biquad coefficients and per-channel history for one EQ band
+        struct Band
+        {
+            float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+            float x1[2] = { 0.0f, 0.0f }, x2[2] = { 0.0f, 0.0f };
+            float y1[2] = { 0.0f, 0.0f }, y2[2] = { 0.0f, 0.0f };
 
-        const int destLength = destBuffer.getNumSamples();
-        const int numChannels = destBuffer.getNumChannels();
-        if (numChannels < 2)
+            float process(float x, int ch)
+            {
+                const float y = b0 * x + b1 * x1[ch] + b2 * x2[ch] - a1 * y1[ch] - a2 * y2[ch];
+                x2[ch] = x1[ch]; x1[ch] = x; y2[ch] = y1[ch]; y1[ch] = y;
+                return y;
+            }
+        };
+
+        // Parameter snapshot
+        float vol = 1.0f;
+        float panVal = 0.0f;
+        float panL = 1.0f, panR = 1.0f;
+        float fadeMultiplier = 1.0f;
+        float pitchSemitones = 0.0f;
+        bool reversed = false;
+        bool needsEQ = false;
+        bool needsPitchShift = false;
+        int effectiveStart = 0;
+        int effectiveEnd = 0;
+        int effectiveLength = 0;
+        Band low, mid, high;
+
+        // Progress
+        float readPos = 0.0f;
+        float readIncrement = 1.0f;
+        int position = 0;       // Next destination sample
+        bool finished = true;   // No more output from this layer
+    };
+
+    void beginEffectsRender(EffectsRenderState& state, double sampleRate) const
+    {
+        state = EffectsRenderState();
+        if (loopLength <= 0)
             return;
 
         // Get all per-layer parameters
-        const float vol = volume.load();
-        const float panVal = pan.load();
-        const float fadeMultiplier = currentFadeMultiplier.load();
-        const bool reversed = isReversed.load();
-        const float layerPitchSemi = layerPitchSemitones.load();
-        const float layerPitchRatio = std::pow(2.0f, layerPitchSemi / 12.0f);
+        state.vol = volume.load();
+        state.panVal = pan.load();
+        state.fadeMultiplier = currentFadeMultiplier.load();
+        state.reversed = isReversed.load();
+        state.pitchSemitones = layerPitchSemitones.load();
+        const float layerPitchRatio = std::pow(2.0f, state.pitchSemitones / 12.0f);
 
         // Calculate effective loop bounds
-        const int effectiveStart = loopStart;
-        const int effectiveEnd = loopEnd > 0 ? loopEnd : loopLength;
-        const int effectiveLength = effectiveEnd - effectiveStart;
+        state.effectiveStart = loopStart;
+        state.effectiveEnd = loopEnd > 0 ? loopEnd : loopLength;
+        state.effectiveLength = state.effectiveEnd - state.effectiveStart;
 
-        if (effectiveLength <= 0)
+        if (state.effectiveLength <= 0)
             return;
 
         // Pan law: constant power panning
-        const float panAngle = (panVal + 1.0f) * 0.5f * juce::MathConstants<float>::halfPi;
-        const float panL = std::cos(panAngle);
-        const float panR = std::sin(panAngle);
+        const float panAngle = (state.panVal + 1.0f) * 0.5f * juce::MathConstants<float>::halfPi;
+        state.panL = std::cos(panAngle);
+        state.panR = std::sin(panAngle);
 
         // Get EQ gains
         const float eqLow = eqLowGain.load();
         const float eqMid = eqMidGain.load();
         const float eqHigh = eqHighGain.load();
-        const bool needsEQ = std::abs(eqLow - 1.0f) > 0.01f ||
-                             std::abs(eqMid - 1.0f) > 0.01f ||
-                             std::abs(eqHigh - 1.0f) > 0.01f;
-
-        // Simple EQ state for offline processing (separate from realtime state)
-        float eqLowX1L = 0.0f, eqLowX2L = 0.0f, eqLowY1L = 0.0f, eqLowY2L = 0.0f;
-        float eqLowX1R = 0.0f, eqLowX2R = 0.0f, eqLowY1R = 0.0f, eqLowY2R = 0.0f;
-        float eqMidX1L = 0.0f, eqMidX2L = 0.0f, eqMidY1L = 0.0f, eqMidY2L = 0.0f;
-        float eqMidX1R = 0.0f, eqMidX2R = 0.0f, eqMidY1R = 0.0f, eqMidY2R = 0.0f;
-        float eqHighX1L = 0.0f, eqHighX2L = 0.0f, eqHighY1L = 0.0f, eqHighY2L = 0.0f;
-        float eqHighX1R = 0.0f, eqHighX2R = 0.0f, eqHighY1R = 0.0f, eqHighY2R = 0.0f;
+        state.needsEQ = std::abs(eqLow - 1.0f) > 0.01f ||
+                        std::abs(eqMid - 1.0f) > 0.01f ||
+                        std::abs(eqHigh - 1.0f) > 0.01f;
 
-        // Calculate EQ coefficients for offline processing
-        float lowB0 = 1.0f, lowB1 = 0.0f, lowB2 = 0.0f, lowA1 = 0.0f, lowA2 = 0.0f;
-        float midB0 = 1.0f, midB1 = 0.0f, midB2 = 0.0f, midA1 = 0.0f, midA2 = 0.0f;
-        float highB0 = 1.0f, highB1 = 0.0f, highB2 = 0.0f, highA1 = 0.0f, highA2 = 0.0f;
-
-        if (needsEQ && sampleRate > 0)
+        // Calculate EQ coefficients for offline processing (separate from realtime state)
+        if (state.needsEQ && sampleRate > 0)
         {
             // Low shelf at 200Hz
             {
+                auto& band = state.low;
                 float freq = 200.0f;
                 float w0 = 2.0f * juce::MathConstants<float>::pi * freq / static_cast<float>(sampleRate);
                 float cosw0 = std::cos(w0);
@@ -269,15 +362,16 @@ public:
                 float A = std::sqrt(eqLow);
                 float alpha = sinw0 / 2.0f * std::sqrt((A + 1.0f/A) * (1.0f/S - 1.0f) + 2.0f);
                 float a0 = (A + 1.0f) + (A - 1.0f) * cosw0 + 2.0f * std::sqrt(A) * alpha;
-                lowB0 = (A * ((A + 1.0f) - (A - 1.0f) * cosw0 + 2.0f * std::sqrt(A) * alpha)) / a0;
-                lowB1 = (2.0f * A * ((A - 1.0f) - (A + 1.0f) * cosw0)) / a0;
-                lowB2 = (A * ((A + 1.0f) - (A - 1.0f) * cosw0 - 2.0f * std::sqrt(A) * alpha)) / a0;
-                lowA1 = (-2.0f * ((A - 1.0f) + (A + 1.0f) * cosw0)) / a0;
-                lowA2 = ((A + 1.0f) + (A - 1.0f) * cosw0 - 2.0f * std::sqrt(A) * alpha) / a0;
+                band.b0 = (A * ((A + 1.0f) - (A - 1.0f) * cosw0 + 2.0f * std::sqrt(A) * alpha)) / a0;
+                band.b1 = (2.0f * A * ((A - 1.0f) - (A + 1.0f) * cosw0)) / a0;
+                band.b2 = (A * ((A + 1.0f) - (A - 1.0f) * cosw0 - 2.0f * std::sqrt(A) * alpha)) / a0;
+                band.a1 = (-2.0f * ((A - 1.0f) + (A + 1.0f) * cosw0)) / a0;
+                band.a2 = ((A + 1.0f) + (A - 1.0f) * cosw0 - 2.0f * std::sqrt(A) * alpha) / a0;
             }
 
             // Mid peak at 1kHz
             {
+                auto& band = state.mid;
                 float freq = 1000.0f;
                 float w0 = 2.0f * juce::MathConstants<float>::pi * freq / static_cast<float>(sampleRate);
                 float cosw0 = std::cos(w0);
@@ -286,15 +380,16 @@ public:
                 float A = std::sqrt(eqMid);
                 float alpha = sinw0 / (2.0f * Q);
                 float a0 = 1.0f + alpha / A;
-                midB0 = (1.0f + alpha * A) / a0;
-                midB1 = (-2.0f * cosw0) / a0;
-                midB2 = (1.0f - alpha * A) / a0;
-                midA1 = (-2.0f * cosw0) / a0;
-                midA2 = (1.0f - alpha / A) / a0;
+                band.b0 = (1.0f + alpha * A) / a0;
+                band.b1 = (-2.0f * cosw0) / a0;
+                band.b2 = (1.0f - alpha * A) / a0;
+                band.a1 = (-2.0f * cosw0) / a0;
+                band.a2 = (1.0f - alpha / A) / a0;
             }
 
             // High shelf at 4kHz
             {
+                auto& band = state.high;
                 float freq = 4000.0f;
                 float w0 = 2.0f * juce::MathConstants<float>::pi * freq / static_cast<float>(sampleRate);
                 float cosw0 = std::cos(w0);
@@ -303,139 +398,381 @@ public:
                 float A = std::sqrt(eqHigh);
                 float alpha = sinw0 / 2.0f * std::sqrt((A + 1.0f/A) * (1.0f/S - 1.0f) + 2.0f);
                 float a0 = (A + 1.0f) - (A - 1.0f) * cosw0 + 2.0f * std::sqrt(A) * alpha;
-                highB0 = (A * ((A + 1.0f) + (A - 1.0f) * cosw0 + 2.0f * std::sqrt(A) * alpha)) / a0;
-                highB1 = (-2.0f * A * ((A - 1.0f) + (A + 1.0f) * cosw0)) / a0;
-                highB2 = (A * ((A + 1.0f) + (A - 1.0f) * cosw0 - 2.0f * std::sqrt(A) * alpha)) / a0;
-                highA1 = (2.0f * ((A - 1.0f) - (A + 1.0f) * cosw0)) / a0;
-                highA2 = ((A + 1.0f) - (A - 1.0f) * cosw0 - 2.0f * std::sqrt(A) * alpha) / a0;
+                band.b0 = (A * ((A + 1.0f) + (A - 1.0f) * cosw0 + 2.0f * std::sqrt(A) * alpha)) / a0;
+                band.b1 = (-2.0f * A * ((A - 1.0f) + (A + 1.0f) * cosw0)) / a0;
+                band.b2 = (A * ((A + 1.0f) + (A - 1.0f) * cosw0 - 2.0f * std::sqrt(A) * alpha)) / a0;
+                band.a1 = (2.0f * ((A - 1.0f) - (A + 1.0f) * cosw0)) / a0;
+                band.a2 = ((A + 1.0f) - (A - 1.0f) * cosw0 - 2.0f * std::sqrt(A) * alpha) / a0;
             }
         }
 
-        // Lambda for applying EQ to a sample
-        auto applyEQ = [&](float& sampleL, float& sampleR) {
-            if (!needsEQ) return;
-
-            // Low shelf L
-            float outL = lowB0 * sampleL + lowB1 * eqLowX1L + lowB2 * eqLowX2L - lowA1 * eqLowY1L - lowA2 * eqLowY2L;
-            eqLowX2L = eqLowX1L; eqLowX1L = sampleL; eqLowY2L = eqLowY1L; eqLowY1L = outL;
-            // Low shelf R
-            float outR = lowB0 * sampleR + lowB1 * eqLowX1R + lowB2 * eqLowX2R - lowA1 * eqLowY1R - lowA2 * eqLowY2R;
-            eqLowX2R = eqLowX1R; eqLowX1R = sampleR; eqLowY2R = eqLowY1R; eqLowY1R = outR;
-            sampleL = outL; sampleR = outR;
-
-            // Mid peak L
-            outL = midB0 * sampleL + midB1 * eqMidX1L + midB2 * eqMidX2L - midA1 * eqMidY1L - midA2 * eqMidY2L;
-            eqMidX2L = eqMidX1L; eqMidX1L = sampleL; eqMidY2L = eqMidY1L; eqMidY1L = outL;
-            // Mid peak R
-            outR = midB0 * sampleR + midB1 * eqMidX1R + midB2 * eqMidX2R - midA1 * eqMidY1R - midA2 * eqMidY2R;
-            eqMidX2R = eqMidX1R; eqMidX1R = sampleR; eqMidY2R = eqMidY1R; eqMidY1R = outR;
-            sampleL = outL; sampleR = outR;
-
-            // High shelf L
-            outL = highB0 * sampleL + highB1 * eqHighX1L + highB2 * eqHighX2L - highA1 * eqHighY1L - highA2 * eqHighY2L;
-            eqHighX2L = eqHighX1L; eqHighX1L = sampleL; eqHighY2L = eqHighY1L; eqHighY1L = outL;
-            // High shelf R
-            outR = highB0 * sampleR + highB1 * eqHighX1R + highB2 * eqHighX2R - highA1 * eqHighY1R - highA2 * eqHighY2R;
-            eqHighX2R = eqHighX1R; eqHighX1R = sampleR; eqHighY2R = eqHighY1R; eqHighY1R = outR;
-            sampleL = outL; sampleR = outR;
-        };
+        // For pitch shifting we resample with linear interpolation:
+        // ratio > 1 reads faster (higher pitch), ratio < 1 reads slower (lower pitch)
+        state.needsPitchShift = std::abs(layerPitchRatio - 1.0f) > 0.001f;
+        state.readPos = state.reversed ? static_cast<float>(state.effectiveEnd - 1)
+                                       : static_cast<float>(state.effectiveStart);
+        state.readIncrement = state.reversed ? -layerPitchRatio : layerPitchRatio;
+        state.finished = false;
+    }
 
-        float* destL = destBuffer.getWritePointer(0);
-        float* destR = destBuffer.getWritePointer(1);
+    // Add up to maxSamples of output to destL/destR, which point at output sample
+    // state.position (so the destination may be a chunk span rather than one buffer).
+    // Returns the number of samples produced; sets state.finished once the layer has
+    // no more output within destLength. Source is LoopStorage or LoopStorage::Snapshot.
+    template <typename Source>
+    static int renderWithEffects(const Source& source, EffectsRenderState& state, float* destL, float* destR,
+                                 int destLength, int maxSamples)
+    {
+        if (state.finished)
+            return 0;
 
-        // For pitch shifting, we need to resample
-        // If pitch ratio is 1.0, we can do simple copy with effects
-        // Otherwise we need to interpolate
+        // Non-pitched layers stop at their own length, pitched ones when the read runs out
+        const int limit = state.needsPitchShift ? destLength : std::min(destLength, state.effectiveLength);
+        const int startPos = state.position;
+        const int endPos = std::min(limit, startPos + maxSamples);
 
-        const bool needsPitchShift = std::abs(layerPitchRatio - 1.0f) > 0.001f;
+        const float gainL = state.vol * state.panL;
+        const float gainR = state.vol * state.panR;
 
-        if (!needsPitchShift)
+        int i = startPos;
+        for (; i < endPos; ++i)
         {
-            // No pitch shift - simple sample-by-sample processing
-            for (int i = 0; i < destLength && i < effectiveLength; ++i)
+            float sampleL, sampleR;
+
+            if (!state.needsPitchShift)
             {
                 int srcIdx;
-                if (reversed)
+                if (state.reversed)
                 {
-                    srcIdx = effectiveEnd - 1 - i;
-                    if (srcIdx < effectiveStart) srcIdx = effectiveStart;
+                    srcIdx = state.effectiveEnd - 1 - i;
+                    if (srcIdx < state.effectiveStart) srcIdx = state.effectiveStart;
                 }
                 else
                 {
-                    srcIdx = effectiveStart + i;
-                    if (srcIdx >= effectiveEnd) srcIdx = effectiveEnd - 1;
+                    srcIdx = state.effectiveStart + i;
+                    if (srcIdx >= state.effectiveEnd) srcIdx = state.effectiveEnd - 1;
                 }
 
-                float sampleL = bufferL[srcIdx] * fadeMultiplier;
-                float sampleR = bufferR[srcIdx] * fadeMultiplier;
-
-                // Apply EQ
-                applyEQ(sampleL, sampleR);
-
-                // Apply volume and pan
-                sampleL *= vol * panL;
-                sampleR *= vol * panR;
-
-                // Add to destination
-                destL[i] += sampleL;
-                destR[i] += sampleR;
+                sampleL = source.getSample(0, srcIdx) * state.fadeMultiplier;
+                sampleR = source.getSample(1, srcIdx) * state.fadeMultiplier;
             }
-        }
-        else
-        {
-            // With pitch shift - use linear interpolation for resampling
-            // When pitch ratio > 1, we read faster (higher pitch)
-            // When pitch ratio < 1, we read slower (lower pitch)
-            float readPos = reversed ? static_cast<float>(effectiveEnd - 1) : static_cast<float>(effectiveStart);
-            const float readIncrement = reversed ? -layerPitchRatio : layerPitchRatio;
-
-            for (int i = 0; i < destLength; ++i)
+            else
             {
+                const float readPos = state.readPos;
+
                 // Check bounds
-                if (reversed)
-                {
-                    if (readPos < effectiveStart) break;
-                }
-                else
+                if (state.reversed ? (readPos < state.effectiveStart) : (readPos >= state.effectiveEnd - 1))
                 {
-                    if (readPos >= effectiveEnd - 1) break;
+                    state.finished = true;
+                    break;
                 }
 
                 // Linear interpolation
                 int idx0 = static_cast<int>(std::floor(readPos));
-                int idx1 = idx0 + (reversed ? -1 : 1);
+                int idx1 = idx0 + (state.reversed ? -1 : 1);
                 float frac = readPos - std::floor(readPos);
 
                 // Clamp indices
-                idx0 = std::clamp(idx0, effectiveStart, effectiveEnd - 1);
-                idx1 = std::clamp(idx1, effectiveStart, effectiveEnd - 1);
+                idx0 = std::clamp(idx0, state.effectiveStart, state.effectiveEnd - 1);
+                idx1 = std::clamp(idx1, state.effectiveStart, state.effectiveEnd - 1);
 
-                float sampleL = bufferL[idx0] * (1.0f - frac) + bufferL[idx1] * frac;
-                float sampleR = bufferR[idx0] * (1.0f - frac) + bufferR[idx1] * frac;
-                sampleL *= fadeMultiplier;
-                sampleR *= fadeMultiplier;
+                sampleL = source.getSample(0, idx0) * (1.0f - frac) + source.getSample(0, idx1) * frac;
+                sampleR = source.getSample(1, idx0) * (1.0f - frac) + source.getSample(1, idx1) * frac;
+                sampleL *= state.fadeMultiplier;
+                sampleR *= state.fadeMultiplier;
 
-                // Apply EQ
-                applyEQ(sampleL, sampleR);
+                // Advance read position
+                state.readPos += state.readIncrement;
+            }
 
-                // Apply volume and pan
-                sampleL *= vol * panL;
-                sampleR *= vol * panR;
+            // Apply EQ (low shelf, mid peak, high shelf)
+            if (state.needsEQ)
+            {
+                sampleL = state.high.process(state.mid.process(state.low.process(sampleL, 0), 0), 0);
+                sampleR = state.high.process(state.mid.process(state.low.process(sampleR, 1), 1), 1);
+            }
 
-                // Add to destination
-                destL[i] += sampleL;
-                destR[i] += sampleR;
+            // Apply volume and pan, add to destination
+            destL[i - startPos] += sampleL * gainL;
+            destR[i - startPos] += sampleR * gainR;
+        }
 
-                // Advance read position
-                readPos += readIncrement;
+        state.position = i;
+        if (state.position >= limit)
+            state.finished = true;
+
+        return i - startPos;
+    }
+
+    // Render from this layer's own storage (see the static overload)
+    int renderWithEffects(EffectsRenderState& state, float* destL, float* destR,
+                          int destLength, int maxSamples) const
+    {
+        const int rendered = renderWithEffects(storage, state, destL, destR, destLength, maxSamples);
+
+        if (state.finished)
+            logEvent(AudioLog::Event::LayerRenderedWithEffects, state.vol, state.panVal,
+                     state.pitchSemitones, state.reversed, state.needsEQ);
+
+        return rendered;
+    }
+
+    // Snapshot this layer's audio and effect parameters for rendering on another thread.
+    // Audio thread (the storage owner); O(chunks), nothing is copied.
+    void captureForRender(LoopStorage::Snapshot& audio, EffectsRenderState& state, double sampleRate) const
+    {
+        audio.capture(storage, loopLength);
+        beginEffectsRender(state, sampleRate);
+    }
+
+    // ============================================
+    // PRE-RENDERED PLAYBACK CACHE
+    // Once a pitched or EQ'd layer's settings hold still, a LayerRenderService worker
+    // renders one cycle of the loop region through the same look-ahead stretch feed and
+    // EQ the live path uses. Playback then crossfades to plain reads of that cache and the
+    // pitch shifter goes back to the pool. Fade, volume, pan and the DC blocker stay live
+    // (scalar gains and one cheap filter); only unity playback rate is cached, since the
+    // cache is indexed by playhead sample.
+    // ============================================
+
+    static constexpr double PLAYBACK_CACHE_SETTLE_SECONDS = 0.5;  // Settings unchanged this long before rendering
+    static constexpr double PLAYBACK_CACHE_FADE_SECONDS = 0.02;   // Live <-> cache crossfade
+    static constexpr int PLAYBACK_CACHE_PREROLL = 4096;           // Frames rendered and discarded before the cycle (EQ/stretch settle)
+    static constexpr int PLAYBACK_CACHE_SEAM = 1024;              // Cycle end crossfaded into its start
+    static constexpr int PLAYBACK_CACHE_BLOCK = 512;
+
+    // Everything the cached audio depends on. Any difference means the cache is stale.
+    struct PlaybackCacheKey
+    {
+        float pitchRatio = 1.0f;       // Global * layer; exactly 1 when unpitched
+        float eqLow = 1.0f, eqMid = 1.0f, eqHigh = 1.0f;
+        bool reversed = false;
+        bool highQuality = false;      // Only set when pitched
+        int effectiveStart = 0;
+        int effectiveEnd = 0;
+        int loopLength = 0;
+        juce::uint32 contentVersion = 0;
+
+        bool operator==(const PlaybackCacheKey&) const = default;
+    };
+
+    // Key plus what a worker needs to render it: the live EQ coefficients (so the cache
+    // matches the live EQ exactly) and the format
+    struct PlaybackCacheRender
+    {
+        PlaybackCacheKey key;
+        bool needsPitchShift = false;
+        bool needsEQ = false;
+        EffectsRenderState::Band low, mid, high;
+        double sampleRate = 44100.0;
+    };
+
+    // A render worker's stretch instance for playback cache renders. Each worker owns one
+    // and keeps it across renders; it is only re-prepared when the format or quality changes.
+    struct PlaybackCacheScratch
+    {
+        StereoBlockPitchShifter shifter;
+        double sampleRate = 0.0;
+        bool highQuality = false;
+    };
+
+    // Audio thread: settings have been stable long enough and no usable cache exists yet.
+    // The engine then captures and submits a render.
+    bool wantsPlaybackCache() const
+    {
+        return state.load() == State::Playing
+            && playbackRateSmoothed.getTargetValue() == 1.0f
+            && playbackCacheStableSamples >= playbackCacheSettleSamples
+            && isCacheableKey(trackedCacheKey)
+            && !(playbackCacheValid && playbackCacheKey == trackedCacheKey)
+            && !(hasFailedCacheKey && failedCacheKey == trackedCacheKey);
+    }
+
+    // Audio thread: snapshot the audio (chunk references only) and the tracked key
+    void capturePlaybackCache(LoopStorage::Snapshot& audio, PlaybackCacheRender& render)
+    {
+        if (eqCoeffsDirty)
+            updateEQCoefficients();
+
+        audio.capture(storage, loopLength);
+        render = PlaybackCacheRender();
+        render.key = trackedCacheKey;
+        render.needsPitchShift = trackedCacheKey.pitchRatio != 1.0f;
+        render.needsEQ = isEQActive();
+        render.low = { eqLowB0, eqLowB1, eqLowB2, eqLowA1, eqLowA2 };
+        render.mid = { eqMidB0, eqMidB1, eqMidB2, eqMidA1, eqMidA2 };
+        render.high = { eqHighB0, eqHighB1, eqHighB2, eqHighA1, eqHighA2 };
+        render.sampleRate = currentSampleRate;
+    }
+
+    // Audio thread: take a finished render in O(1) if it still matches the layer. The
+    // rendered table is swapped with the old cache, which the caller releases.
+    void installPlaybackCache(LoopStorage& rendered, const PlaybackCacheKey& key, bool failed)
+    {
+        if (failed)
+        {
+            // Out of memory (or short of the headroom kept for recording) - don't retry
+            // until something changes
+            failedCacheKey = key;
+            hasFailedCacheKey = true;
+            logEvent(AudioLog::Event::PlaybackCacheFailed, key.effectiveEnd - key.effectiveStart);
+            return;
+        }
+
+        if (!isPlaybackCacheKeyCurrent(key))
+            return;
+
+        playbackCache.swapWith(rendered);
+        playbackCacheKey = key;
+        playbackCacheValid = true;
+        logEvent(AudioLog::Event::PlaybackCacheInstalled, key.effectiveEnd - key.effectiveStart,
+                 key.pitchRatio, key.reversed, keyNeedsEQ(key));
+    }
+
+    bool isPlayingFromCache() const { return playbackCacheBlend > 0.0f; }
+
+    // Whether a render for key would still be installed: same settings, same audio
+    bool isPlaybackCacheKeyCurrent(const PlaybackCacheKey& key) const
+    {
+        return key == trackedCacheKey && key.contentVersion == contentVersion;
+    }
+
+    // Bumped whenever the layer's audio changes (every recording/overdub block, clears,
+    // replacements) - lets a background render tell whether its snapshot went stale
+    juce::uint32 getContentVersion() const { return contentVersion; }
+
+    // Render one cycle of the loop region into dest as processPlayingBlock() would hear it
+    // at unity rate (before fade/volume/pan/DC blocker), indexed by playhead sample. Runs on
+    // a render worker with that worker's scratch; the output goes straight into dest's
+    // budgeted chunks a block at a time. Returns false if the memory budget ran out or
+    // shouldCancel() returned true (checked every block).
+    template <typename ShouldCancel>
+    static bool renderPlaybackCache(const LoopStorage::Snapshot& source, const PlaybackCacheRender& render,
+                                    LoopStorage& dest, PlaybackCacheScratch& scratch, ShouldCancel&& shouldCancel)
+    {
+        const PlaybackCacheKey& key = render.key;
+        const int effectiveStart = key.effectiveStart;
+        const int effectiveEnd = key.effectiveEnd;
+        const int effectiveLength = effectiveEnd - effectiveStart;
+
+        dest.release();
+        if (effectiveLength <= 0 || effectiveEnd > key.loopLength)
+            return false;
+
+        // Same look-ahead feed as the live path: the input runs lookAhead frames ahead of
+        // the output, and the stretch's delay brings it back in line
+        StereoBlockPitchShifter* shifter = nullptr;
+        int lookAhead = 0;
+        if (render.needsPitchShift)
+        {
+            if (scratch.sampleRate != render.sampleRate || scratch.highQuality != key.highQuality)
+            {
+                scratch.shifter.prepare(render.sampleRate, PLAYBACK_CACHE_BLOCK, key.highQuality);
+                scratch.sampleRate = render.sampleRate;
+                scratch.highQuality = key.highQuality;
             }
+
+            shifter = &scratch.shifter;
+            shifter->setLookAheadFeed(true);
+            shifter->reset();
+            shifter->setPitchRatio(key.pitchRatio);
+            lookAhead = shifter->getLookAheadSamples();
         }
 
-        DBG("addToBufferWithEffects: vol=" + juce::String(vol, 2) +
-            " pan=" + juce::String(panVal, 2) +
-            " pitch=" + juce::String(layerPitchSemi, 1) + "st" +
-            " reversed=" + juce::String(reversed ? "yes" : "no") +
-            " eqActive=" + juce::String(needsEQ ? "yes" : "no"));
+        EffectsRenderState::Band low = render.low, mid = render.mid, high = render.high;
+
+        // Frames are walked in play direction from `preroll` before the cycle origin; the
+        // first `preroll` outputs are discarded, the last `seam` are crossfaded into the start
+        const int direction = key.reversed ? -1 : 1;
+        const int origin = key.reversed ? effectiveEnd - 1 : effectiveStart;
+        const int preroll = lookAhead + PLAYBACK_CACHE_PREROLL;
+        const int seam = std::min(PLAYBACK_CACHE_SEAM, effectiveLength / 4);
+        const int total = preroll + effectiveLength + seam;
+
+        auto wrap = [&](juce::int64 index)
+        {
+            juce::int64 rel = (index - effectiveStart) % effectiveLength;
+            if (rel < 0)
+                rel += effectiveLength;
+            return effectiveStart + static_cast<int>(rel);
+        };
+
+        std::array<float, PLAYBACK_CACHE_BLOCK> blockL {}, blockR {};
+
+        for (int start = 0; start < total; start += PLAYBACK_CACHE_BLOCK)
+        {
+            if (shouldCancel())
+                return false;
+
+            const int n = std::min(PLAYBACK_CACHE_BLOCK, total - start);
+            for (int i = 0; i < n; ++i)
+            {
+                const juce::int64 step = static_cast<juce::int64>(start + i - preroll + lookAhead) * direction;
+                readCacheFrame(source, key.loopLength, wrap(origin + step), effectiveStart, effectiveEnd,
+                               blockL[static_cast<size_t>(i)], blockR[static_cast<size_t>(i)]);
+            }
+
+            if (shifter != nullptr)
+                shifter->processBlock(blockL.data(), blockR.data(), blockL.data(), blockR.data(), n);
+
+            if (render.needsEQ)
+            {
+                for (int i = 0; i < n; ++i)
+                {
+                    float& l = blockL[static_cast<size_t>(i)];
+                    float& r = blockR[static_cast<size_t>(i)];
+                    l = high.process(mid.process(low.process(l, 0), 0), 0);
+                    r = high.process(mid.process(low.process(r, 1), 1), 1);
+                }
+            }
+
+            for (int i = 0; i < n; ++i)
+            {
+                const int frame = start + i - preroll;
+                if (frame < 0)
+                    continue;
+
+                const int index = wrap(origin + static_cast<juce::int64>(frame) * direction);
+                float l = blockL[static_cast<size_t>(i)];
+                float r = blockR[static_cast<size_t>(i)];
+
+                if (frame >= effectiveLength)
+                {
+                    // Second pass over the first `seam` frames: start fully on it (continuing
+                    // from the cycle's last frame) and hand over to the first pass
+                    const float g = static_cast<float>(frame - effectiveLength) / static_cast<float>(seam);
+                    l += (dest.getSample(0, index) - l) * g;
+                    r += (dest.getSample(1, index) - r) * g;
+                }
+
+                if (!dest.commit(index))
+                    return false;  // Memory budget (or the headroom kept for recording) ran out
+
+                dest.setSample(0, index, l);
+                dest.setSample(1, index, r);
+            }
+        }
+
+        return true;
+    }
+
+    // Add this layer's buffer content WITH all per-layer effects applied
+    // This renders the layer as it would sound during playback, including:
+    // - Volume & Pan
+    // - EQ (3-band)
+    // - Pitch shift (per-layer)
+    // - Reverse
+    // - Loop bounds (start/end)
+    // - Fade multiplier
+    void addToBufferWithEffects(juce::AudioBuffer<float>& destBuffer, double sampleRate) const
+    {
+        if (destBuffer.getNumChannels() < 2)
+            return;
+
+        EffectsRenderState state;
+        beginEffectsRender(state, sampleRate);
+        renderWithEffects(state, destBuffer.getWritePointer(0), destBuffer.getWritePointer(1),
+                          destBuffer.getNumSamples(), destBuffer.getNumSamples());
     }
 
     // Set this layer's buffer from an external buffer (for flattening)
@@ -450,37 +787,42 @@ public:
         if (numChannels >= 1)
         {
             const float* srcL = srcBuffer.getReadPointer(0);
-            std::copy(srcL, srcL + loopLength, bufferL.begin());
+            storage.copyFrom(0, 0, srcL, loopLength);
         }
 
         if (numChannels >= 2)
         {
             const float* srcR = srcBuffer.getReadPointer(1);
-            std::copy(srcR, srcR + loopLength, bufferR.begin());
+            storage.copyFrom(1, 0, srcR, loopLength);
         }
         else if (numChannels >= 1)
         {
             // Mono source - copy to both channels
             const float* srcL = srcBuffer.getReadPointer(0);
-            std::copy(srcL, srcL + loopLength, bufferR.begin());
+            storage.copyFrom(1, 0, srcL, loopLength);
         }
 
+        // Drop any chunks left over from a longer previous loop
+        storage.releaseFrom(loopLength);
+        waveformPeaks.rebuild(loopLength);
+        invalidatePlaybackCache();
+
         // Set state to playing
         writeHead = loopLength;
-        playHead = 0.0f;
+        playHead = LoopPhase();
         loopStart = 0;
         loopEnd = loopLength;
         targetLoopLength = loopLength;
         state.store(State::Playing);
         currentFadeMultiplier.store(1.0f);
 
-        DBG("LoopBuffer::setFromBuffer() - Set " + juce::String(loopLength) + " samples");
+        logEvent(AudioLog::Event::BufferSet, loopLength);
     }
 
     // Set buffer content while preserving playhead and state (for seamless flatten)
     // This replaces the audio data without interrupting playback
     void setFromBufferSeamless(const juce::AudioBuffer<float>& srcBuffer, int length,
-                                float preservedPlayhead, State preservedState)
+                                LoopPhase preservedPlayhead, State preservedState)
     {
         loopLength = std::min(length, maxLoopSamples);
         if (loopLength <= 0)
@@ -491,21 +833,53 @@ public:
         if (numChannels >= 1)
         {
             const float* srcL = srcBuffer.getReadPointer(0);
-            std::copy(srcL, srcL + loopLength, bufferL.begin());
+            storage.copyFrom(0, 0, srcL, loopLength);
         }
 
         if (numChannels >= 2)
         {
             const float* srcR = srcBuffer.getReadPointer(1);
-            std::copy(srcR, srcR + loopLength, bufferR.begin());
+            storage.copyFrom(1, 0, srcR, loopLength);
         }
         else if (numChannels >= 1)
         {
             // Mono source - copy to both channels
             const float* srcL = srcBuffer.getReadPointer(0);
-            std::copy(srcL, srcL + loopLength, bufferR.begin());
+            storage.copyFrom(1, 0, srcL, loopLength);
         }
 
+        // Drop any chunks left over from a longer previous loop
+        storage.releaseFrom(loopLength);
+        waveformPeaks.rebuild(loopLength);
+        invalidatePlaybackCache();
+
+        // Preserve playback state for seamless transition
+        writeHead = loopLength;
+        playHead = preservedPlayhead;  // Keep current position
+        loopStart = 0;
+        loopEnd = loopLength;
+        targetLoopLength = loopLength;
+        state.store(preservedState);  // Keep current state (Playing/Overdubbing/etc)
+        currentFadeMultiplier.store(1.0f);  // Reset fade since layers are merged
+        lastPlayheadPosition = static_cast<float>(playHead.toSamples() / loopLength);  // Sync for fade detection
+
+        logEvent(AudioLog::Event::BufferSetSeamless, loopLength, preservedPlayhead.toSamples());
+    }
+
+    // Take over audio rendered elsewhere (flatten) in O(1) while preserving playhead and state.
+    // The chunk tables and waveform summaries are exchanged, so renderedStorage/renderedPeaks
+    // are left holding this layer's old audio - callers release() them afterwards.
+    void adoptRenderedAudio(LoopStorage& renderedStorage, WaveformPyramid& renderedPeaks, int length,
+                            LoopPhase preservedPlayhead, State preservedState)
+    {
+        loopLength = std::min(length, maxLoopSamples);
+        if (loopLength <= 0)
+            return;
+
+        storage.swapWith(renderedStorage);
+        waveformPeaks.swapWith(renderedPeaks);
+        invalidatePlaybackCache();
+
         // Preserve playback state for seamless transition
         writeHead = loopLength;
         playHead = preservedPlayhead;  // Keep current position
@@ -514,10 +888,10 @@ public:
         targetLoopLength = loopLength;
         state.store(preservedState);  // Keep current state (Playing/Overdubbing/etc)
         currentFadeMultiplier.store(1.0f);  // Reset fade since layers are merged
-        lastPlayheadPosition = playHead / static_cast<float>(loopLength);  // Sync for fade detection
+        lastPlayheadPosition = static_cast<float>(playHead.toSamples() / loopLength);  // Sync for fade detection
+        waveformCacheDirty = true;
 
-        DBG("LoopBuffer::setFromBufferSeamless() - Set " + juce::String(loopLength) +
-            " samples, preserved playhead at " + juce::String(preservedPlayhead));
+        logEvent(AudioLog::Event::BufferSetSeamless, loopLength, preservedPlayhead.toSamples());
     }
 
     // Transport controls
@@ -528,8 +902,7 @@ public:
             clear();
             targetLoopLength = targetLengthSamples;  // 0 = free/unlimited
             state.store(State::Recording);
-            DBG("LoopBuffer::startRecording() targetLength=" + juce::String(targetLengthSamples) +
-                " samples (" + juce::String(targetLengthSamples / currentSampleRate, 2) + "s)");
+            logEvent(AudioLog::Event::RecordingStarted, targetLengthSamples);
         }
     }
 
@@ -543,7 +916,7 @@ public:
             // Finalize loop length
             loopLength = writeHead;
             loopEnd = loopLength;
-            playHead = 0.0f;
+            playHead = LoopPhase();
 
             // If continueToOverdub is true, go into overdub mode instead of just playing
             if (continueToOverdub)
@@ -555,22 +928,10 @@ public:
                 state.store(State::Playing);
             }
 
-            juce::String msg = "LoopBuffer::stopRecording() - loopLength=" + juce::String(loopLength) +
-                " samples (" + juce::String(loopLength / currentSampleRate, 2) + "s)" +
-                " at sampleRate=" + juce::String(currentSampleRate) +
-                " continueToOverdub=" + juce::String(continueToOverdub ? "true" : "false");
-            DBG(msg);
-
-            // Write to log file for DAW debugging - Documents folder
-            {
-                juce::File logFile = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
-                    .getChildFile("LoopEngine_debug.log");
-                logFile.appendText(juce::Time::getCurrentTime().toString(true, true) + " - " + msg + "\n");
-
-                // Also log the current playback rate
-                juce::String rateMsg = "Current playbackRate target=" + juce::String(playbackRateSmoothed.getTargetValue(), 3);
-                logFile.appendText(juce::Time::getCurrentTime().toString(true, true) + " - " + rateMsg + "\n");
-            }
+            // Often called from processRecording() - the log writer thread formats this and
+            // appends it to the Documents debug log for DAW debugging
+            logEvent(AudioLog::Event::RecordingStopped, loopLength, currentSampleRate,
+                     continueToOverdub, playbackRateSmoothed.getTargetValue());
 
             // Apply crossfade at loop boundary for seamless looping
             // Pass true for initial recording (needs fade-in at start)
@@ -601,15 +962,16 @@ public:
     // The new layer starts empty but synced with other layers
     void startOverdubOnNewLayer(int masterLoopLengthSamples)
     {
-        // Clear this layer's buffers
-        std::fill(bufferL.begin(), bufferL.end(), 0.0f);
-        std::fill(bufferR.begin(), bufferR.end(), 0.0f);
+        // Release this layer's chunks - the new layer starts silent and commits as it is written
+        storage.release();
+        waveformPeaks.reset();
+        invalidatePlaybackCache();
 
         // Set up loop parameters to match master loop
         loopLength = masterLoopLengthSamples;
         loopStart = 0;
         loopEnd = loopLength;
-        playHead = 0.0f;  // Will be synced to master playhead
+        playHead = LoopPhase();  // Will be synced to master playhead
         writeHead = 0;
         currentFadeMultiplier.store(1.0f);
         lastPlayheadPosition = 0.0f;
@@ -626,8 +988,7 @@ public:
         // (the loopLength > 0 makes hasContent() true)
 
         state.store(State::Overdubbing);
-        DBG("LoopBuffer::startOverdubOnNewLayer() loopLength=" + juce::String(loopLength) +
-            " samples (" + juce::String(loopLength / currentSampleRate, 2) + "s)");
+        logEvent(AudioLog::Event::OverdubStartedOnNewLayer, loopLength);
     }
 
     void stopOverdub()
@@ -639,7 +1000,7 @@ public:
             isOverdubFadingOut = true;
             overdubFadeOutCounter = OVERDUB_FADE_SAMPLES;
             // Note: state stays Overdubbing until fade-out completes
-            DBG("stopOverdub() - starting fade-out");
+            logEvent(AudioLog::Event::OverdubFadeOutStarted);
         }
     }
 
@@ -652,7 +1013,7 @@ public:
             overdubFadeOutCounter = 0;
             state.store(State::Playing);
             waveformCacheDirty = true;  // Regenerate waveform with new overdub content
-            DBG("stopOverdubImmediate() - immediate switch to Playing");
+            logEvent(AudioLog::Event::OverdubStoppedImmediate);
         }
     }
 
@@ -669,13 +1030,13 @@ public:
             {
                 // For reverse playback, start from the end
                 const int effectiveEnd = loopEnd > 0 ? loopEnd : loopLength;
-                playHead = static_cast<float>(effectiveEnd - 1);
+                playHead = LoopPhase::fromIndex(effectiveEnd - 1);
                 lastPlayheadPosition = 1.0f;  // Start at end for reverse
             }
             else
             {
                 // For forward playback, start from the beginning
-                playHead = static_cast<float>(loopStart);
+                playHead = LoopPhase::fromIndex(loopStart);
                 lastPlayheadPosition = 0.0f;
             }
             state.store(State::Playing);
@@ -685,11 +1046,10 @@ public:
     void stop()
     {
         state.store(State::Idle);
-        // Reset pitch shifters to prevent latent audio from continuing
-        blockPitchShifter.reset();
-        phaseVocoder.reset();
+        // Hand the pitch shifter back so latent audio can't continue
+        releasePitchShifter();
         // Reset playhead so any subsequent reads return silence until play() is called
-        playHead = 0.0f;
+        playHead = LoopPhase();
         lastPlayheadPosition = 0.0f;
         // Reset granular pitch shifter state
         initGrains();
@@ -720,10 +1080,9 @@ public:
         float clampedRate = std::clamp(rate, 0.25f, 4.0f);
         playbackRateSmoothed.setTargetValue(clampedRate);
         // Only log when rate actually changes significantly
-        static float lastLoggedRate = 1.0f;
         if (std::abs(clampedRate - lastLoggedRate) > 0.01f)
         {
-            DBG("LoopBuffer::setPlaybackRate(" + juce::String(rate, 3) + ") -> clamped to " + juce::String(clampedRate, 3));
+            logEvent(AudioLog::Event::PlaybackRateChanged, rate, clampedRate);
             lastLoggedRate = clampedRate;
         }
     }
@@ -731,6 +1090,7 @@ public:
     void setReverse(bool reversed)
     {
         isReversed.store(reversed);
+        pitchShifterNeedsPreroll.store(true);  // The look-ahead feed is now on the wrong side
     }
 
     // Pitch shift in semitones (-12 to +12)
@@ -740,12 +1100,11 @@ public:
         // Convert semitones to pitch ratio: ratio = 2^(semitones/12)
         float targetRatio = std::pow(2.0f, clampedSemitones / 12.0f);
         pitchRatioSmoothed.setTargetValue(targetRatio);
-
-        // Debug logging
-        static int logCounter = 0;
-        if (++logCounter % 10000 == 0) {
-            DBG("setPitchShift: semitones=" + juce::String(semitones, 2) +
-                " -> ratio=" + juce::String(targetRatio, 4));
+        // Called every block - only log actual changes
+        if (std::abs(clampedSemitones - lastLoggedPitchShift) > 0.01f)
+        {
+            logEvent(AudioLog::Event::PitchShiftChanged, semitones, targetRatio);
+            lastLoggedPitchShift = clampedSemitones;
         }
     }
 
@@ -822,6 +1181,10 @@ public:
             return;
         }
 
+        // Recording and overdubbing change the audio a playback cache was rendered from
+        if (currentState == State::Recording || currentState == State::Overdubbing)
+            invalidatePlaybackCache();
+
         // For other states, use sample-by-sample processing
         for (int i = 0; i < numSamples; ++i)
         {
@@ -859,6 +1222,9 @@ public:
             if (rightChannel)
                 rightChannel[i] = outputR;
         }
+
+        // Fold this block's writes into the waveform summary
+        waveformPeaks.flush();
     }
 
     // Block-optimized playing - processes entire buffer at once for efficiency
@@ -876,6 +1242,22 @@ public:
             pitchOutputL.resize(numSamples, 0.0f);
             pitchOutputR.resize(numSamples, 0.0f);
         }
+        if (readScratch.capacity() < numSamples)
+        {
+            blockReadIndices.resize(numSamples, 0);
+            blockReadFracs.resize(numSamples, 0.0f);
+            aheadReadIndices.resize(numSamples, 0);
+            aheadReadFracs.resize(numSamples, 0.0f);
+            switchReadIndices.resize(numSamples, 0);
+            switchReadFracs.resize(numSamples, 0.0f);
+            switchOutputL.resize(numSamples, 0.0f);
+            switchOutputR.resize(numSamples, 0.0f);
+            blockFadeGains.resize(numSamples, 0.0f);
+            blockRates.resize(numSamples, 0.0f);
+            readScratch.prepare(numSamples);
+            cacheReadL.resize(numSamples, 0.0f);
+            cacheReadR.resize(numSamples, 0.0f);
+        }
 
         // Get pitch ratio for this block (read once, not per-sample)
         // Combine global pitch with per-layer pitch
@@ -887,13 +1269,6 @@ public:
         const float pitchDistance = std::abs(pitchRatio - 1.0f);
         const bool isPitchShifting = pitchDistance >= 0.002f;
 
-        // Check if pitch shifter quality needs to be reconfigured
-        if (needsPitchShifterReconfigure.load())
-        {
-            blockPitchShifter.setHighQuality(layerPitchHQ.load());
-            needsPitchShifterReconfigure.store(false);
-        }
-
         // Fade handling (simplified for block processing)
         const float fadeTarget = fadeSmoothed.getTargetValue();
         float fadeToApply = currentFadeMultiplier.load();
@@ -909,7 +1284,67 @@ public:
             return;
         }
 
+        // Pre-rendered cache: usable at unity rate once a render for exactly these settings
+        // is installed. While playback sits fully on it the live pitch/EQ path doesn't run;
+        // coming back, its filters restart from silence and the shifter restarts its feed,
+        // as after advance(), under the cache -> live crossfade.
+        const PlaybackCacheKey cacheKey = makePlaybackCacheKey(pitchRatio, effectiveStart, effectiveEnd);
+        trackPlaybackCacheKey(cacheKey, numSamples);
+        const bool atUnityRate = !playbackRateSmoothed.isSmoothing()
+                              && playbackRateSmoothed.getCurrentValue() == 1.0f;
+        const bool cacheUsable = atUnityRate && playbackCacheValid && playbackCacheKey == cacheKey;
+        const bool runLiveDSP = !cacheUsable || playbackCacheBlend < 1.0f;
+
+        if (runLiveDSP && liveDSPSuspended)
+        {
+            antiAliasLpfL = antiAliasLpfR = 0.0f;
+            resetEQState();
+            pitchShifterCold = true;
+        }
+        liveDSPSuspended = !runLiveDSP;
+
+        // Pitched layers lease a shifter and feed it look-ahead: audio read lookAhead samples
+        // past the playhead, which the stretch engine's own delay brings back in line with
+        // the playhead - pitched and unpitched layers stay sample-aligned with no added latency.
+        // The feed keeps its own phase, stepped with the playhead sample by sample, so rate
+        // ramps don't make it jump. A shifter whose feed broke off (fresh lease, re-entry from
+        // unity or the cache, blocks skipped by advance(), reverse toggle, playhead moved)
+        // restarts it lookAhead past the playhead and primes from the normal per-block feed -
+        // no burst of extra work. Until it has been fed past its latency the layer is silent
+        // (never the dry read at the wrong pitch), then the pitched output fades in.
+        PitchShifterPool::Shifter* shifter = runLiveDSP && isPitchShifting ? acquirePitchShifter() : nullptr;
+        const bool reversed = isReversed.load();
+        if (shifter != nullptr)
+        {
+            const bool restartRequested = pitchShifterNeedsPreroll.exchange(false);
+            if (restartRequested || pitchShifterCold || playHead.raw != playheadAtBlockEnd.raw
+                || !mainFeed.matches(reversed, effectiveStart, effectiveEnd))
+            {
+                restartFeed(mainFeed, shifter->block, pitchRatio, reversed, effectiveStart, effectiveEnd);
+                pitchWetBlend = 0.0f;
+                // A layer that was just heard fades out instead of cutting off; a cold one
+                // (unmuted, unsoloed, back from the cache) starts silent
+                pitchDryTail = pitchShifterCold ? 0.0f : 1.0f;
+                switchFeed.needsRestart = true;
+            }
+        }
+
+        // HQ toggled: a shifter of the new quality runs alongside this one on its own feed
+        // (the presets' latencies differ), primes, then is crossfaded in
+        PitchShifterPool::Shifter* incoming = shifter != nullptr
+            ? updatePitchQualitySwitch(pitchRatio, reversed, effectiveStart, effectiveEnd)
+            : nullptr;
+        if (shifter == nullptr)
+            releaseIncomingShifter();
+        if (runLiveDSP)
+            pitchShifterCold = false;
+
+        // The dry read is needed when bypassing, for the near-unity crossfade, and to fade
+        // out what was playing when the shifter restarted
+        const bool needsDry = runLiveDSP && (shifter == nullptr || pitchDistance < 0.01f || pitchDryTail > 0.0f);
+
         // Phase 1: Read raw loop audio for entire block with real-time crossfade at boundaries
+        // 1a: Walk the playhead for the whole block (positions, fade decay, rate)
         for (int i = 0; i < numSamples; ++i)
         {
             // Advance smoothed values to keep them in sync
@@ -929,88 +1364,102 @@ public:
             }
             else if (loopWrapped)
             {
-                float invFade = 1.0f - fadeTarget;
-                float decayStrength = invFade * invFade;
-                float decayMultiplier = 1.0f - (decayStrength * 0.25f);
-                float targetMultiplier = fadeTarget;
-                float fadeMult = currentFadeMultiplier.load();
+                fadeToApply = applyWrapFade(fadeTarget);
+            }
 
-                if (fadeMult < targetMultiplier)
-                {
-                    float recoveryRate = 0.15f;
-                    fadeMult += (targetMultiplier - fadeMult) * recoveryRate;
-                }
-                else
-                {
-                    fadeMult *= decayMultiplier;
-                }
+            blockReadIndices[i] = playHead.index();
+            blockReadFracs[i] = playHead.fraction();
+            blockFadeGains[i] = fadeToApply;
+            blockRates[i] = playbackRateSmoothed.getCurrentValue();
 
-                currentFadeMultiplier.store(std::max(fadeMult, 0.001f));
-                fadeToApply = fadeMult;
+            if (shifter != nullptr)
+            {
+                aheadReadIndices[i] = mainFeed.phase.index();
+                aheadReadFracs[i] = mainFeed.phase.fraction();
             }
 
-            // Read from buffer with real-time crossfade at loop boundary
-            float rawL, rawR;
-            readWithCrossfade(rawL, rawR, playHead, effectiveStart, effectiveEnd);
-            rawL *= fadeToApply;
-            rawR *= fadeToApply;
+            if (incoming != nullptr)
+            {
+                switchReadIndices[i] = switchFeed.phase.index();
+                switchReadFracs[i] = switchFeed.phase.fraction();
+            }
 
-            // Apply anti-aliasing low-pass filter when playing at high speeds
-            // This prevents aliasing artifacts that cause crackling
-            const float currentRate = playbackRateSmoothed.getCurrentValue();
-            if (currentRate > 1.01f)
+            // Advance playhead, and the feeds by the same step
+            advancePlayhead(false);
+
+            if (shifter != nullptr)
             {
-                // One-pole low-pass filter with cutoff tracking the speed
-                // Higher speed = lower cutoff to prevent aliasing
-                // Coefficient: 0.5 at 2x speed, 0.25 at 4x speed, etc.
-                const float lpfCoeff = std::min(0.9f, 1.0f / currentRate);
-                antiAliasLpfL = lpfCoeff * rawL + (1.0f - lpfCoeff) * antiAliasLpfL;
-                antiAliasLpfR = lpfCoeff * rawR + (1.0f - lpfCoeff) * antiAliasLpfR;
-                rawL = antiAliasLpfL;
-                rawR = antiAliasLpfR;
+                const juce::int64 increment = LoopPhase::incrementForRate(playbackRateSmoothed.getCurrentValue());
+                const juce::int64 step = reversed ? -increment : increment;
+                mainFeed.phase.advance(step, effectiveStart, effectiveEnd);
+                if (incoming != nullptr)
+                    switchFeed.phase.advance(step, effectiveStart, effectiveEnd);
             }
+        }
+        playheadAtBlockEnd = playHead;
 
-            pitchInputL[i] = rawL;
-            pitchInputR[i] = rawR;
+        // 1b: Hermite read of the whole block with real-time crossfade at the loop boundary,
+        // then fade and anti-aliasing. The dry read lands in pitchInput; the look-ahead feed
+        // is read into pitchOutput and shifted in place.
+        if (needsDry)
+        {
+            readBlockWithCrossfade(blockReadIndices.data(), blockReadFracs.data(), numSamples, effectiveStart, effectiveEnd,
+                                   pitchInputL.data(), pitchInputR.data());
+            applyFadeAndAntiAlias(pitchInputL.data(), pitchInputR.data(), numSamples, antiAliasLpfL, antiAliasLpfR);
+        }
 
-            // Advance playhead
-            advancePlayhead(false);
+        if (shifter != nullptr)
+        {
+            readBlockWithCrossfade(aheadReadIndices.data(), aheadReadFracs.data(), numSamples, effectiveStart, effectiveEnd,
+                                   pitchOutputL.data(), pitchOutputR.data());
+            applyFadeAndAntiAlias(pitchOutputL.data(), pitchOutputR.data(), numSamples, mainFeed.lpfL, mainFeed.lpfR);
+        }
+
+        if (incoming != nullptr)
+        {
+            readBlockWithCrossfade(switchReadIndices.data(), switchReadFracs.data(), numSamples, effectiveStart, effectiveEnd,
+                                   switchOutputL.data(), switchOutputR.data());
+            applyFadeAndAntiAlias(switchOutputL.data(), switchOutputR.data(), numSamples, switchFeed.lpfL, switchFeed.lpfR);
         }
 
         // Phase 2: Apply pitch shifting to entire block at once (THE KEY OPTIMIZATION)
-        if (isPitchShifting)
+        if (shifter != nullptr)
         {
-            blockPitchShifter.setPitchRatio(pitchRatio);
-            blockPitchShifter.processBlock(pitchInputL.data(), pitchInputR.data(),
-                                           pitchOutputL.data(), pitchOutputR.data(), numSamples);
+            shifter->block.setPitchRatio(pitchRatio);
+            shifter->block.processBlock(pitchOutputL.data(), pitchOutputR.data(),
+                                        pitchOutputL.data(), pitchOutputR.data(), numSamples);
+            const int firstPrimed = mainFeed.firstPrimedSample(numSamples);
+            mainFeed.addFed(numSamples);
 
-            // Crossfade near unity for smooth transition
-            if (pitchDistance < 0.01f)
+            if (incoming != nullptr)
             {
-                float crossfade = pitchDistance / 0.01f;
-                for (int i = 0; i < numSamples; ++i)
-                {
-                    pitchOutputL[i] = pitchInputL[i] * (1.0f - crossfade) + pitchOutputL[i] * crossfade;
-                    pitchOutputR[i] = pitchInputR[i] * (1.0f - crossfade) + pitchOutputR[i] * crossfade;
-                }
+                incoming->block.setPitchRatio(pitchRatio);
+                incoming->block.processBlock(switchOutputL.data(), switchOutputR.data(),
+                                             switchOutputL.data(), switchOutputR.data(), numSamples);
+                const int incomingFirstPrimed = switchFeed.firstPrimedSample(numSamples);
+                switchFeed.addFed(numSamples);
+                mixPitchQualitySwitch(numSamples, incomingFirstPrimed);
             }
 
-            wasPitchShifting = true;
+            // Silent until primed, then fade in; near unity keep part of the dry read for a
+            // smooth transition
+            mixPrimedPitched(numSamples, firstPrimed, pitchDistance < 0.01f ? pitchDistance / 0.01f : 1.0f);
         }
         else
         {
-            // No pitch shift - bypass
-            if (wasPitchShifting)
+            // No pitch shift (or no free shifter yet, or playing from the cache) - bypass,
+            // and hand an idle shifter back once the tail-out has passed
+            if (!isPitchShifting || !runLiveDSP)
+                idlePitchShifter(numSamples);
+            if (runLiveDSP)
             {
-                blockPitchShifter.reset();
-                wasPitchShifting = false;
+                std::copy(pitchInputL.begin(), pitchInputL.begin() + numSamples, pitchOutputL.begin());
+                std::copy(pitchInputR.begin(), pitchInputR.begin() + numSamples, pitchOutputR.begin());
             }
-            std::copy(pitchInputL.begin(), pitchInputL.begin() + numSamples, pitchOutputL.begin());
-            std::copy(pitchInputR.begin(), pitchInputR.begin() + numSamples, pitchOutputR.begin());
         }
 
         // Phase 2.5: Apply per-layer 3-band EQ (if active)
-        if (isEQActive())
+        if (runLiveDSP && isEQActive())
         {
             for (int i = 0; i < numSamples; ++i)
             {
@@ -1018,6 +1467,14 @@ public:
             }
         }
 
+        // Phase 2.75: Crossfade to (or from) the pre-rendered cache. Leaving it waits until
+        // the live shifter has primed and faded in, so the layer never drops out meanwhile.
+        if (cacheUsable || playbackCacheBlend > 0.0f)
+        {
+            const bool liveReady = shifter == nullptr || (mainFeed.isPrimed() && pitchWetBlend >= 1.0f);
+            mixPlaybackCache(numSamples, cacheUsable, runLiveDSP, liveReady);
+        }
+
         // Phase 3: Apply volume and pan, then mix with input and write to output buffer
         const float vol = volume.load();
         const float panVal = pan.load();
@@ -1048,6 +1505,76 @@ public:
         }
     }
 
+    // Advance-only playback for a layer whose output would be discarded (fully muted, or
+    // below an override layer). Moves the playhead, smoothers and per-loop fade exactly as
+    // processPlayingBlock() would, without reading audio or running the pitch shifter/EQ.
+    // Only Playing layers can skip their audio; returns false for any other state and
+    // the caller processes the block normally (a muted recording still records).
+    bool advance(int numSamples)
+    {
+        if (state.load() != State::Playing || loopLength <= 0)
+            return false;
+
+        const int effectiveStart = loopStart;
+        const int effectiveEnd = loopEnd > 0 ? loopEnd : loopLength;
+        const int effectiveLength = effectiveEnd - effectiveStart;
+        if (effectiveLength <= 0)
+            return true;  // processPlayingBlock() does nothing here either
+
+        pitchRatioSmoothed.skip(numSamples);
+        fadeSmoothed.skip(numSamples);
+
+        // A wrap on the last step of the previous block is only seen on the next sample
+        int wraps = detectLoopWrap(lastPlayheadPosition, getPlayheadPosition()) ? 1 : 0;
+
+        const bool reversed = isReversed.load();
+        const juce::int64 lengthRaw = static_cast<juce::int64>(effectiveLength) * LoopPhase::ONE;
+
+        if (playbackRateSmoothed.isSmoothing())
+        {
+            // Rate ramp: step the phase per sample, still no audio reads
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const LoopPhase before = playHead;
+                advancePlayhead(false);
+                if (reversed ? playHead.raw > before.raw : playHead.raw < before.raw)
+                    ++wraps;
+            }
+        }
+        else
+        {
+            // Constant rate: one multiply, wraps counted from the distance travelled
+            const juce::int64 increment = LoopPhase::incrementForRate(playbackRateSmoothed.getCurrentValue());
+            const juce::int64 distance = (reversed ? -increment : increment) * numSamples;
+
+            playHead.wrap(effectiveStart, effectiveEnd);
+            const juce::int64 offset = playHead.raw - static_cast<juce::int64>(effectiveStart) * LoopPhase::ONE;
+            const juce::int64 target = offset + distance;
+            if (target >= lengthRaw)
+                wraps += static_cast<int>(target / lengthRaw);
+            else if (target < 0)
+                wraps += static_cast<int>((-target + lengthRaw - 1) / lengthRaw);
+
+            playHead.advance(distance, effectiveStart, effectiveEnd);
+        }
+        lastPlayheadPosition = getPlayheadPosition();
+
+        const float fadeTarget = fadeSmoothed.getTargetValue();
+        if (fadeTarget >= 0.99f)
+            currentFadeMultiplier.store(1.0f);
+        else
+            for (int w = 0; w < wraps; ++w)
+                applyWrapFade(fadeTarget);
+
+        // Filter histories would be stale when the layer comes back - start from silence
+        antiAliasLpfL = antiAliasLpfR = 0.0f;
+        prevOutputL = prevOutputR = 0.0f;
+        prevInputL = prevInputR = 0.0f;
+        resetEQState();
+        pitchShifterCold = true;
+        return true;
+    }
+
     // State getters
     State getState() const { return state.load(); }
 
@@ -1060,7 +1587,7 @@ public:
         if (effectiveLength <= 0)
             return 0.0f;
 
-        float relativePos = (playHead - loopStart) / static_cast<float>(effectiveLength);
+        float relativePos = static_cast<float>((playHead.toSamples() - loopStart) / effectiveLength);
         return std::clamp(relativePos, 0.0f, 1.0f);
     }
 
@@ -1087,11 +1614,40 @@ public:
         return static_cast<float>(end) / static_cast<float>(loopLength);
     }
 
-    // Get raw playhead position for syncing
-    float getRawPlayhead() const { return playHead; }
+    // Get raw playhead position for syncing (exact fixed-point phase)
+    LoopPhase getRawPlayhead() const { return playHead; }
+
+    // Output samples until the playhead next lands on a grid line - a multiple of
+    // gridSamples from the loop region start, in the play direction; the region end is
+    // always a line. Assumes the current playback rate holds. -1 when not playing.
+    double samplesUntilGridLine(double gridSamples) const
+    {
+        const State currentState = state.load();
+        if ((currentState != State::Playing && currentState != State::Overdubbing) || loopLength <= 0)
+            return -1.0;
+
+        const double regionStart = static_cast<double>(loopStart);
+        const double regionEnd = static_cast<double>(loopEnd > 0 ? loopEnd : loopLength);
+        const double rate = static_cast<double>(playbackRateSmoothed.getTargetValue());
+        if (regionEnd <= regionStart || rate <= 0.0 || gridSamples <= 0.0)
+            return -1.0;
+
+        const double offset = playHead.toSamples() - regionStart;
+        double distance;
+        if (isReversed.load())
+            distance = offset - std::floor(offset / gridSamples) * gridSamples;
+        else
+            distance = std::min(std::ceil(offset / gridSamples) * gridSamples, regionEnd - regionStart) - offset;
+
+        return std::max(0.0, distance) / rate;
+    }
 
     // Set playhead position (for syncing with other layers)
-    void setPlayhead(float position) { playHead = position; }
+    void setPlayhead(LoopPhase position)
+    {
+        playHead = position;
+        pitchShifterNeedsPreroll.store(true);
+    }
 
     // Peek at playback content without advancing state (for Layer mode bounce)
     // Reads what this layer would output at current playhead position
@@ -1127,7 +1683,7 @@ public:
         const float panL = std::cos(panAngle);
         const float panR = std::sin(panAngle);
 
-        float peekHead = playHead;
+        float peekHead = static_cast<float>(playHead.toSamples());
 
         for (int i = 0; i < numSamples; ++i)
         {
@@ -1187,7 +1743,7 @@ public:
         const float rate = playbackRateSmoothed.getTargetValue();
         const bool reversed = isReversed.load();
 
-        float peekHead = playHead;
+        float peekHead = static_cast<float>(playHead.toSamples());
 
         for (int i = 0; i < numSamples; ++i)
         {
@@ -1315,16 +1871,11 @@ public:
         return layerPitchSemitones.load();
     }
 
+    // Any thread. Nothing is re-prepared here: the audio thread sees the layer's shifter
+    // no longer matches, leases one of the new quality and crossfades over to it.
     void setLayerPitchHQ(bool hq)
     {
-        bool wasHQ = layerPitchHQ.load();
         layerPitchHQ.store(hq);
-
-        // If quality changed, we need to re-prepare the pitch shifter
-        if (wasHQ != hq)
-        {
-            needsPitchShifterReconfigure = true;
-        }
     }
 
     bool getLayerPitchHQ() const
@@ -1344,141 +1895,23 @@ public:
         if (loopLength <= 0)
             return;
 
-        for (int i = 0; i < loopLength; ++i)
-        {
-            bufferL[i] = softClip(bufferL[i]);
-            bufferR[i] = softClip(bufferR[i]);
-        }
-        DBG("applyBufferSoftClip() - Applied soft clipping to " + juce::String(loopLength) + " samples");
-    }
-
-    // ============================================
-    // ADDITIVE RECORDING (Blooper-style punch-in/out)
-    // Records effected audio directly into this layer in realtime
-    // ============================================
-
-    // Prepare this layer for additive recording
-    // Sets up the buffer with the target loop length and syncs to current playhead
-    void prepareForAdditiveRecording(int targetLoopLength, int startPlayheadSamples)
-    {
-        // Safety checks
-        if (targetLoopLength <= 0 || targetLoopLength > maxLoopSamples)
-        {
-            DBG("prepareForAdditiveRecording() - INVALID targetLoopLength=" + juce::String(targetLoopLength));
-            return;
-        }
-
-        // Clear any existing content
-        clear();
-
-        // Set up the loop length to match master
-        loopLength = targetLoopLength;
-
-        // Clamp startPlayheadSamples to valid range
-        if (startPlayheadSamples < 0) startPlayheadSamples = 0;
-        if (startPlayheadSamples >= loopLength) startPlayheadSamples = startPlayheadSamples % loopLength;
-
-        // Initialize buffer (should already be allocated in prepare())
-        // Use safe bounds
-        int fillEnd = std::min(loopLength, static_cast<int>(bufferL.size()));
-        std::fill(bufferL.begin(), bufferL.begin() + fillEnd, 0.0f);
-        std::fill(bufferR.begin(), bufferR.begin() + fillEnd, 0.0f);
-
-        // Set playhead to match the current position
-        playHead = static_cast<float>(startPlayheadSamples);
-        writeHead = startPlayheadSamples;
-
-        // Mark as playing (so it contributes to output and advances playhead)
-        state = State::Playing;
-        hasContentFlag = false;  // Will be set true when we write content
-
-        // Track that we're in additive recording mode
-        additiveRecordingMode = true;
-        additiveWriteHead = startPlayheadSamples;
-
-        DBG("prepareForAdditiveRecording() - loopLength=" + juce::String(loopLength) +
-            " startPlayhead=" + juce::String(startPlayheadSamples));
-    }
-
-    // Write effected audio into this layer (called from PluginProcessor)
-    // Writes at the current additive write head position
-    void writeAdditiveAudio(const juce::AudioBuffer<float>& buffer, int numSamples)
-    {
-        if (!additiveRecordingMode || loopLength <= 0)
-            return;
-
-        // Safety: ensure we have valid buffer size
-        const int bufferSize = static_cast<int>(bufferL.size());
-        if (bufferSize <= 0 || loopLength > bufferSize)
-            return;
-
-        const int numChannels = buffer.getNumChannels();
-        const float* leftIn = numChannels > 0 ? buffer.getReadPointer(0) : nullptr;
-        const float* rightIn = numChannels > 1 ? buffer.getReadPointer(1) : nullptr;
-
-        for (int i = 0; i < numSamples; ++i)
-        {
-            // Ensure write head is in bounds
-            if (additiveWriteHead < 0 || additiveWriteHead >= loopLength)
-            {
-                additiveWriteHead = additiveWriteHead % loopLength;
-                if (additiveWriteHead < 0) additiveWriteHead = 0;
-            }
-
-            // Soft clip the input to prevent runaway accumulation
-            float sampleL = leftIn ? softClip(leftIn[i]) : 0.0f;
-            float sampleR = rightIn ? softClip(rightIn[i]) : sampleL;
-
-            // Write to buffer at current position
-            bufferL[additiveWriteHead] = sampleL;
-            bufferR[additiveWriteHead] = sampleR;
-
-            // Track if we've written any significant content
-            if (std::abs(sampleL) > 0.001f || std::abs(sampleR) > 0.001f)
-            {
-                hasContentFlag = true;
-            }
-
-            // Advance write head with wrap
-            additiveWriteHead++;
-            if (additiveWriteHead >= loopLength)
-            {
-                additiveWriteHead = 0;
-            }
-        }
-
-        // Sync playhead with write head during additive recording
-        playHead = static_cast<float>(additiveWriteHead);
-    }
-
-    // Stop additive recording mode
-    void stopAdditiveRecording()
-    {
-        if (!additiveRecordingMode)
-            return;
-
-        additiveRecordingMode = false;
-
-        // Keep state as Playing if we have content
-        if (hasContentFlag)
-        {
-            state = State::Playing;
-            DBG("stopAdditiveRecording() - Layer has content, continuing playback");
-        }
-        else
-        {
-            state = State::Idle;
-            DBG("stopAdditiveRecording() - No content recorded");
-        }
-
-        // Invalidate waveform cache to show new content
-        waveformCacheDirty = true;
-    }
-
-    // Check if currently in additive recording mode
-    bool isInAdditiveRecordingMode() const
-    {
-        return additiveRecordingMode;
+        // Only chunks that hold audio and actually exceed full scale are rewritten - silent
+        // regions stay uncommitted and shared chunks aren't copied for nothing
+        rewriteCommittedSpans([](const float* data, int n)
+                              {
+                                  for (int i = 0; i < n; ++i)
+                                      if (std::abs(data[i]) > 1.0f)
+                                          return true;
+                                  return false;
+                              },
+                              [](float* data, int n)
+                              {
+                                  for (int i = 0; i < n; ++i)
+                                      data[i] = softClip(data[i]);
+                              });
+        waveformPeaks.rebuild(loopLength);
+        invalidatePlaybackCache();
+        logEvent(AudioLog::Event::BufferSoftClipped, loopLength);
     }
 
     // Get waveform data for UI visualization (downsampled)
@@ -1504,17 +1937,90 @@ public:
         return result;
     }
 
+    // Get min/max/peak data for [startSample, endSample) at numPoints resolution (zoomable editor view)
+    // Served from the peak pyramid; zoomed past one block per point it reads single samples.
+    // Fade multiplier is applied like getWaveformData(). Range is clamped to the recorded audio.
+    std::vector<WaveformPyramid::Peak> getWaveformRange(int startSample, int endSample, int numPoints) const
+    {
+        std::vector<WaveformPyramid::Peak> result(static_cast<size_t>(std::max(0, numPoints)));
+
+        const int visibleLength = getWaveformLengthSamples();
+        startSample = std::clamp(startSample, 0, std::max(0, visibleLength));
+        endSample = std::clamp(endSample, startSample, std::max(0, visibleLength));
+        if (numPoints <= 0 || endSample <= startSample)
+            return result;
+
+        waveformPeaks.getPeaks(startSample, endSample, numPoints, result.data());
+
+        const float fadeMultiplier = currentFadeMultiplier.load();
+        for (auto& point : result)
+        {
+            point.min *= fadeMultiplier;
+            point.max *= fadeMultiplier;
+            point.peak *= fadeMultiplier;
+        }
+        return result;
+    }
+
+    // Samples covered by the waveform (writeHead while recording, loop length otherwise)
+    int getWaveformLengthSamples() const
+    {
+        return (state.load() == State::Recording) ? writeHead : loopLength;
+    }
+
     // Get recording progress (0-1) for UI
     float getRecordingProgress() const
     {
-        if (state.load() != State::Recording || targetLoopLength <= 0)
-            return 0.0f;
-        return static_cast<float>(writeHead) / static_cast<float>(targetLoopLength);
+        if (state.load() != State::Recording || targetLoopLength <= 0)
+            return 0.0f;
+        return static_cast<float>(writeHead) / static_cast<float>(targetLoopLength);
+    }
+
+private:
+    // Layer audio, committed chunk by chunk from the engine's LoopChunkPool
+    LoopStorage storage;
+
+    // Min/max peak summary of storage, kept current as samples are written
+    WaveformPyramid waveformPeaks;
+
+    // Audio-thread diagnostics (owned by the engine); never format strings on the audio path
+    AudioLog* audioLog = nullptr;
+    int logSource = -1;
+    float lastLoggedRate = 1.0f;
+    float lastLoggedPitchShift = 0.0f;
+
+    template <typename... Args>
+    void logEvent(AudioLog::Event event, Args... args) const noexcept
+    {
+        if (audioLog != nullptr)
+            audioLog->log(event, logSource, static_cast<double>(args)...);
     }
 
-private:
-    std::vector<float> bufferL;
-    std::vector<float> bufferR;
+    // Transport/playback state shared by copyFrom() and moveFrom()
+    void copyStateFrom(const LoopBuffer& other)
+    {
+        writeHead = other.writeHead;
+        playHead = other.playHead;
+        loopStart = other.loopStart;
+        loopEnd = other.loopEnd;
+        targetLoopLength = other.targetLoopLength;
+        state.store(other.state.load());
+        isReversed.store(other.isReversed.load());
+        isMuted.store(other.isMuted.load());
+        // Sync mute gain smoother with muted state
+        muteGainSmoothed.setCurrentAndTargetValue(other.isMuted.load() ? 0.0f : 1.0f);
+        fadeActive.store(other.fadeActive.load());
+        currentFadeMultiplier.store(other.currentFadeMultiplier.load());
+        lastPlayheadPosition = other.lastPlayheadPosition;
+
+        // Hand the pitch shifter back (its internal state shouldn't carry over)
+        releasePitchShifter();
+        initGrains();
+        invalidatePlaybackCache();
+
+        // Invalidate waveform cache since content changed
+        waveformCacheDirty = true;
+    }
 
     int maxLoopSamples = 0;
     double currentSampleRate = 44100.0;
@@ -1522,7 +2028,7 @@ private:
 
     // Position tracking
     int writeHead = 0;
-    float playHead = 0.0f;
+    LoopPhase playHead;  // 32.32 fixed-point sample position (exact across hours of playback)
     int loopLength = 0;
     int loopStart = 0;
     int loopEnd = 0;
@@ -1542,7 +2048,6 @@ private:
     // Per-layer pitch shift (independent of global/playback pitch)
     std::atomic<float> layerPitchSemitones { 0.0f };  // Per-layer pitch shift in semitones (-24 to +24)
     std::atomic<bool> layerPitchHQ { false };         // Use high-quality pitch shifting for this layer
-    std::atomic<bool> needsPitchShifterReconfigure { false };  // Flag to reconfigure pitch shifter quality
 
     // Per-layer 3-band EQ parameters (linear gain, 1.0 = unity)
     std::atomic<float> eqLowGain { 1.0f };   // Low shelf at 200Hz
@@ -1582,8 +2087,10 @@ private:
     static constexpr int GRAIN_SIZE = 2048;  // Grain size in samples
     float grainPhase = 0.0f;       // Phase within current grain cycle (0-1)
     float pitchReadPos1 = 0.0f;    // Continuous read position for grain 1
+    int pitchLogCounter = 0;       // Per layer, not static - layers may render on different threads
     float pitchReadPos2 = 0.0f;    // Continuous read position for grain 2
-    bool wasPitchShifting = false; // Track when pitch shifting state changes
+    bool pitchShifterCold = false; // advance() skipped blocks - prime before the next audible one
+    std::atomic<bool> pitchShifterNeedsPreroll { false };  // Leased, reset, reversed or moved - restart its feed
 
     // Fade/decay tracking
     std::atomic<float> currentFadeMultiplier { 1.0f };  // Current fade level (starts at 1.0, decays each loop)
@@ -1597,12 +2104,55 @@ private:
     bool skipFirstBlock = false;      // Skip first audio block to avoid residual audio from state transitions
 
     // Additive recording mode (Blooper-style punch-in/out)
-    bool additiveRecordingMode = false;  // True when receiving effected audio from ADD mode
-    int additiveWriteHead = 0;           // Write position for additive recording
     bool hasContentFlag = false;         // Track if any audio was actually written
 
-    // Block-based pitch shifter (efficient, processes entire blocks)
-    StereoBlockPitchShifter blockPitchShifter;
+    // Pitch shifter leased from the engine's pool while the layer is off unity (nullptr at unity)
+    PitchShifterPool* shifterPool = nullptr;
+    PitchShifterPool::Shifter* pitchShifter = nullptr;
+    int pitchShifterIdleSamples = 0;   // Time spent at unity since the shifter was last used
+    int pitchShifterTailSamples = 0;
+
+    // Look-ahead feed into a block pitch shifter: its own read phase, lookAhead samples past
+    // the playhead and stepped with it sample by sample (so rate ramps never make it jump),
+    // its anti-aliasing state, and how far the shifter has been primed since it restarted
+    struct ShifterFeed
+    {
+        LoopPhase phase;
+        float lpfL = 0.0f;
+        float lpfR = 0.0f;
+        int fed = 0;             // Samples fed since the restart (capped at primeTarget)
+        int primeTarget = 0;     // Output is in step with the playhead from here on
+        bool needsRestart = true;
+        bool reversed = false;   // Direction and bounds the phase was placed with
+        int start = 0;
+        int end = 0;
+
+        bool matches(bool isReversed, int effectiveStart, int effectiveEnd) const
+        {
+            return !needsRestart && reversed == isReversed && start == effectiveStart && end == effectiveEnd;
+        }
+
+        // First sample of the next n whose output is in step (n when none is)
+        int firstPrimedSample(int n) const { return juce::jlimit(0, n, primeTarget - fed); }
+        bool isPrimed() const { return fed >= primeTarget; }
+        void addFed(int n) { fed = std::min(fed + n, primeTarget); }
+    };
+
+    ShifterFeed mainFeed;               // pitchShifter's
+    float pitchWetBlend = 0.0f;         // Pitched fade-in once mainFeed has primed after a restart
+    float pitchDryTail = 0.0f;          // Dry read fading out over the restart (declick), 0 when cold
+    int primeFadeSamples = 0;
+    LoopPhase playheadAtBlockEnd;       // A different playhead next block means it was moved
+
+    // HQ toggle in progress: the shifter of the new quality, crossfaded in over qualityFadeSamples
+    PitchShifterPool::Shifter* incomingShifter = nullptr;
+    ShifterFeed switchFeed;             // incomingShifter's
+    float qualitySwitchBlend = 0.0f;
+    int qualityFadeSamples = 0;
+    std::vector<int> switchReadIndices;
+    std::vector<float> switchReadFracs;
+    std::vector<float> switchOutputL;
+    std::vector<float> switchOutputR;
 
     // Pre-allocated buffers for block-based pitch processing
     std::vector<float> pitchInputL;
@@ -1610,6 +2160,31 @@ private:
     std::vector<float> pitchOutputL;
     std::vector<float> pitchOutputR;
 
+    // Block read kernel scratch (see readBlockWithCrossfade)
+    std::vector<int> blockReadIndices;
+    std::vector<float> blockReadFracs;
+    std::vector<int> aheadReadIndices;   // Look-ahead feed positions for the pitch shifter
+    std::vector<float> aheadReadFracs;
+    std::vector<float> blockFadeGains;
+    std::vector<float> blockRates;
+    LoopReadKernel::Scratch readScratch;
+
+    // Pre-rendered playback cache (see renderPlaybackCache)
+    LoopStorage playbackCache;
+    PlaybackCacheKey playbackCacheKey;       // What playbackCache holds, if playbackCacheValid
+    bool playbackCacheValid = false;
+    PlaybackCacheKey trackedCacheKey;        // Current settings, timed for stability
+    int playbackCacheStableSamples = 0;
+    int playbackCacheSettleSamples = 0;
+    PlaybackCacheKey failedCacheKey;         // Render ran out of memory for this key
+    bool hasFailedCacheKey = false;
+    juce::uint32 contentVersion = 0;         // Bumped whenever the layer's audio changes
+    float playbackCacheBlend = 0.0f;         // 0 = live DSP, 1 = cache only
+    int playbackCacheFadeSamples = 0;
+    bool liveDSPSuspended = false;           // Last block played from the cache alone
+    std::vector<float> cacheReadL;
+    std::vector<float> cacheReadR;
+
     // Waveform cache for efficient UI updates
     // Only regenerated when buffer content changes (during recording/overdubbing)
     static constexpr int WAVEFORM_CACHE_POINTS = 100;
@@ -1618,9 +2193,6 @@ private:
     mutable bool waveformCacheDirty = true;
     mutable int lastCachedWriteHead = 0;  // Track writeHead changes during recording
 
-    // Legacy sample-by-sample phase vocoder (kept for compatibility)
-    StereoPhaseVocoder phaseVocoder;
-
     // Anti-aliasing low-pass filter state (one-pole)
     // Used when playback rate > 1.0 to prevent aliasing
     float antiAliasLpfL = 0.0f;
@@ -1638,7 +2210,7 @@ private:
 
         // During recording/overdubbing, ALWAYS regenerate for live animated waveform
         // This is polled at ~50ms intervals from the UI, giving smooth animation
-        // The waveform is only 100 points, so this is efficient enough
+        // Points are read from the incrementally updated peak pyramid, never the raw audio
         if (currentState == State::Recording || currentState == State::Overdubbing)
         {
             // Always update during recording - this is the "beautiful animated rendering"
@@ -1691,14 +2263,9 @@ private:
             const int startSample = i * samplesPerPoint;
             const int endSample = std::min(startSample + samplesPerPoint, maxSampleToShow);
 
+            // Served from the peak pyramid - cost per point doesn't depend on loop length
             if (startSample < maxSampleToShow)
-            {
-                for (int j = startSample; j < endSample; ++j)
-                {
-                    float val = std::abs(bufferL[j]) + std::abs(bufferR[j]);
-                    maxVal = std::max(maxVal, val * 0.5f);
-                }
-            }
+                maxVal = waveformPeaks.getRange(startSample, endSample).peak;
             cachedWaveform[i] = maxVal;
             peakLevel = std::max(peakLevel, maxVal);
         }
@@ -1713,7 +2280,6 @@ private:
         grainPhase = 0.0f;
         pitchReadPos1 = 0.0f;
         pitchReadPos2 = static_cast<float>(GRAIN_SIZE) / 2.0f;  // Offset by half grain
-        wasPitchShifting = false;
     }
 
     // Reset EQ filter state (called from clear())
@@ -1854,35 +2420,29 @@ private:
     {
         // Consume smoothed values to keep them in sync even during recording
         // This prevents stale state when transitioning to playback
-        const float pitchRatio = pitchRatioSmoothed.getNextValue();
+        // (Nothing is pitch shifted while recording - playback primes its own shifter)
+        pitchRatioSmoothed.getNextValue();
         fadeSmoothed.getNextValue();
         playbackRateSmoothed.getNextValue();
 
-        // Only keep phase vocoder running if pitch is shifted
-        // This prevents CPU waste and accumulation issues when at unity pitch
-        const float pitchDistance = std::abs(pitchRatio - 1.0f);
-        if (pitchDistance >= 0.002f)
-        {
-            // Keep vocoder warm with input audio during recording
-            phaseVocoder.setPitchRatio(pitchRatio);
-            float dummyL, dummyR;
-            phaseVocoder.processSample(inputL, inputR, dummyL, dummyR);
-            wasPitchShifting = true;
-        }
-        else if (wasPitchShifting)
-        {
-            // Reset vocoder when returning to unity pitch
-            phaseVocoder.reset();
-            wasPitchShifting = false;
-        }
-
         // Check if we've reached the target length (if set)
         const int effectiveMaxLength = (targetLoopLength > 0) ? targetLoopLength : maxLoopSamples;
 
-        if (writeHead < effectiveMaxLength)
+        if (writeHead < effectiveMaxLength && !storage.commit(writeHead))
+        {
+            // Global loop memory budget exhausted - close the loop at what we have
+            // rather than allocate past the budget. The engine reports this to the UI.
+            logEvent(AudioLog::Event::RecordingBudgetExhausted, writeHead);
+            if (writeHead > 0)
+                stopRecording(false);
+            else
+                clear();
+        }
+        else if (writeHead < effectiveMaxLength)
         {
-            bufferL[writeHead] = inputL;
-            bufferR[writeHead] = inputR;
+            storage.setSample(0, writeHead, inputL);
+            storage.setSample(1, writeHead, inputR);
+            waveformPeaks.markWritten(writeHead);
             ++writeHead;
         }
         else
@@ -1993,13 +2553,15 @@ private:
         const float pitchDistance = std::abs(pitchRatio - 1.0f);
         const bool isPitchShifting = pitchDistance >= 0.002f;
 
-        if (isPitchShifting)
+        PitchShifterPool::Shifter* shifter = isPitchShifting ? acquirePitchShifter() : nullptr;
+
+        if (shifter != nullptr)
         {
             // Run phase vocoder for pitch shifting
-            phaseVocoder.setPitchRatio(pitchRatio);
+            shifter->perSample.setPitchRatio(pitchRatio);
 
             float pitchL, pitchR;
-            phaseVocoder.processSample(rawL, rawR, pitchL, pitchR);
+            shifter->perSample.processSample(rawL, rawR, pitchL, pitchR);
 
             // Crossfade near unity for smooth transition
             if (pitchDistance < 0.01f)
@@ -2017,20 +2579,12 @@ private:
         else
         {
             // No pitch shift - bypass vocoder entirely for CPU savings
-            // Reset vocoder state when returning to unity to prevent stale data
-            if (wasPitchShifting)
-            {
-                phaseVocoder.reset();
-                wasPitchShifting = false;
-            }
+            if (!isPitchShifting)
+                idlePitchShifter(1);
             loopL = rawL;
             loopR = rawR;
         }
 
-        // Track pitch shifting state for next sample
-        if (isPitchShifting)
-            wasPitchShifting = true;
-
         // Mix loop playback with input passthrough for seamless monitoring
         outputL = loopL + inputL;
         outputR = loopR + inputR;
@@ -2109,13 +2663,15 @@ private:
         // (We use the raw existingL/R for buffer operations, but pitched for output)
         float monitorL, monitorR;
 
-        if (isPitchShifting)
+        PitchShifterPool::Shifter* shifter = isPitchShifting ? acquirePitchShifter() : nullptr;
+
+        if (shifter != nullptr)
         {
             // Run phase vocoder for pitch shifting during overdub monitoring
-            phaseVocoder.setPitchRatio(pitchRatio);
+            shifter->perSample.setPitchRatio(pitchRatio);
 
             float pitchL, pitchR;
-            phaseVocoder.processSample(existingL, existingR, pitchL, pitchR);
+            shifter->perSample.processSample(existingL, existingR, pitchL, pitchR);
 
             // Crossfade near unity for smooth transition
             if (pitchDistance < 0.01f)
@@ -2129,22 +2685,18 @@ private:
                 monitorL = pitchL;
                 monitorR = pitchR;
             }
-            wasPitchShifting = true;
         }
         else
         {
             // No pitch shift - bypass vocoder
-            if (wasPitchShifting)
-            {
-                phaseVocoder.reset();
-                wasPitchShifting = false;
-            }
+            if (!isPitchShifting)
+                idlePitchShifter(1);
             monitorL = existingL;
             monitorR = existingR;
         }
 
         // Write position
-        int writePos = static_cast<int>(playHead) % loopLength;
+        int writePos = playHead.index() % loopLength;
 
         // Calculate overdub input gain (Blooper-style: fade at recording start/stop)
         float overdubGain = 1.0f;
@@ -2166,7 +2718,7 @@ private:
                 isOverdubFadingOut = false;
                 state.store(State::Playing);
                 waveformCacheDirty = true;  // Regenerate waveform with new overdub content
-                DBG("Overdub fade-out complete, now Playing");
+                logEvent(AudioLog::Event::OverdubFadeOutComplete);
             }
         }
         else if (overdubFadeInCounter < OVERDUB_FADE_SAMPLES)
@@ -2187,9 +2739,9 @@ private:
         const int writeXfadeLen = std::min(1024, effectiveLength / 4);
 
         // Calculate position relative to loop
-        float relWritePos = playHead - effectiveStart;
-        while (relWritePos < 0) relWritePos += effectiveLength;
-        while (relWritePos >= effectiveLength) relWritePos -= effectiveLength;
+        LoopPhase relWritePhase = playHead;
+        relWritePhase.wrap(effectiveStart, effectiveEnd);
+        float relWritePos = static_cast<float>(relWritePhase.index() - effectiveStart) + relWritePhase.fraction();
 
         // Distance from end of loop
         float distFromEnd = effectiveLength - relWritePos;
@@ -2221,12 +2773,10 @@ private:
 
         // Apply fade to existing buffer content, then add faded new input
         // This way existing content decays while new content is added with smooth fade
-        bufferL[writePos] = bufferL[writePos] * fadeMult + fadedInputL;
-        bufferR[writePos] = bufferR[writePos] * fadeMult + fadedInputR;
-
         // Soft clip to prevent runaway (gentler curve)
-        bufferL[writePos] = softClip(bufferL[writePos]);
-        bufferR[writePos] = softClip(bufferR[writePos]);
+        storage.setSample(0, writePos, softClip(storage.getSample(0, writePos) * fadeMult + fadedInputL));
+        storage.setSample(1, writePos, softClip(storage.getSample(1, writePos) * fadeMult + fadedInputR));
+        waveformPeaks.markWritten(writePos);
 
         // Output: pitch-shifted existing content + input for monitoring
         // Use faded input for monitoring too so user hears the fade
@@ -2261,60 +2811,121 @@ private:
         }
         // When applyPitch is false, processOverdubbing already consumed the smoothed value
 
-        if (reversed)
-        {
-            playHead -= effectiveRate;
-            // Wrap around for proper looping at any speed
-            while (playHead < effectiveStart)
-            {
-                playHead += effectiveLength;
-            }
-        }
-        else
-        {
-            playHead += effectiveRate;
-            // Wrap around for proper looping at any speed
-            while (playHead >= effectiveEnd)
-            {
-                playHead -= effectiveLength;
-            }
-        }
+        // Fixed-point advance: exact, and wraps in one step at any speed
+        const juce::int64 increment = LoopPhase::incrementForRate(effectiveRate);
+        playHead.advance(reversed ? -increment : increment, effectiveStart, effectiveEnd);
     }
 
     // Hermite (cubic) interpolation for smoother variable-speed playback
     // This significantly reduces crackling compared to linear interpolation
-    float readWithInterpolation(const std::vector<float>& buffer, float position) const
+    float readWithInterpolation(int channel, int index, float frac) const
     {
         if (loopLength <= 0)
             return 0.0f;
 
         // Get surrounding sample indices (need 4 points for cubic)
-        const int idx1 = static_cast<int>(position) % loopLength;
+        int idx1 = index % loopLength;
+        if (idx1 < 0) idx1 += loopLength;
         const int idx0 = (idx1 - 1 + loopLength) % loopLength;  // Previous sample
         const int idx2 = (idx1 + 1) % loopLength;
         const int idx3 = (idx1 + 2) % loopLength;
 
-        const float frac = position - std::floor(position);
-
         // Get samples
-        const float y0 = buffer[idx0];
-        const float y1 = buffer[idx1];
-        const float y2 = buffer[idx2];
-        const float y3 = buffer[idx3];
+        const float y0 = storage.getSample(channel, idx0);
+        const float y1 = storage.getSample(channel, idx1);
+        const float y2 = storage.getSample(channel, idx2);
+        const float y3 = storage.getSample(channel, idx3);
+
+        // Same expression as the block kernel, so both paths are bit-identical
+        return LoopReadKernel::hermite(y0, y1, y2, y3, frac);
+    }
+
+    float readWithInterpolation(int channel, float position) const
+    {
+        const float whole = std::floor(position);
+        return readWithInterpolation(channel, static_cast<int>(whole), position - whole);
+    }
+
+    // Block version of readWithCrossfade() for a block of playhead positions.
+    // Samples away from the loop seam and chunk edges take the fast path: taps are read
+    // straight from the chunk span (no modulo, no floor) and evaluated in one vectorised pass.
+    // Everything else falls back to the scalar read, so the output matches it exactly.
+    void readBlockWithCrossfade(const int* indices, const float* fracs, int numSamples, int effectiveStart, int effectiveEnd,
+                                float* outL, float* outR)
+    {
+        const int effectiveLength = effectiveEnd - effectiveStart;
+        if (loopLength <= 0 || effectiveLength <= 0)
+        {
+            std::fill(outL, outL + numSamples, 0.0f);
+            std::fill(outR, outR + numSamples, 0.0f);
+            return;
+        }
+
+        const int crossfadeLen = std::min(1024, effectiveLength / 4);
+        auto& scratch = readScratch;
+        int numSlow = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const int idx1 = indices[i];
+            const float frac = fracs[i];
+
+            // Same arithmetic as readWithCrossfade() to classify the crossfade zone
+            const int relIndex = idx1 - effectiveStart;
+            const bool inLoop = relIndex >= 0 && relIndex < effectiveLength;
+            const bool inCrossfade = inLoop && (static_cast<float>(effectiveLength - relIndex) - frac) < crossfadeLen && crossfadeLen > 0;
+
+            // Taps idx1-1 .. idx1+2 all inside the loop: % loopLength is a no-op
+            int span = 0;
+            const float* spanL = nullptr;
+            const float* spanR = nullptr;
+            bool fast = inLoop && !inCrossfade && idx1 >= 1 && idx1 + 2 < loopLength;
+            if (fast)
+            {
+                spanL = storage.getReadSpan(0, idx1 - 1, span);
+                spanR = storage.getReadSpan(1, idx1 - 1, span);
+                fast = span >= 4;
+            }
+
+            if (!fast)
+            {
+                // Seam, chunk edge or out-of-range position: exact scalar read
+                scratch.slowIndices[static_cast<size_t>(numSlow)] = i;
+                readWithCrossfade(scratch.slowL[static_cast<size_t>(numSlow)], scratch.slowR[static_cast<size_t>(numSlow)],
+                                  idx1, frac, effectiveStart, effectiveEnd);
+                ++numSlow;
+                for (int t = 0; t < 4; ++t)
+                {
+                    scratch.tapsL[t][static_cast<size_t>(i)] = 0.0f;
+                    scratch.tapsR[t][static_cast<size_t>(i)] = 0.0f;
+                }
+                scratch.fracs[static_cast<size_t>(i)] = 0.0f;
+                continue;
+            }
+
+            // Uncommitted chunks read as silence, same as LoopStorage::getSample()
+            for (int t = 0; t < 4; ++t)
+            {
+                scratch.tapsL[t][static_cast<size_t>(i)] = spanL != nullptr ? spanL[t] : 0.0f;
+                scratch.tapsR[t][static_cast<size_t>(i)] = spanR != nullptr ? spanR[t] : 0.0f;
+            }
+            scratch.fracs[static_cast<size_t>(i)] = frac;
+        }
 
-        // Hermite interpolation coefficients
-        const float c0 = y1;
-        const float c1 = 0.5f * (y2 - y0);
-        const float c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
-        const float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+        LoopReadKernel::evaluate(scratch, outL, outR, numSamples);
 
-        // Evaluate polynomial
-        return ((c3 * frac + c2) * frac + c1) * frac + c0;
+        for (int s = 0; s < numSlow; ++s)
+        {
+            const int i = scratch.slowIndices[static_cast<size_t>(s)];
+            outL[i] = scratch.slowL[static_cast<size_t>(s)];
+            outR[i] = scratch.slowR[static_cast<size_t>(s)];
+        }
     }
 
     // Real-time crossfade reading for seamless loop boundaries
     // When near the end of the loop, blend with the start region
-    void readWithCrossfade(float& outL, float& outR, float position, int effectiveStart, int effectiveEnd) const
+    // Position is given as integer index + fraction (see LoopPhase)
+    void readWithCrossfade(float& outL, float& outR, int index, float frac, int effectiveStart, int effectiveEnd) const
     {
         if (loopLength <= 0)
         {
@@ -2332,13 +2943,12 @@ private:
         // Crossfade region size (samples from end where crossfade begins)
         const int crossfadeLen = std::min(1024, effectiveLength / 4);
 
-        // Current position relative to loop start
-        float relPos = position - effectiveStart;
-        while (relPos < 0) relPos += effectiveLength;
-        while (relPos >= effectiveLength) relPos -= effectiveLength;
+        // Current position relative to loop start (integer part wrapped exactly)
+        int relIndex = (index - effectiveStart) % effectiveLength;
+        if (relIndex < 0) relIndex += effectiveLength;
 
         // Distance from end of loop
-        float distFromEnd = effectiveLength - relPos;
+        const float distFromEnd = static_cast<float>(effectiveLength - relIndex) - frac;
 
         if (distFromEnd < crossfadeLen && crossfadeLen > 0)
         {
@@ -2351,13 +2961,14 @@ private:
             float gainWrapped = std::sin(crossfadeProgress * juce::MathConstants<float>::halfPi);
 
             // Read from current position (near end)
-            float currentL = readWithInterpolation(bufferL, position);
-            float currentR = readWithInterpolation(bufferR, position);
+            float currentL = readWithInterpolation(0, index, frac);
+            float currentR = readWithInterpolation(1, index, frac);
 
-            // Read from wrapped position (near start)
-            float wrappedPos = effectiveStart + (crossfadeLen - distFromEnd);
-            float wrappedL = readWithInterpolation(bufferL, wrappedPos);
-            float wrappedR = readWithInterpolation(bufferR, wrappedPos);
+            // Read from wrapped position (near start): crossfadeLen - distFromEnd samples in,
+            // which keeps the same fraction
+            const int wrappedIndex = effectiveStart + crossfadeLen - effectiveLength + relIndex;
+            float wrappedL = readWithInterpolation(0, wrappedIndex, frac);
+            float wrappedR = readWithInterpolation(1, wrappedIndex, frac);
 
             // Blend
             outL = currentL * gainCurrent + wrappedL * gainWrapped;
@@ -2366,15 +2977,26 @@ private:
         else
         {
             // Normal reading outside crossfade region
-            outL = readWithInterpolation(bufferL, position);
-            outR = readWithInterpolation(bufferR, position);
+            outL = readWithInterpolation(0, index, frac);
+            outR = readWithInterpolation(1, index, frac);
         }
     }
 
+    void readWithCrossfade(float& outL, float& outR, LoopPhase position, int effectiveStart, int effectiveEnd) const
+    {
+        readWithCrossfade(outL, outR, position.index(), position.fraction(), effectiveStart, effectiveEnd);
+    }
+
+    void readWithCrossfade(float& outL, float& outR, float position, int effectiveStart, int effectiveEnd) const
+    {
+        const float whole = std::floor(position);
+        readWithCrossfade(outL, outR, static_cast<int>(whole), position - whole, effectiveStart, effectiveEnd);
+    }
+
     // Simple pitch shift: just read at a different rate
     // For now, let's try the simplest possible approach
     // and see if we get ANY pitch change at all
-    float readWithPitchShift(const std::vector<float>& buffer, float pitchRatio)
+    float readWithPitchShift(int channel, float pitchRatio)
     {
         if (loopLength <= 0)
             return 0.0f;
@@ -2387,12 +3009,8 @@ private:
             return 0.0f;
 
         // Debug: log pitch ratio periodically
-        static int debugCounter = 0;
-        if (++debugCounter % 48000 == 0) {
-            DBG("readWithPitchShift: pitchRatio=" + juce::String(pitchRatio, 4) +
-                " pitchReadPos1=" + juce::String(pitchReadPos1, 1) +
-                " playHead=" + juce::String(playHead, 1) +
-                " grainPhase=" + juce::String(grainPhase, 3));
+        if (++pitchLogCounter % 48000 == 0) {
+            logEvent(AudioLog::Event::PitchGrainState, pitchRatio, pitchReadPos1, playHead.toSamples(), grainPhase);
         }
 
         // Wrap helper for positions within loop bounds
@@ -2414,8 +3032,8 @@ private:
         float pos1 = wrapPos(pitchReadPos1);
         float pos2 = wrapPos(pitchReadPos2);
 
-        const float sample1 = readWithInterpolation(buffer, pos1);
-        const float sample2 = readWithInterpolation(buffer, pos2);
+        const float sample1 = readWithInterpolation(channel, pos1);
+        const float sample2 = readWithInterpolation(channel, pos2);
 
         // Advance both read positions at pitchRatio speed
         pitchReadPos1 += pitchRatio;
@@ -2433,7 +3051,7 @@ private:
         if (grainPhase >= 1.0f)
         {
             grainPhase -= 1.0f;
-            pitchReadPos1 = playHead;
+            pitchReadPos1 = static_cast<float>(playHead.toSamples());
         }
 
         // When tap 2's window completes
@@ -2441,7 +3059,7 @@ private:
         float newPhase2 = std::fmod(grainPhase + 0.5f, 1.0f);
         if (newPhase2 < prevPhase2)
         {
-            pitchReadPos2 = playHead;
+            pitchReadPos2 = static_cast<float>(playHead.toSamples());
         }
 
         return sample1 * window1 + sample2 * window2;
@@ -2463,12 +3081,11 @@ private:
                 int oldLength = loopLength;
                 loopLength = adjusted + 1;
                 loopEnd = loopLength;
-                DBG("applyCrossfade() - adjusted loop length from " + juce::String(oldLength) +
-                    " to " + juce::String(loopLength) + " for zero crossing");
+                logEvent(AudioLog::Event::CrossfadeLengthAdjusted, oldLength, loopLength);
             }
             else
             {
-                DBG("applyCrossfade() - using real-time crossfade, no length adjustment needed");
+                logEvent(AudioLog::Event::CrossfadeRealtime);
             }
         }
     }
@@ -2491,8 +3108,8 @@ private:
             int pos = position + offset;
             if (pos < loopLength - 1)
             {
-                float curr = (bufferL[pos] + bufferR[pos]) * 0.5f;
-                float next = (bufferL[pos + 1] + bufferR[pos + 1]) * 0.5f;
+                float curr = (storage.getSample(0, pos) + storage.getSample(1, pos)) * 0.5f;
+                float next = (storage.getSample(0, pos + 1) + storage.getSample(1, pos + 1)) * 0.5f;
 
                 // Zero crossing: signs differ or one is exactly zero
                 if ((curr >= 0.0f && next < 0.0f) || (curr < 0.0f && next >= 0.0f) ||
@@ -2513,8 +3130,8 @@ private:
                 int posBack = position - offset;
                 if (posBack >= 0 && posBack < loopLength - 1)
                 {
-                    float curr = (bufferL[posBack] + bufferR[posBack]) * 0.5f;
-                    float next = (bufferL[posBack + 1] + bufferR[posBack + 1]) * 0.5f;
+                    float curr = (storage.getSample(0, posBack) + storage.getSample(1, posBack)) * 0.5f;
+                    float next = (storage.getSample(0, posBack + 1) + storage.getSample(1, posBack + 1)) * 0.5f;
 
                     if ((curr >= 0.0f && next < 0.0f) || (curr < 0.0f && next >= 0.0f) ||
                         std::abs(curr) < 0.001f)
@@ -2538,28 +3155,72 @@ private:
         if (loopLength <= 0)
             return;
 
-        // Calculate mean (DC offset) for each channel
-        double sumL = 0.0, sumR = 0.0;
-        for (int i = 0; i < loopLength; ++i)
+        // Calculate mean (DC offset) for each channel. Uncommitted chunks are silence:
+        // they count towards the length but are never read or written.
+        double sum[2] = { 0.0, 0.0 };
+        for (int ch = 0; ch < 2; ++ch)
         {
-            sumL += bufferL[i];
-            sumR += bufferR[i];
+            for (int start = 0; start < loopLength;)
+            {
+                int span = 0;
+                const float* data = storage.getReadSpan(ch, start, span);
+                span = std::min(span, loopLength - start);
+                if (data != nullptr)
+                    for (int i = 0; i < span; ++i)
+                        sum[ch] += data[i];
+                start += span;
+            }
         }
-        const float dcL = static_cast<float>(sumL / loopLength);
-        const float dcR = static_cast<float>(sumR / loopLength);
+        const float dc[2] = { static_cast<float>(sum[0] / loopLength), static_cast<float>(sum[1] / loopLength) };
 
         // Only remove if there's significant DC offset (> 0.001)
-        if (std::abs(dcL) > 0.001f || std::abs(dcR) > 0.001f)
+        if (std::abs(dc[0]) > 0.001f || std::abs(dc[1]) > 0.001f)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                const float offset = dc[ch];
+                rewriteCommittedSpans(ch, [](const float*, int) { return true; },
+                                      [offset](float* data, int n)
+                                      {
+                                          for (int i = 0; i < n; ++i)
+                                              data[i] -= offset;
+                                      });
+            }
+            waveformPeaks.rebuild(loopLength);
+            invalidatePlaybackCache();
+            logEvent(AudioLog::Event::DCOffsetRemoved, dc[0], dc[1]);
+        }
+    }
+
+    // Rewrite [0, loopLength) of one channel in place, chunk span by chunk span. Spans in
+    // uncommitted chunks (silence) are skipped without committing them; a written span is
+    // only made writable (copying it if shared) when needsRewrite(data, n) says so.
+    template <typename NeedsRewrite, typename Rewrite>
+    void rewriteCommittedSpans(int channel, NeedsRewrite&& needsRewrite, Rewrite&& rewrite)
+    {
+        for (int start = 0; start < loopLength;)
         {
-            for (int i = 0; i < loopLength; ++i)
+            int span = 0;
+            const float* data = storage.getReadSpan(channel, start, span);
+            span = std::min(span, loopLength - start);
+            if (data != nullptr && needsRewrite(data, span))
             {
-                bufferL[i] -= dcL;
-                bufferR[i] -= dcR;
+                int writeSpan = 0;
+                if (float* dest = storage.getWriteSpan(channel, start, writeSpan))
+                    rewrite(dest, span);
             }
-            DBG("Removed DC offset: L=" + juce::String(dcL, 4) + " R=" + juce::String(dcR, 4));
+            start += span;
         }
     }
 
+    // Both channels
+    template <typename NeedsRewrite, typename Rewrite>
+    void rewriteCommittedSpans(NeedsRewrite&& needsRewrite, Rewrite&& rewrite)
+    {
+        for (int ch = 0; ch < 2; ++ch)
+            rewriteCommittedSpans(ch, needsRewrite, rewrite);
+    }
+
     static float softClip(float x)
     {
         // Soft saturation to prevent harsh clipping
@@ -2571,6 +3232,401 @@ private:
     }
 
     // Detect if the playhead wrapped around (crossed loop boundary)
+    // Per-loop fade at a wrap: decay towards fadeTarget (or recover up to it).
+    // Returns the multiplier to apply; the stored one is floored at 0.001.
+    float applyWrapFade(float fadeTarget)
+    {
+        float invFade = 1.0f - fadeTarget;
+        float decayStrength = invFade * invFade;
+        float decayMultiplier = 1.0f - (decayStrength * 0.25f);
+        float targetMultiplier = fadeTarget;
+        float fadeMult = currentFadeMultiplier.load();
+
+        if (fadeMult < targetMultiplier)
+        {
+            float recoveryRate = 0.15f;
+            fadeMult += (targetMultiplier - fadeMult) * recoveryRate;
+        }
+        else
+        {
+            fadeMult *= decayMultiplier;
+        }
+
+        currentFadeMultiplier.store(std::max(fadeMult, 0.001f));
+        return fadeMult;
+    }
+
+    // Shifter for a pitched block or sample, leased from the pool on first use. nullptr when
+    // the pool has none free yet - the caller stays dry and tries again next time.
+    PitchShifterPool::Shifter* acquirePitchShifter()
+    {
+        if (pitchShifter == nullptr)
+        {
+            if (shifterPool == nullptr)
+                return nullptr;
+
+            // Prefer the layer's quality; until one is prepared play the other and switch later
+            const bool highQuality = layerPitchHQ.load();
+            if ((pitchShifter = shifterPool->lease(highQuality)) == nullptr
+                && (pitchShifter = shifterPool->lease(!highQuality)) == nullptr)
+                return nullptr;
+
+            // Leased shifters come back reset; loop playback feeds look-ahead
+            pitchShifter->block.setLookAheadFeed(true);
+            pitchShifterNeedsPreroll = true;
+        }
+        else if (pitchShifterIdleSamples > 0)
+        {
+            // Off unity again within the tail-out - drop the stale state, as a fresh lease would
+            pitchShifter->reset();
+            pitchShifterNeedsPreroll = true;
+        }
+
+        pitchShifterIdleSamples = 0;
+        return pitchShifter;
+    }
+
+    // The layer is at unity pitch: after PITCH_SHIFTER_TAIL_SECONDS there the shifter goes
+    // back to the pool, so a knob swept through 0 doesn't lease and return it repeatedly
+    void idlePitchShifter(int numSamples)
+    {
+        if (pitchShifter == nullptr)
+            return;
+
+        pitchShifterIdleSamples += numSamples;
+        if (pitchShifterIdleSamples >= pitchShifterTailSamples)
+            releasePitchShifter();
+    }
+
+    // Restart a look-ahead feed: reset the shifter and place the feed phase lookAhead samples
+    // (at the current rate) past the playhead. Nothing is fed here - the shifter primes from
+    // the following blocks' normal feed, and its output only counts once feed.isPrimed().
+    void restartFeed(ShifterFeed& feed, StereoBlockPitchShifter& blockPitchShifter, float pitchRatio,
+                     bool reversed, int effectiveStart, int effectiveEnd)
+    {
+        blockPitchShifter.reset();
+        blockPitchShifter.setPitchRatio(pitchRatio);
+
+        const int lookAhead = blockPitchShifter.getLookAheadSamples();
+        const juce::int64 offset = static_cast<juce::int64>(lookAhead)
+                                 * LoopPhase::incrementForRate(playbackRateSmoothed.getCurrentValue());
+
+        feed.phase = playHead;
+        feed.phase.advance(reversed ? -offset : offset, effectiveStart, effectiveEnd);
+        feed.lpfL = feed.lpfR = 0.0f;
+        feed.fed = 0;
+        feed.primeTarget = lookAhead + PITCH_PRIME_MARGIN;
+        feed.needsRestart = false;
+        feed.reversed = reversed;
+        feed.start = effectiveStart;
+        feed.end = effectiveEnd;
+    }
+
+    // Shifter output (pitchOutput) after a restart: nothing of it before firstPrimed, then a
+    // fade in over primeFadeSamples. The dry read (pitchInput) never stands in for it - it
+    // only fades out what was playing before the restart (pitchDryTail), so an unprimed
+    // layer is silent. pitchedGain < 1 is the near-unity crossfade with the dry read.
+    void mixPrimedPitched(int numSamples, int firstPrimed, float pitchedGain)
+    {
+        if (firstPrimed == 0 && pitchWetBlend >= 1.0f && pitchDryTail <= 0.0f && pitchedGain >= 1.0f)
+            return;  // Fully pitched
+
+        const float step = 1.0f / static_cast<float>(std::max(primeFadeSamples, 1));
+        float wet = pitchWetBlend;
+        float tail = pitchDryTail;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            if (i >= firstPrimed)
+                wet = std::min(wet + step, 1.0f);
+            tail = std::max(tail - step, 0.0f);
+
+            const float pitchedMix = wet * pitchedGain;
+            const float dryMix = (1.0f - pitchedGain) + tail * pitchedGain;
+            pitchOutputL[i] *= pitchedMix;
+            pitchOutputR[i] *= pitchedMix;
+            if (dryMix > 0.0f)
+            {
+                pitchOutputL[i] += pitchInputL[i] * dryMix;
+                pitchOutputR[i] += pitchInputR[i] * dryMix;
+            }
+        }
+        pitchWetBlend = wet;
+        pitchDryTail = tail;
+    }
+
+    // HQ toggle: make sure a shifter of the wanted quality is running alongside the current
+    // one. It is leased (prepared by the pool's thread - nothing is allocated here) and
+    // restarts its own feed at the playhead; the crossfade waits until it has primed.
+    // Returns the incoming shifter while a switch is under way, else nullptr.
+    PitchShifterPool::Shifter* updatePitchQualitySwitch(float pitchRatio, bool reversed, int effectiveStart, int effectiveEnd)
+    {
+        if (incomingShifter == nullptr)
+        {
+            const bool highQuality = layerPitchHQ.load();
+            if (pitchShifter->isHighQuality() == highQuality
+                || (incomingShifter = shifterPool->lease(highQuality)) == nullptr)
+                return nullptr;  // Nothing to do, or not prepared yet - try again next block
+
+            incomingShifter->block.setLookAheadFeed(true);
+            switchFeed.needsRestart = true;
+        }
+
+        if (!switchFeed.matches(reversed, effectiveStart, effectiveEnd))
+        {
+            restartFeed(switchFeed, incomingShifter->block, pitchRatio, reversed, effectiveStart, effectiveEnd);
+            qualitySwitchBlend = 0.0f;
+        }
+        return incomingShifter;
+    }
+
+    // Crossfade pitchOutput (current shifter) towards switchOutput (incoming shifter). Both
+    // are aligned to the playhead, so an equal-gain ramp is enough; it only starts at the
+    // incoming shifter's first primed sample. Once it completes the incoming shifter takes
+    // over; if HQ is toggled back mid-fade the ramp reverses and the incoming one goes back
+    // to the pool.
+    void mixPitchQualitySwitch(int numSamples, int firstPrimed)
+    {
+        const float target = incomingShifter->isHighQuality() == layerPitchHQ.load() ? 1.0f : 0.0f;
+        const float step = 1.0f / static_cast<float>(std::max(qualityFadeSamples, 1));
+        float blend = qualitySwitchBlend;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            if (target > blend)
+            {
+                if (i >= firstPrimed)
+                    blend = std::min(blend + step, target);
+            }
+            else
+            {
+                blend = std::max(blend - step, target);
+            }
+            pitchOutputL[i] += (switchOutputL[i] - pitchOutputL[i]) * blend;
+            pitchOutputR[i] += (switchOutputR[i] - pitchOutputR[i]) * blend;
+        }
+        qualitySwitchBlend = blend;
+
+        if (blend >= 1.0f)
+        {
+            shifterPool->release(pitchShifter);
+            pitchShifter = incomingShifter;
+            incomingShifter = nullptr;
+            mainFeed = switchFeed;
+            switchFeed.needsRestart = true;
+            qualitySwitchBlend = 0.0f;
+        }
+        else if (blend <= 0.0f && target == 0.0f)
+        {
+            releaseIncomingShifter();
+        }
+    }
+
+    void releaseIncomingShifter()
+    {
+        if (incomingShifter != nullptr)
+        {
+            shifterPool->release(incomingShifter);
+            incomingShifter = nullptr;
+        }
+        switchFeed.needsRestart = true;
+        qualitySwitchBlend = 0.0f;
+    }
+
+    // Fade and anti-aliasing filter for one block read (sequential one-pole, stays scalar).
+    // Gains and rates come from the playhead walk; the filter state is per read stream.
+    void applyFadeAndAntiAlias(float* left, float* right, int numSamples, float& lpfL, float& lpfR)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float rawL = left[i] * blockFadeGains[i];
+            float rawR = right[i] * blockFadeGains[i];
+
+            // Apply anti-aliasing low-pass filter when playing at high speeds
+            // This prevents aliasing artifacts that cause crackling
+            const float currentRate = blockRates[i];
+            if (currentRate > 1.01f)
+            {
+                // One-pole low-pass filter with cutoff tracking the speed
+                // Higher speed = lower cutoff to prevent aliasing
+                // Coefficient: 0.5 at 2x speed, 0.25 at 4x speed, etc.
+                const float lpfCoeff = std::min(0.9f, 1.0f / currentRate);
+                lpfL = lpfCoeff * rawL + (1.0f - lpfCoeff) * lpfL;
+                lpfR = lpfCoeff * rawR + (1.0f - lpfCoeff) * lpfR;
+                rawL = lpfL;
+                rawR = lpfR;
+            }
+
+            left[i] = rawL;
+            right[i] = rawR;
+        }
+    }
+
+    // Playback cache key for this block's settings. Pitch inside the shifter's dead band
+    // counts as unity, as it does for the live path.
+    PlaybackCacheKey makePlaybackCacheKey(float pitchRatio, int effectiveStart, int effectiveEnd) const
+    {
+        PlaybackCacheKey key;
+        key.pitchRatio = std::abs(pitchRatio - 1.0f) >= 0.002f ? pitchRatio : 1.0f;
+        key.eqLow = eqLowGain.load();
+        key.eqMid = eqMidGain.load();
+        key.eqHigh = eqHighGain.load();
+        key.reversed = isReversed.load();
+        key.highQuality = key.pitchRatio != 1.0f && layerPitchHQ.load();
+        key.effectiveStart = effectiveStart;
+        key.effectiveEnd = effectiveEnd;
+        key.loopLength = loopLength;
+        key.contentVersion = contentVersion;
+        return key;
+    }
+
+    static bool keyNeedsEQ(const PlaybackCacheKey& key)
+    {
+        return std::abs(key.eqLow - 1.0f) > 0.01f || std::abs(key.eqMid - 1.0f) > 0.01f
+            || std::abs(key.eqHigh - 1.0f) > 0.01f;
+    }
+
+    // Worth caching: there is DSP to skip. Pitch within 1% of unity is left live - the live
+    // path crossfades dry and shifted audio there.
+    static bool isCacheableKey(const PlaybackCacheKey& key)
+    {
+        const float pitchDistance = std::abs(key.pitchRatio - 1.0f);
+        if (pitchDistance > 0.0f && pitchDistance < 0.01f)
+            return false;
+        return (pitchDistance > 0.0f || keyNeedsEQ(key)) && key.effectiveEnd - key.effectiveStart > 0;
+    }
+
+    // Time how long the settings have held still (the render waits for PLAYBACK_CACHE_SETTLE_SECONDS)
+    void trackPlaybackCacheKey(const PlaybackCacheKey& key, int numSamples)
+    {
+        if (key == trackedCacheKey)
+        {
+            playbackCacheStableSamples = std::min(playbackCacheStableSamples + numSamples, playbackCacheSettleSamples);
+            return;
+        }
+
+        trackedCacheKey = key;
+        playbackCacheStableSamples = 0;
+    }
+
+    // The layer's audio changed: drop the cache immediately (it no longer matches anything)
+    void invalidatePlaybackCache()
+    {
+        ++contentVersion;
+        playbackCacheValid = false;
+        playbackCacheBlend = 0.0f;
+        hasFailedCacheKey = false;
+        playbackCache.release();
+    }
+
+    // Read the cache at a block of playhead positions, fade applied. The cache was rendered at
+    // whole-sample positions: on that grid, at unity rate forward playback, each chunk is read
+    // as one run. A playhead left off the grid (a rate ramp back to 1.0 keeps its fraction)
+    // is read at its true phase - Hermite over the four surrounding cache samples, wrapping
+    // within the cached region - so switching between live and cache doesn't shift playback.
+    void readPlaybackCache(const int* indices, const float* fracs, int numSamples, float* outL, float* outR) const
+    {
+        const int regionStart = playbackCacheKey.effectiveStart;
+        const int regionLength = playbackCacheKey.effectiveEnd - regionStart;
+        auto wrapToRegion = [regionStart, regionLength](int index)
+        {
+            int rel = (index - regionStart) % regionLength;
+            if (rel < 0)
+                rel += regionLength;
+            return regionStart + rel;
+        };
+
+        for (int i = 0; i < numSamples;)
+        {
+            if (fracs[i] != 0.0f && regionLength > 0)
+            {
+                const float gain = blockFadeGains[static_cast<size_t>(i)];
+                const int i1 = wrapToRegion(indices[i]);
+                const int i0 = wrapToRegion(i1 - 1);
+                const int i2 = wrapToRegion(i1 + 1);
+                const int i3 = wrapToRegion(i1 + 2);
+                outL[i] = LoopReadKernel::hermite(playbackCache.getSample(0, i0), playbackCache.getSample(0, i1),
+                                                  playbackCache.getSample(0, i2), playbackCache.getSample(0, i3),
+                                                  fracs[i]) * gain;
+                outR[i] = LoopReadKernel::hermite(playbackCache.getSample(1, i0), playbackCache.getSample(1, i1),
+                                                  playbackCache.getSample(1, i2), playbackCache.getSample(1, i3),
+                                                  fracs[i]) * gain;
+                ++i;
+                continue;
+            }
+
+            const int index = std::clamp(indices[i], 0, loopLength - 1);
+            int span = 0;
+            const float* spanL = playbackCache.getReadSpan(0, index, span);
+            const float* spanR = playbackCache.getReadSpan(1, index, span);
+
+            int run = 1;
+            while (run < span && i + run < numSamples && indices[i + run] == index + run && fracs[i + run] == 0.0f)
+                ++run;
+
+            for (int k = 0; k < run; ++k)
+            {
+                const float gain = blockFadeGains[static_cast<size_t>(i + k)];
+                outL[i + k] = spanL != nullptr ? spanL[k] * gain : 0.0f;
+                outR[i + k] = spanR != nullptr ? spanR[k] * gain : 0.0f;
+            }
+            i += run;
+        }
+    }
+
+    // Blend the cache into the live output (pitchOutput), ramping towards the cache while it
+    // is usable and back to live when it isn't - once the live shifter has primed (liveReady).
+    // With the live path suspended the cache is read straight into pitchOutput.
+    void mixPlaybackCache(int numSamples, bool cacheUsable, bool liveRendered, bool liveReady)
+    {
+        if (!liveRendered)
+        {
+            readPlaybackCache(blockReadIndices.data(), blockReadFracs.data(), numSamples, pitchOutputL.data(), pitchOutputR.data());
+            return;
+        }
+
+        readPlaybackCache(blockReadIndices.data(), blockReadFracs.data(), numSamples, cacheReadL.data(), cacheReadR.data());
+
+        // Not usable any more but the live path is still priming: hold the cache where it is
+        const float target = cacheUsable ? 1.0f : (liveReady ? 0.0f : playbackCacheBlend);
+        const float step = 1.0f / static_cast<float>(std::max(playbackCacheFadeSamples, 1));
+        float blend = playbackCacheBlend;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            blend = target > blend ? std::min(blend + step, target) : std::max(blend - step, target);
+            pitchOutputL[i] += (cacheReadL[i] - pitchOutputL[i]) * blend;
+            pitchOutputR[i] += (cacheReadR[i] - pitchOutputR[i]) * blend;
+        }
+        playbackCacheBlend = blend;
+    }
+
+    // Whole-sample version of readWithCrossfade() over any source (render snapshot), with the
+    // same loop-boundary crossfade. Hermite at fraction 0 is the sample itself.
+    template <typename Source>
+    static void readCacheFrame(const Source& source, int loopLength, int index, int effectiveStart, int effectiveEnd,
+                               float& outL, float& outR)
+    {
+        const int effectiveLength = effectiveEnd - effectiveStart;
+        const int crossfadeLen = std::min(1024, effectiveLength / 4);
+        const int relIndex = index - effectiveStart;
+        const int distFromEnd = effectiveLength - relIndex;
+
+        outL = source.getSample(0, index);
+        outR = source.getSample(1, index);
+
+        if (distFromEnd < crossfadeLen && crossfadeLen > 0)
+        {
+            const float crossfadeProgress = 1.0f - (static_cast<float>(distFromEnd) / static_cast<float>(crossfadeLen));
+            const float gainCurrent = std::cos(crossfadeProgress * juce::MathConstants<float>::halfPi);
+            const float gainWrapped = std::sin(crossfadeProgress * juce::MathConstants<float>::halfPi);
+
+            int wrappedIndex = (effectiveStart + crossfadeLen - effectiveLength + relIndex) % loopLength;
+            if (wrappedIndex < 0)
+                wrappedIndex += loopLength;
+
+            outL = outL * gainCurrent + source.getSample(0, wrappedIndex) * gainWrapped;
+            outR = outR * gainCurrent + source.getSample(1, wrappedIndex) * gainWrapped;
+        }
+    }
+
     bool detectLoopWrap(float prevPos, float currentPos)
     {
         // Forward playback: detect when position jumps from high to low
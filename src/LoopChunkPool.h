@@ -0,0 +1,466 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "LoopMemoryManager.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * LoopChunkPool - Per-engine pool of fixed-size stereo audio chunks
+ *
+ * Layer audio is stored in CHUNK_FRAMES-sized chunks that are only committed
+ * when recording reaches them, so an engine holding one 4-bar loop costs a few MB
+ * instead of 8 x 60 seconds of preallocated, zero-filled buffers.
+ *
+ * A low-priority background thread keeps a small stock of zeroed spare chunks so
+ * the audio thread never touches the allocator. Chunks handed back by layers are
+ * zeroed on that thread and either restocked or freed.
+ *
+ * The free lists are lock-free: spares and clean tables sit in bounded MPMC queues,
+ * released chunks and tables are pushed onto intrusive stacks the maintenance thread
+ * takes whole. Nothing the audio thread calls can wait on the maintenance thread, so
+ * a low-priority thread holding a lock can't stall a block.
+ *
+ * Each layer addresses its chunks through a ChunkTable borrowed from the pool.
+ * Clearing a layer hands the whole table back in O(1) and takes a clean one; the
+ * maintenance thread releases the table's chunks later, so no clear ever walks or
+ * zeroes audio on the calling thread.
+ *
+ * Chunks are reference counted so layers can share audio copy-on-write: a layer
+ * duplicated from another references the same chunks until one of them writes.
+ *
+ * Threads that read layer audio without owning it (the message thread's zoomed-in
+ * waveform scan) hold a ReadPin while they do. Released chunks are only zeroed, restocked
+ * or freed once the maintenance thread has seen no pin held after they were retired.
+ * Storages drop a chunk from their table before releasing it, so a reader pinned later
+ * can't find it.
+ *
+ * Every chunk (including spares) is leased from the process-wide LoopMemoryManager.
+ * When the budget is exhausted acquire() returns nullptr and the caller must
+ * degrade gracefully (recording closes its loop early, overdub writes are dropped).
+ */
+class LoopChunkPool : private juce::Thread
+{
+public:
+    static constexpr int CHUNK_SHIFT = 16;
+    static constexpr int CHUNK_FRAMES = 1 << CHUNK_SHIFT;  // 65536 frames (~1.4s at 48kHz)
+    static constexpr int CHUNK_MASK = CHUNK_FRAMES - 1;
+    static constexpr int SPARE_CHUNKS = 4;                 // Zeroed chunks kept ready for the audio thread
+    static constexpr int TABLES_PER_LAYER = 3;             // Active + headroom for back-to-back clears
+
+    struct Chunk
+    {
+        std::array<float, CHUNK_FRAMES> left {};
+        std::array<float, CHUNK_FRAMES> right {};
+        std::atomic<int> refCount { 1 };  // Number of chunk-table slots referencing this chunk
+        Chunk* nextRetired = nullptr;     // Link in the pool's retired stack
+
+        float* getChannel(int channel) { return channel == 0 ? left.data() : right.data(); }
+        const float* getChannel(int channel) const { return channel == 0 ? left.data() : right.data(); }
+    };
+
+    static constexpr size_t CHUNK_BYTES = sizeof(Chunk);
+
+    // One slot per CHUNK_FRAMES of a layer; nullptr = never written (reads as silence)
+    struct ChunkTable
+    {
+        std::vector<Chunk*> slots;
+        ChunkTable* nextRetired = nullptr;  // Link in the pool's retired stack
+    };
+
+    LoopChunkPool() : juce::Thread("LoopChunkPool")
+    {
+        memoryManager->registerClient(&memoryClient);
+        spareChunks.resize(SPARE_CHUNKS);
+    }
+
+    ~LoopChunkPool() override
+    {
+        stopThread(2000);
+        recycleRetiredTables();
+        freeAllChunks();
+        memoryManager->unregisterClient(&memoryClient);
+    }
+
+    // Number of chunks needed to hold numSamples frames
+    static int chunksForSamples(int numSamples)
+    {
+        return (numSamples + CHUNK_FRAMES - 1) >> CHUNK_SHIFT;
+    }
+
+    // Build the chunk tables, size the free lists for the worst case and start the
+    // maintenance thread. Must be called before the audio thread starts (from prepareToPlay),
+    // after every layer has handed its table back.
+    void prepare(int numLayers, int chunksPerLayer)
+    {
+        stopThread(2000);
+        recycleRetiredTables();
+
+        const int maxChunksInUse = numLayers * chunksPerLayer;
+        const int numTables = numLayers * TABLES_PER_LAYER;
+
+        // No other thread touches the lists until startThread() below
+        jassert(cleanTables.size() == allTables.size());
+
+        allTables.clear();
+        cleanTables.resize(numTables);
+        for (int i = 0; i < numTables; ++i)
+        {
+            auto table = std::make_unique<ChunkTable>();
+            table->slots.assign(static_cast<size_t>(chunksPerLayer), nullptr);
+            cleanTables.push(table.get());
+            allTables.push_back(std::move(table));
+        }
+        recycleScratch.reserve(static_cast<size_t>(maxChunksInUse + SPARE_CHUNKS));
+
+        topUpSpares();
+        startThread(juce::Thread::Priority::low);
+    }
+
+    // Take a zeroed chunk from the spare stock. Lock-free and never allocates, so it is
+    // safe on the audio thread. Returns nullptr when the stock is empty: either the global
+    // memory budget is exhausted, or writes outran the maintenance thread (counted as a miss).
+    Chunk* acquire()
+    {
+        if (Chunk* chunk = spareChunks.pop())
+            return chunk;
+
+        acquireMisses.fetch_add(1);
+        if (memoryManager->getBudgetBytes() - memoryManager->getTotalBytesInUse()
+                < static_cast<juce::int64>(CHUNK_BYTES))
+            budgetExhausted.store(true);
+        return nullptr;
+    }
+
+    // Take a zeroed chunk for a background writer (render workers). Never touches the spare
+    // stock the audio thread depends on - it allocates on the calling thread instead.
+    // Returns nullptr when the budget is exhausted, or when taking the chunk would leave
+    // less than headroomChunks of budget free for recording. Doesn't set budgetExhausted:
+    // the background writer reports its own failure.
+    Chunk* acquireBackground(int headroomChunks = 0)
+    {
+        const juce::int64 needed = static_cast<juce::int64>(CHUNK_BYTES) * (headroomChunks + 1);
+        if (memoryManager->getBudgetBytes() - memoryManager->getTotalBytesInUse() < needed)
+            return nullptr;
+
+        return allocateChunk();
+    }
+
+    // Keeps every chunk a reader can still reach alive (not zeroed, not freed) while held.
+    // Wait-free for the reader; the maintenance thread just defers recycling.
+    class ReadPin
+    {
+    public:
+        explicit ReadPin(const LoopChunkPool* chunkPool) : pool(chunkPool)
+        {
+            if (pool != nullptr)
+                pool->activeReaders.fetch_add(1);
+        }
+
+        ~ReadPin()
+        {
+            if (pool != nullptr)
+                pool->activeReaders.fetch_sub(1);
+        }
+
+    private:
+        const LoopChunkPool* pool;
+
+        JUCE_DECLARE_NON_COPYABLE(ReadPin)
+    };
+
+    // Add a reference for another table slot sharing this chunk
+    static void retain(Chunk* chunk)
+    {
+        if (chunk != nullptr)
+            chunk->refCount.fetch_add(1);
+    }
+
+    static bool isShared(const Chunk* chunk)
+    {
+        return chunk != nullptr && chunk->refCount.load() > 1;
+    }
+
+    // Drop a reference. The last one hands the chunk back (lock-free); it is zeroed off
+    // the calling thread before being reused.
+    void release(Chunk* chunk)
+    {
+        if (chunk == nullptr || chunk->refCount.fetch_sub(1) != 1)
+            return;
+
+        retiredChunks.push(chunk);
+    }
+
+    // Take an empty chunk table, or nullptr if every table is still waiting to be recycled
+    ChunkTable* acquireTable()
+    {
+        return cleanTables.pop();
+    }
+
+    // Hand a table back in O(1). Its chunks are released by the maintenance thread.
+    void releaseTable(ChunkTable* table)
+    {
+        if (table != nullptr)
+            retiredTables.push(table);
+    }
+
+    // Memory currently held by this pool (committed layer chunks + spares)
+    size_t getBytesAllocated() const { return static_cast<size_t>(memoryClient.bytesInUse.load()); }
+    int getNumChunksAllocated() const { return chunksAllocated.load(); }
+
+    // How often acquire() found the spare stock empty
+    int getAcquireMissCount() const { return acquireMisses.load(); }
+
+    // Set when a chunk request was refused by the global budget (cleared by the engine)
+    bool isBudgetExhausted() const { return budgetExhausted.load(); }
+    void clearBudgetExhausted() { budgetExhausted.store(false); }
+
+    LoopMemoryManager& getMemoryManager() { return *memoryManager; }
+
+private:
+    // Bounded lock-free MPMC queue of pointers (Vyukov). A thread preempted mid-operation
+    // only makes its cell look empty (or full) to the others - nobody waits on it.
+    // resize() drops the contents and must not race push()/pop().
+    template <typename T>
+    class FreeQueue
+    {
+    public:
+        void resize(int minCapacity)
+        {
+            const size_t capacity = static_cast<size_t>(juce::nextPowerOfTwo(juce::jmax(2, minCapacity)));
+            cells = std::make_unique<Cell[]>(capacity);
+            for (size_t i = 0; i < capacity; ++i)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            mask = capacity - 1;
+            enqueuePos.store(0);
+            dequeuePos.store(0);
+        }
+
+        // false when full
+        bool push(T* item)
+        {
+            size_t pos = enqueuePos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Cell& cell = cells[pos & mask];
+                const auto diff = static_cast<std::ptrdiff_t>(cell.sequence.load(std::memory_order_acquire))
+                                - static_cast<std::ptrdiff_t>(pos);
+                if (diff == 0)
+                {
+                    if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        cell.item = item;
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // nullptr when empty
+        T* pop()
+        {
+            if (cells == nullptr)
+                return nullptr;
+
+            size_t pos = dequeuePos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Cell& cell = cells[pos & mask];
+                const auto diff = static_cast<std::ptrdiff_t>(cell.sequence.load(std::memory_order_acquire))
+                                - static_cast<std::ptrdiff_t>(pos + 1);
+                if (diff == 0)
+                {
+                    if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        T* item = cell.item;
+                        cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                        return item;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return nullptr;
+                }
+                else
+                {
+                    pos = dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Approximate while other threads push/pop
+        size_t size() const
+        {
+            const size_t head = dequeuePos.load(std::memory_order_relaxed);
+            const size_t tail = enqueuePos.load(std::memory_order_relaxed);
+            return tail > head ? tail - head : 0;
+        }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence { 0 };
+            T* item = nullptr;
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        size_t mask = 0;
+        std::atomic<size_t> enqueuePos { 0 };
+        std::atomic<size_t> dequeuePos { 0 };
+    };
+
+    // Lock-free intrusive stack (through T::nextRetired): any thread pushes, the maintenance
+    // thread takes the whole list at once, so there is no ABA-prone single pop
+    template <typename T>
+    class RetiredStack
+    {
+    public:
+        void push(T* item)
+        {
+            T* top = head.load(std::memory_order_relaxed);
+            do
+            {
+                item->nextRetired = top;
+            } while (!head.compare_exchange_weak(top, item, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        T* takeAll() { return head.exchange(nullptr, std::memory_order_acquire); }
+
+    private:
+        std::atomic<T*> head { nullptr };
+    };
+
+    juce::SharedResourcePointer<LoopMemoryManager> memoryManager;
+    LoopMemoryManager::Client memoryClient;
+
+    FreeQueue<Chunk> spareChunks;       // Zeroed, ready to hand out
+    RetiredStack<Chunk> retiredChunks;  // Released by layers, still holding old audio
+    std::vector<Chunk*> recycleScratch; // Maintenance thread only: retired chunks waiting to be zeroed
+
+    std::vector<std::unique_ptr<ChunkTable>> allTables;
+    FreeQueue<ChunkTable> cleanTables;         // All slots nullptr
+    RetiredStack<ChunkTable> retiredTables;    // Handed back by clears, still referencing chunks
+    std::atomic<int> chunksAllocated { 0 };
+    std::atomic<int> acquireMisses { 0 };
+    std::atomic<bool> budgetExhausted { false };
+    mutable std::atomic<int> activeReaders { 0 };  // ReadPins held right now
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            recycleRetiredTables();
+            recycleRetiredChunks();
+            topUpSpares();
+            wait(10);
+        }
+    }
+
+    Chunk* allocateChunk()
+    {
+        if (!memoryManager->reserve(memoryClient, static_cast<juce::int64>(CHUNK_BYTES)))
+            return nullptr;
+
+        chunksAllocated.fetch_add(1);
+        return new Chunk();  // Value-initialised, so already silent
+    }
+
+    void freeChunk(Chunk* chunk)
+    {
+        chunksAllocated.fetch_sub(1);
+        memoryManager->release(memoryClient, static_cast<juce::int64>(CHUNK_BYTES));
+        delete chunk;
+    }
+
+    // Release the chunks of retired tables, then make the tables available again
+    void recycleRetiredTables()
+    {
+        ChunkTable* table = retiredTables.takeAll();
+        while (table != nullptr)
+        {
+            ChunkTable* next = table->nextRetired;
+            for (auto& chunk : table->slots)
+            {
+                Chunk* released = chunk;
+                chunk = nullptr;
+                release(released);
+            }
+
+            // The queue holds every table, so a full push only means a reader preempted
+            // mid-pop still owns the cell - retry on the next pass
+            if (!cleanTables.push(table))
+                retiredTables.push(table);
+            table = next;
+        }
+    }
+
+    // Zero released chunks, then restock or free them. A reader pinned before they were
+    // retired may still hold them, so they wait (in recycleScratch) for a pass that sees
+    // no ReadPin held.
+    void recycleRetiredChunks()
+    {
+        for (Chunk* chunk = retiredChunks.takeAll(); chunk != nullptr; chunk = chunk->nextRetired)
+            recycleScratch.push_back(chunk);
+
+        if (recycleScratch.empty() || activeReaders.load() > 0)
+            return;
+
+        for (Chunk* chunk : recycleScratch)
+        {
+            chunk->left.fill(0.0f);
+            chunk->right.fill(0.0f);
+            chunk->refCount.store(1);
+
+            if (spareChunks.size() >= static_cast<size_t>(SPARE_CHUNKS) || !spareChunks.push(chunk))
+                freeChunk(chunk);
+        }
+        recycleScratch.clear();
+    }
+
+    void topUpSpares()
+    {
+        while (spareChunks.size() < static_cast<size_t>(SPARE_CHUNKS))
+        {
+            // Allocated here so the audio thread never touches the allocator
+            Chunk* chunk = allocateChunk();
+            if (chunk == nullptr)
+                return;  // Over budget - spares are refilled once memory is freed
+
+            if (!spareChunks.push(chunk))
+            {
+                freeChunk(chunk);
+                return;
+            }
+        }
+    }
+
+    // Maintenance thread stopped: nothing else touches the lists
+    void freeAllChunks()
+    {
+        while (Chunk* chunk = spareChunks.pop())
+            freeChunk(chunk);
+        for (Chunk* chunk = retiredChunks.takeAll(); chunk != nullptr;)
+        {
+            Chunk* next = chunk->nextRetired;
+            freeChunk(chunk);
+            chunk = next;
+        }
+        for (Chunk* chunk : recycleScratch)
+            freeChunk(chunk);
+        recycleScratch.clear();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoopChunkPool)
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+
+/**
+ * LoopCommand - One transport or layer-structure request from the UI
+ *
+ * The WebView native functions used to call record()/overdub()/clear()/deleteLayer()...
+ * directly on the message thread, mutating currentLayer, highestLayer and the layer
+ * buffers while processBlock was reading them. They now post a LoopCommand instead and
+ * LoopEngine applies it on the audio thread at the top of the next block, so the
+ * engine's layer state only ever changes between blocks, on the thread that reads it.
+ * Transport commands can be quantized to the next beat, bar or loop boundary; the engine
+ * timestamps them on its sample clock and splits the block to apply them on that sample.
+ *
+ * Continuous per-layer parameters (volume, pan, EQ, pitch) are atomics the audio thread
+ * smooths towards and stay direct setters. Per-layer loop bounds and reverse move the
+ * layer's playhead, bounds and look-ahead feed, so they are commands too.
+ */
+struct LoopCommand
+{
+    enum class Type : juce::uint8
+    {
+        Record = 0,
+        StopRecording,      // flag = continue to overdub
+        Play,
+        Stop,
+        Overdub,
+        Undo,
+        Redo,
+        Clear,
+        ClearLayer,         // layer is 1-indexed
+        DeleteLayer,        // layer is 1-indexed
+        JumpToLayer,        // layer is 0-indexed
+        SetLayerMuted,      // layer is 1-indexed, flag = muted
+        SetLayerSoloed,     // layer is 1-indexed, flag = soloed
+        SetReverse,         // flag = reversed
+        ResetLoopParams,
+        SetAdditiveMode,    // flag = enabled
+        Flatten,
+        SetLayerLoopStart,  // layer is 1-indexed, value = normalized position
+        SetLayerLoopEnd,    // layer is 1-indexed, value = normalized position
+        SetLayerReverse     // layer is 1-indexed, flag = reversed
+    };
+
+    // When a transport command (Record, StopRecording, Play, Overdub) takes effect.
+    // Other commands always apply at the start of the next block.
+    enum class Quantize : juce::uint8
+    {
+        Default = 0,    // The engine's transport quantize setting
+        Off,            // Start of the next block
+        Beat,
+        Bar,            // 4 beats
+        Loop            // Master loop boundary (bar while there is no loop yet)
+    };
+
+    Type type = Type::Record;
+    int layer = 0;
+    bool flag = false;
+    float value = 0.0f;
+    Quantize quantize = Quantize::Default;
+
+    bool isQuantizable() const noexcept
+    {
+        return type == Type::Record || type == Type::StopRecording || type == Type::Play || type == Type::Overdub;
+    }
+};
+
+/**
+ * LoopCommandQueue - Bounded single-producer/single-consumer queue of LoopCommands
+ *
+ * Producer: the message thread (native functions). Consumer: the audio thread, which
+ * drains it at the top of LoopEngine::processBlock. Fixed capacity, no locks and no
+ * allocation on either side; a push into a full queue fails and the caller drops the
+ * command (the UI re-sends on the next press).
+ *
+ * The two indices only ever grow (wrapping at 2^32), each written by one side; slots are
+ * published with release/acquire on the write index and freed the same way on the read
+ * index. They sit on separate cache lines so the threads don't false-share.
+ */
+class LoopCommandQueue
+{
+public:
+    static constexpr int CAPACITY = 256;  // Power of two
+
+    LoopCommandQueue() = default;
+
+    // Message thread
+    bool push(const LoopCommand& command) noexcept
+    {
+        const juce::uint32 write = writeIndex.load(std::memory_order_relaxed);
+        if (write - readIndex.load(std::memory_order_acquire) >= static_cast<juce::uint32>(CAPACITY))
+            return false;
+
+        slots[write & MASK] = command;
+        writeIndex.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Audio thread
+    bool pop(LoopCommand& command) noexcept
+    {
+        const juce::uint32 read = readIndex.load(std::memory_order_relaxed);
+        if (read == writeIndex.load(std::memory_order_acquire))
+            return false;
+
+        command = slots[read & MASK];
+        readIndex.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const noexcept
+    {
+        return readIndex.load(std::memory_order_acquire) == writeIndex.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr juce::uint32 MASK = static_cast<juce::uint32>(CAPACITY - 1);
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "LoopCommandQueue capacity must be a power of two");
+
+    std::array<LoopCommand, CAPACITY> slots {};
+    alignas(64) std::atomic<juce::uint32> writeIndex { 0 };
+    alignas(64) std::atomic<juce::uint32> readIndex { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoopCommandQueue)
+};
@@ -1,6 +1,11 @@
 #pragma once
 
 #include "LoopBuffer.h"
+#include "LayerRenderService.h"
+#include "LoopCommandQueue.h"
+#include "OutputMixKernel.h"
+#include "RealtimeSafety.h"
+#include "RealtimeWorkerPool.h"
 #include <array>
 #include <atomic>
 #include <cmath>
@@ -33,18 +38,49 @@ public:
     {
         currentSampleRate = sampleRate;
 
+        // Layer audio lives in chunks from a shared pool - size it for every layer at max length.
+        // Layers hand their chunk tables back first so the pool can rebuild them.
+        for (auto& layer : layers)
+        {
+            layer.releaseStorage();
+            layer.releasePitchShifter();
+        }
+        renderService.detach();
+        additiveCaptureStorage.detach();
+
+        // Room for every layer twice over (render snapshots keep replaced audio alive until
+        // they finish), each layer's playback cache and its render result, plus the flatten
+        // result and the ADD+ capture storage
+        const int maxLoopSamples = static_cast<int>(LoopBuffer::MAX_LOOP_SECONDS * sampleRate);
+        chunkPool.prepare(NUM_LAYERS * 4 + 2, LoopChunkPool::chunksForSamples(maxLoopSamples));
+        renderService.prepare(chunkPool, maxLoopSamples);
+        additiveCaptureStorage.prepare(chunkPool, maxLoopSamples);
+        additiveCapturePeaks.prepare(additiveCaptureStorage, maxLoopSamples);
+
+        // Pitch shifters are shared too - only layers that are actually pitched lease one
+        pitchShifterPool.prepare(sampleRate, samplesPerBlock);
+
         // Prepare all layers
         for (int i = 0; i < NUM_LAYERS; ++i)
         {
-            layers[i].prepare(sampleRate, samplesPerBlock);
+            layers[i].prepare(sampleRate, samplesPerBlock, chunkPool, pitchShifterPool);
+            layers[i].setAudioLog(&audioLog, i);
         }
+        updatePitchShifterDemand();
 
         // Pre-allocate buffers to avoid allocation in processBlock
         // Using stereo (2 channels) as that's the typical case
         inputBuffer.setSize(2, samplesPerBlock);
-        layerBuffer.setSize(2, samplesPerBlock);
-        dummyBuffer.setSize(2, samplesPerBlock);
+        for (auto& layerOutput : layerOutputs)
+            layerOutput.setSize(2, samplesPerBlock);
         loopOnlyBuffer.setSize(2, samplesPerBlock);
+        bounceBuffer.setSize(2, samplesPerBlock);
+        bounceLayerBuffer.setSize(2, samplesPerBlock);
+        additiveScratch.setSize(2, samplesPerBlock);
+
+        // Layer workers run at real-time priority with one block as their period (shared by
+        // every engine; the first to prepare starts them)
+        layerWorkers->start(1000.0 * samplesPerBlock / sampleRate);
 
         // Initialize smear buffers
         smearBufferL.resize(SMEAR_BUFFER_SIZE, 0.0f);
@@ -61,8 +97,25 @@ public:
         currentLayer = 0;
         highestLayer = 0;
         masterLoopLength = 0;
+        numScheduled = 0;
+        numPendingCommands.store(0);
     }
 
+    // Message thread: queue a transport/layer command for the audio thread, which applies
+    // it at the start of the next block. Returns false (command dropped) if the queue is full.
+    bool postCommand(const LoopCommand& command)
+    {
+        const bool queued = commandQueue.push(command);
+        if (!queued)
+            DBG("LoopEngine::postCommand() - command queue full, dropping command " +
+                juce::String(static_cast<int>(command.type)));
+        return queued;
+    }
+
+    // The transport and layer methods below mutate currentLayer/highestLayer and the
+    // layer buffers, so they run on the audio thread: from applyCommand() for UI
+    // commands, or directly from the processor (host transport sync).
+
     // Transport controls - Blooper-style workflow:
     // 1. REC (idle) -> Start recording
     // 2. REC (recording) -> Stop recording, start playback
@@ -71,20 +124,17 @@ public:
     void record()
     {
         LoopBuffer::State currentState = getCurrentState();
-        DBG("LoopEngine::record() called, currentState=" + juce::String(static_cast<int>(currentState)));
 
         if (currentState == LoopBuffer::State::Idle)
         {
             // Calculate target length based on preset bars
             int targetLength = getTargetLoopLengthSamples();
-            DBG("record() - Idle state, targetLength=" + juce::String(targetLength));
 
             // Find first available (empty) layer
             int availableLayer = findFirstAvailableLayer();
 
             if (availableLayer < 0)
             {
-                DBG("record() - All layers full, cannot record");
                 return;
             }
 
@@ -94,8 +144,8 @@ public:
                 currentLayer = availableLayer;
                 // Reset loop parameters to defaults when starting new recording
                 resetLoopParams();
-                DBG("record() - Starting fresh recording on layer " + juce::String(currentLayer));
                 layers[currentLayer].startRecording(targetLength);
+                recordStartTime = segmentStartTime;
             }
             else
             {
@@ -103,15 +153,14 @@ public:
                 currentLayer = availableLayer;
                 // Use master loop length for subsequent layers
                 int layerTarget = (masterLoopLength > 0) ? masterLoopLength : targetLength;
-                DBG("record() - Starting recording on layer " + juce::String(currentLayer) + " with target " + juce::String(layerTarget));
                 layers[currentLayer].startRecording(layerTarget);
+                recordStartTime = segmentStartTime;
             }
         }
         else if (currentState == LoopBuffer::State::Recording)
         {
             // Stop initial recording -> start overdub on NEW layer
             // Each REC tap always creates a new layer
-            DBG("record() - Stopping recording, starting overdub on new layer");
             stopRecording(false);  // false = go to Playing first
 
             // Set master loop length from first recording if not already set
@@ -126,14 +175,12 @@ public:
         else if (currentState == LoopBuffer::State::Playing)
         {
             // REC while playing starts overdubbing on a NEW layer
-            DBG("record() - Playing state, calling overdub() for new layer");
             overdub();
         }
         else if (currentState == LoopBuffer::State::Overdubbing)
         {
             // REC while overdubbing: stop current layer, start NEW layer immediately
             // Each REC tap always creates a new layer (no toggle off)
-            DBG("record() - Overdubbing state, stopping layer " + juce::String(currentLayer) + " and starting new layer");
             layers[currentLayer].stopOverdub();
 
             // Immediately start overdubbing on next layer if available
@@ -141,10 +188,7 @@ public:
             {
                 overdub();  // This will create a new layer
             }
-            else
-            {
-                DBG("record() - Max layers reached, continuing playback");
-            }
+            // Otherwise max layers reached - the layer just keeps playing
         }
     }
 
@@ -192,7 +236,6 @@ public:
         // If additive capture is active, stop it (PLAY stops DUB in ADD+ mode)
         if (additiveRecordingActive.load())
         {
-            DBG("play() - Stopping ADD+ capture");
             stopAdditiveCapture();
         }
 
@@ -200,7 +243,6 @@ public:
         // Don't restart playback - keep position and continue playing
         if (currentState == LoopBuffer::State::Overdubbing)
         {
-            DBG("play() - Stopping overdub on layer " + juce::String(currentLayer) + " (smooth transition)");
             layers[currentLayer].stopOverdub();
             return;
         }
@@ -228,8 +270,6 @@ public:
         {
             stopAdditiveCapture();
         }
-
-        DBG("LoopEngine::stop() - All layers stopped, additive recording stopped");
     }
 
     // Clear a specific layer (1-indexed for UI)
@@ -239,7 +279,6 @@ public:
         if (idx < 0 || idx >= NUM_LAYERS)
             return;
 
-        DBG("clearLayer() - Clearing layer " + juce::String(layer));
         layers[idx].clear();
 
         // Update highestLayer if we cleared the highest one
@@ -283,8 +322,6 @@ public:
         if (idx < 0 || idx >= NUM_LAYERS)
             return;
 
-        DBG("deleteLayer() - Deleting layer " + juce::String(layer) + " and shuffling");
-
         // Clear the target layer
         layers[idx].clear();
 
@@ -293,10 +330,9 @@ public:
         {
             if (layers[i + 1].hasContent())
             {
-                // Copy content from layer i+1 to layer i
-                layers[i].copyFrom(layers[i + 1]);
+                // Move content from layer i+1 to layer i (swaps chunk tables, no audio copied)
+                layers[i].moveFrom(layers[i + 1]);
                 layers[i + 1].clear();
-                DBG("  Moved layer " + juce::String(i + 2) + " to layer " + juce::String(i + 1));
             }
         }
 
@@ -368,11 +404,6 @@ public:
     void overdub()
     {
         LoopBuffer::State currentState = getCurrentState();
-        DBG("LoopEngine::overdub() called, currentState=" + juce::String(static_cast<int>(currentState)) +
-            " currentLayer=" + juce::String(currentLayer) +
-            " highestLayer=" + juce::String(highestLayer) +
-            " hasContent=" + juce::String(layers[0].hasContent() ? "true" : "false") +
-            " additiveModeEnabled=" + juce::String(additiveModeEnabled.load() ? "true" : "false"));
 
         // Ensure masterLoopLength is set if layer 0 has content
         // This handles the case where fixed-length recording auto-stopped
@@ -381,7 +412,6 @@ public:
         {
             masterLoopLength = layers[0].getLoopLengthSamples();
             highestLayer = std::max(highestLayer, 0);
-            DBG("overdub() - Fixed masterLoopLength from layer 0: " + juce::String(masterLoopLength));
         }
 
         // If ADD+ mode is enabled, start additive capture instead of normal overdub
@@ -391,7 +421,6 @@ public:
             if (!additiveRecordingActive.load())
             {
                 startAdditiveCapture();
-                DBG("overdub() - Started ADD+ capture mode");
             }
             // Don't do normal overdub when in ADD+ mode - we're just capturing
             return;
@@ -412,26 +441,19 @@ public:
                 if (highestLayer < NUM_LAYERS - 1)
                 {
                     // Get current playhead from layer 0 to sync new layer
-                    float masterPlayhead = layers[0].getRawPlayhead();
+                    const LoopPhase masterPlayhead = getMasterPhase();
 
                     currentLayer = highestLayer + 1;
                     highestLayer = currentLayer;
-                    DBG("Starting overdub on NEW layer " + juce::String(currentLayer) +
-                        " syncing playhead to " + juce::String(masterPlayhead));
                     layers[currentLayer].startOverdubOnNewLayer(masterLoopLength);
                     layers[currentLayer].setPlayhead(masterPlayhead);
                 }
-                else
-                {
-                    DBG("Cannot overdub - max layers reached");
-                }
+                // Otherwise max layers reached - nothing to overdub on
             }
             else
             {
                 // Current layer is empty - overdub on this layer (don't create new)
-                float masterPlayhead = layers[0].getRawPlayhead();
-                DBG("Starting overdub on EXISTING empty layer " + juce::String(currentLayer) +
-                    " syncing playhead to " + juce::String(masterPlayhead));
+                const LoopPhase masterPlayhead = getMasterPhase();
                 layers[currentLayer].startOverdubOnNewLayer(masterLoopLength);
                 layers[currentLayer].setPlayhead(masterPlayhead);
                 highestLayer = std::max(highestLayer, currentLayer);
@@ -444,7 +466,6 @@ public:
             // This prevents accidental layer creation and matches Blooper behavior
             if (layerModeEnabled.load())
             {
-                DBG("LAYER MODE: Stopping overdub on layer " + juce::String(currentLayer) + " (DUB = stop, not new layer)");
                 layers[currentLayer].stopOverdub();
                 // Don't create new layer - just continue playback
                 return;
@@ -452,24 +473,18 @@ public:
 
             // TRACK MODE: pressing DUB while overdubbing creates a NEW layer immediately
             // Stop current layer's overdub immediately (no fade needed - new layer takes over)
-            DBG("TRACK MODE: Stopping overdub on layer " + juce::String(currentLayer) + " to create new layer");
             layers[currentLayer].stopOverdubImmediate();
 
             // Create new layer and start overdubbing
             if (highestLayer < NUM_LAYERS - 1)
             {
-                float masterPlayhead = layers[0].getRawPlayhead();
+                const LoopPhase masterPlayhead = getMasterPhase();
                 currentLayer = highestLayer + 1;
                 highestLayer = currentLayer;
-                DBG("Starting overdub on NEW layer " + juce::String(currentLayer) +
-                    " syncing playhead to " + juce::String(masterPlayhead));
                 layers[currentLayer].startOverdubOnNewLayer(masterLoopLength);
                 layers[currentLayer].setPlayhead(masterPlayhead);
             }
-            else
-            {
-                DBG("Cannot create new layer - max layers reached, just stopping overdub");
-            }
+            // Otherwise max layers reached - the overdub just stops
         }
         else if (currentState == LoopBuffer::State::Idle && highestLayer >= 0 && layers[0].hasContent())
         {
@@ -477,12 +492,11 @@ public:
             clearUndoneLayers();
 
             // If idle with content, play and immediately overdub on a new layer
-            DBG("Idle with content - starting play + overdub on new layer");
             play();
             if (highestLayer < NUM_LAYERS - 1)
             {
                 // Get current playhead from layer 0 (should be 0 since we just started playing)
-                float masterPlayhead = layers[0].getRawPlayhead();
+                const LoopPhase masterPlayhead = getMasterPhase();
 
                 currentLayer = highestLayer + 1;
                 highestLayer = currentLayer;
@@ -490,10 +504,6 @@ public:
                 layers[currentLayer].setPlayhead(masterPlayhead);
             }
         }
-        else
-        {
-            DBG("overdub() - no action taken");
-        }
     }
 
     void undo()
@@ -505,12 +515,10 @@ public:
             LoopBuffer::State layerState = layers[currentLayer].getState();
             if (layerState == LoopBuffer::State::Overdubbing)
             {
-                DBG("undo() - stopping overdub on layer " + juce::String(currentLayer) + " before undo");
                 layers[currentLayer].stopOverdub();
             }
             else if (layerState == LoopBuffer::State::Recording)
             {
-                DBG("undo() - stopping recording on layer " + juce::String(currentLayer) + " before undo");
                 layers[currentLayer].stopRecording(false);
             }
 
@@ -521,9 +529,6 @@ public:
 
             // Track highest undone layer for redo
             // highestLayer stays the same - it tracks max recorded, not current
-            DBG("undo() - muted layer " + juce::String(currentLayer + 1) +
-                ", now on layer " + juce::String(currentLayer) +
-                ", highestLayer still " + juce::String(highestLayer));
         }
     }
 
@@ -540,7 +545,6 @@ public:
             {
                 layers[currentLayer].play();
             }
-            DBG("redo() - unmuted and restored layer " + juce::String(currentLayer));
         }
     }
 
@@ -553,7 +557,6 @@ public:
         {
             if (layers[i].getMuted())
             {
-                DBG("clearUndoneLayers() - permanently clearing undone layer " + juce::String(i));
                 layers[i].clear();
             }
         }
@@ -577,6 +580,9 @@ public:
         currentLayer = 0;
         highestLayer = 0;
 
+        // Memory was just handed back, so drop any earlier out-of-budget warning
+        chunkPool.clearBudgetExhausted();
+
         // If we were actively playing/recording, preserve the length and start overdubbing
         if (wasActive && preservedLength > 0)
         {
@@ -584,14 +590,11 @@ public:
             // Start overdubbing on layer 0 with the preserved loop length
             // startOverdubOnNewLayer sets up buffer and puts layer in Overdubbing state
             layers[0].startOverdubOnNewLayer(masterLoopLength);
-            DBG("clear() - Active state: preserved loop length " + juce::String(masterLoopLength) +
-                " and started DUB on layer 0");
         }
         else
         {
             // Stopped/idle: full reset including loop length so user can create fresh loop
             masterLoopLength = 0;
-            DBG("clear() - Idle state: full reset, loop length cleared");
         }
     }
 
@@ -611,7 +614,6 @@ public:
         if (idx >= 0 && idx < NUM_LAYERS)
         {
             layers[idx].setMuted(muted);
-            DBG("Layer " + juce::String(layer) + " muted: " + juce::String(muted ? "true" : "false"));
         }
     }
 
@@ -640,9 +642,6 @@ public:
                 soloCount.fetch_add(1);
             else if (!soloed && wasSoloed)
                 soloCount.fetch_sub(1);
-
-            DBG("Layer " + juce::String(layer) + " soloed: " + juce::String(soloed ? "true" : "false") +
-                " (total soloed: " + juce::String(soloCount.load()) + ")");
         }
     }
 
@@ -774,6 +773,7 @@ public:
     // PER-LAYER LOOP BOUNDARIES (1-indexed for UI)
     // ============================================
 
+    // Audio thread: applied from SetLayerLoopStart/SetLayerLoopEnd commands
     void setLayerLoopStart(int layer, float normalizedPos)
     {
         int idx = layer - 1;
@@ -812,17 +812,40 @@ public:
         return 1.0f;
     }
 
+    // Zoomable waveform for loop start/end editing: numPoints min/max/peak entries over
+    // [startSample, endSample) of one layer. Cost depends on numPoints, not loop length.
+    std::vector<WaveformPyramid::Peak> getLayerWaveformRange(int layer, int startSample, int endSample, int numPoints) const
+    {
+        int idx = layer - 1;
+        if (idx >= 0 && idx < NUM_LAYERS)
+        {
+            return layers[idx].getWaveformRange(startSample, endSample, numPoints);
+        }
+        return std::vector<WaveformPyramid::Peak>(static_cast<size_t>(std::max(0, numPoints)));
+    }
+
+    int getLayerWaveformLength(int layer) const
+    {
+        int idx = layer - 1;
+        if (idx >= 0 && idx < NUM_LAYERS)
+        {
+            return layers[idx].getWaveformLengthSamples();
+        }
+        return 0;
+    }
+
     // ============================================
     // PER-LAYER REVERSE (1-indexed for UI)
     // ============================================
 
+    // Audio thread: applied from SetLayerReverse commands
     void setLayerReverse(int layer, bool reversed)
     {
         int idx = layer - 1;
         if (idx >= 0 && idx < NUM_LAYERS)
         {
             layers[idx].setReverse(reversed);
-            DBG("Layer " + juce::String(layer) + " reverse: " + juce::String(reversed ? "true" : "false"));
+            audioLog.log(AudioLog::Event::ReverseChanged, idx, reversed ? 1 : 0);
         }
     }
 
@@ -847,6 +870,7 @@ public:
         if (idx >= 0 && idx < NUM_LAYERS)
         {
             layers[idx].setLayerPitch(semitones);
+            updatePitchShifterDemand();
         }
     }
 
@@ -866,6 +890,7 @@ public:
         if (idx >= 0 && idx < NUM_LAYERS)
         {
             layers[idx].setLayerPitchHQ(hq);
+            updatePitchShifterDemand();
         }
     }
 
@@ -895,7 +920,7 @@ public:
         {
             layers[i].setLoopStart(normalizedPos);
         }
-        DBG("Global loop start changed to: " + juce::String(normalizedPos, 3));
+        audioLog.log(AudioLog::Event::LoopStartChanged, -1, normalizedPos);
     }
 
     void setLoopEnd(float normalizedPos)
@@ -911,7 +936,7 @@ public:
         {
             layers[i].setLoopEnd(normalizedPos);
         }
-        DBG("Global loop end changed to: " + juce::String(normalizedPos, 3));
+        audioLog.log(AudioLog::Event::LoopEndChanged, -1, normalizedPos);
     }
 
     void setSpeed(float rate)
@@ -938,7 +963,7 @@ public:
             layers[i].setReverse(reversed);
         }
 
-        DBG("Global reverse changed to: " + juce::String(reversed ? "true" : "false"));
+        audioLog.log(AudioLog::Event::ReverseChanged, -1, reversed ? 1 : 0);
     }
 
     void setPitchShift(float semitones)
@@ -948,6 +973,19 @@ public:
         {
             layers[i].setPitchShift(semitones);
         }
+        updatePitchShifterDemand();
+    }
+
+    // Tell the shifter pool how many layers want a pitch shifter of each quality, so its
+    // thread has them prepared before the layers lease them. Lock-free; called from the
+    // pitch and quality setters.
+    void updatePitchShifterDemand()
+    {
+        int numStandard = 0, numHighQuality = 0;
+        for (const auto& layer : layers)
+            if (layer.wantsPitchShifter())
+                ++(layer.getLayerPitchHQ() ? numHighQuality : numStandard);
+        pitchShifterPool.setDemand(numStandard, numHighQuality);
     }
 
     // Fade/decay: 0.0 = fade completely after one loop, 1.0 = no fade (infinite)
@@ -959,8 +997,33 @@ public:
         }
     }
 
+    // Transport quantization for UI transport commands (record, stop recording, play,
+    // overdub). Message thread; Off applies them at the start of the next block.
+    void setTransportQuantize(LoopCommand::Quantize quantize)
+    {
+        transportQuantize.store(quantize == LoopCommand::Quantize::Default ? LoopCommand::Quantize::Off : quantize);
+    }
+
+    LoopCommand::Quantize getTransportQuantize() const { return transportQuantize.load(); }
+
+    // Commands waiting for their quantization point (for the UI's "armed" indicator)
+    int getNumPendingCommands() const { return numPendingCommands.load(); }
+
+    // Audio thread (processor, before processBlock): host timeline at the start of the
+    // block, used as the beat/bar grid while no loop is playing
+    void setHostPosition(bool isPlaying, double ppqPosition, double ppqLastBarStart)
+    {
+        hostTimelineValid = isPlaying;
+        hostPpq = ppqPosition;
+        hostBarStartPpq = ppqLastBarStart;
+    }
+
     // Process audio - returns separate loop playback and input buffers for Blooper-style processing
     // Effects like degrade should only be applied to loopPlaybackBuffer, not inputBuffer
+    //
+    // UI commands are timestamped on the engine's sample clock as they come out of the queue
+    // (block start, or their quantization point) and the block is split there, so each one
+    // takes effect at its exact sample.
     void processBlock(juce::AudioBuffer<float>& buffer,
                       juce::AudioBuffer<float>* loopPlaybackBuffer = nullptr,
                       juce::AudioBuffer<float>* inputPassthroughBuffer = nullptr)
@@ -968,6 +1031,62 @@ public:
         const int numSamples = buffer.getNumSamples();
         const int numChannels = buffer.getNumChannels();
 
+        segmentStartTime = blockStartTime;
+        LoopCommand command;
+        while (commandQueue.pop(command))
+            scheduleCommand(command);
+
+        // Segments write straight into the output buffers through views, so size them once
+        if (loopPlaybackBuffer != nullptr
+            && (loopPlaybackBuffer->getNumSamples() < numSamples || loopPlaybackBuffer->getNumChannels() < numChannels))
+            loopPlaybackBuffer->setSize(numChannels, numSamples, false, false, true);
+        if (inputPassthroughBuffer != nullptr
+            && (inputPassthroughBuffer->getNumSamples() < numSamples || inputPassthroughBuffer->getNumChannels() < numChannels))
+            inputPassthroughBuffer->setSize(numChannels, numSamples, false, false, true);
+
+        for (int pos = 0; pos < numSamples;)
+        {
+            segmentStartTime = blockStartTime + pos;
+            applyDueCommands();
+
+            int end = numSamples;
+            if (numScheduled > 0)
+                end = static_cast<int>(juce::jlimit<juce::int64>(pos + 1, numSamples, scheduled[0].time - blockStartTime));
+
+            if (pos == 0 && end == numSamples)
+            {
+                processSegment(buffer, loopPlaybackBuffer, inputPassthroughBuffer);
+            }
+            else
+            {
+                const int length = end - pos;
+                juce::AudioBuffer<float> segment(buffer.getArrayOfWritePointers(), numChannels, pos, length);
+                juce::AudioBuffer<float> loopSegment, inputSegment;
+                if (loopPlaybackBuffer != nullptr)
+                    loopSegment.setDataToReferTo(loopPlaybackBuffer->getArrayOfWritePointers(), numChannels, pos, length);
+                if (inputPassthroughBuffer != nullptr)
+                    inputSegment.setDataToReferTo(inputPassthroughBuffer->getArrayOfWritePointers(), numChannels, pos, length);
+
+                processSegment(segment, loopPlaybackBuffer != nullptr ? &loopSegment : nullptr,
+                               inputPassthroughBuffer != nullptr ? &inputSegment : nullptr);
+            }
+
+            pos = end;
+        }
+
+        blockStartTime += numSamples;
+        numPendingCommands.store(numScheduled);
+    }
+
+    // One stretch of a block between scheduled commands (the whole block when none are due)
+    void processSegment(juce::AudioBuffer<float>& buffer,
+                        juce::AudioBuffer<float>* loopPlaybackBuffer = nullptr,
+                        juce::AudioBuffer<float>* inputPassthroughBuffer = nullptr)
+    {
+        const int numSamples = buffer.getNumSamples();
+        const int numChannels = buffer.getNumChannels();
+        loopBoundaryThisBlock = false;
+
         // Calculate input levels for metering (before any processing)
         float peakL = 0.0f;
         float peakR = 0.0f;
@@ -988,12 +1107,15 @@ public:
         // (This is a no-op if they're already the right size)
         if (inputBuffer.getNumSamples() < numSamples || inputBuffer.getNumChannels() < numChannels)
             inputBuffer.setSize(numChannels, numSamples, false, false, true);
-        if (layerBuffer.getNumSamples() < numSamples || layerBuffer.getNumChannels() < numChannels)
-            layerBuffer.setSize(numChannels, numSamples, false, false, true);
-        if (dummyBuffer.getNumSamples() < numSamples || dummyBuffer.getNumChannels() < numChannels)
-            dummyBuffer.setSize(numChannels, numSamples, false, false, true);
+        for (auto& layerOutput : layerOutputs)
+            if (layerOutput.getNumSamples() < numSamples || layerOutput.getNumChannels() < numChannels)
+                layerOutput.setSize(numChannels, numSamples, false, false, true);
         if (loopOnlyBuffer.getNumSamples() < numSamples || loopOnlyBuffer.getNumChannels() < numChannels)
             loopOnlyBuffer.setSize(numChannels, numSamples, false, false, true);
+        if (bounceBuffer.getNumSamples() < numSamples || bounceBuffer.getNumChannels() < numChannels)
+            bounceBuffer.setSize(numChannels, numSamples, false, false, true);
+        if (bounceLayerBuffer.getNumSamples() < numSamples || bounceLayerBuffer.getNumChannels() < numChannels)
+            bounceLayerBuffer.setSize(numChannels, numSamples, false, false, true);
 
         // Copy input to our pre-allocated buffer
         for (int ch = 0; ch < numChannels; ++ch)
@@ -1021,10 +1143,6 @@ public:
             }
         }
 
-        // Clear output buffers - we'll add layers to them
-        buffer.clear();
-        loopOnlyBuffer.clear();
-
         // Process ALL layers with content up to highestLayer
         // Each layer can be independently muted regardless of currentLayer
         bool anyPlaying = false;
@@ -1040,7 +1158,7 @@ public:
         {
             masterLoopLength = layers[0].getLoopLengthSamples();
             highestLayer = std::max(highestLayer, 0);
-            DBG("processBlock() - Fixed masterLoopLength from layer 0: " + juce::String(masterLoopLength));
+            audioLog.log(AudioLog::Event::MasterLengthRecovered, -1, masterLoopLength);
         }
 
         // Override layer skip logic (v7.1.0)
@@ -1066,7 +1184,6 @@ public:
         // This buffer will contain the "bounce" audio (all previous layers mixed)
         // IMPORTANT: Only bounce for exactly ONE LOOP PASS to prevent volume buildup
         const bool layerMode = layerModeEnabled.load();
-        juce::AudioBuffer<float> bounceBuffer;
         int recordingLayerIndex = -1;
         bool shouldBounce = false;  // Whether to add bounce audio this block
 
@@ -1091,12 +1208,11 @@ public:
                 {
                     // New recording session - initialize bounce tracking
                     layerModeBounceLayer = recordingLayerIndex;
-                    layerModeBounceStartSample = static_cast<int>(layers[0].getRawPlayhead());
+                    layerModeBounceStartSample = getMasterPhase().index();
                     layerModeBounceProgress = 0;
                     layerModeBounceComplete = false;
-                    DBG("Layer mode bounce START: layer=" + juce::String(recordingLayerIndex) +
-                        " startSample=" + juce::String(layerModeBounceStartSample) +
-                        " loopLength=" + juce::String(masterLoopLength));
+                    audioLog.log(AudioLog::Event::LayerBounceStart, -1, recordingLayerIndex + 1,
+                                 layerModeBounceStartSample, masterLoopLength);
                 }
 
                 // Check if we've completed one full loop pass
@@ -1108,8 +1224,7 @@ public:
                     {
                         // One full loop complete - stop bouncing
                         layerModeBounceComplete = true;
-                        DBG("Layer mode bounce COMPLETE: recorded " + juce::String(layerModeBounceProgress) +
-                            " samples, bounce now OFF");
+                        audioLog.log(AudioLog::Event::LayerBounceComplete, -1, layerModeBounceProgress);
                     }
                 }
 
@@ -1118,8 +1233,7 @@ public:
 
                 if (shouldBounce)
                 {
-                    bounceBuffer.setSize(numChannels, numSamples, false, false, true);
-                    bounceBuffer.clear();
+                    bounceBuffer.clear(0, numSamples);
 
                     // In Layer Mode, only bounce from the HIGHEST unmuted layer below recording layer
                     // This is because each layer already contains ALL prior layers' content baked in
@@ -1143,7 +1257,8 @@ public:
                     {
                         // Get this layer's RAW playback (no fade/volume/pan)
                         // We want to record the actual buffer content, not attenuated output
-                        juce::AudioBuffer<float> tempLayer(numChannels, numSamples);
+                        // Non-owning view of the preallocated scratch, exactly numSamples long
+                        juce::AudioBuffer<float> tempLayer(bounceLayerBuffer.getArrayOfWritePointers(), numChannels, numSamples);
                         tempLayer.clear();
                         layers[bounceFromLayer].peekPlaybackRaw(tempLayer);
 
@@ -1158,7 +1273,7 @@ public:
                 // No recording happening - reset bounce state
                 if (layerModeBounceLayer >= 0)
                 {
-                    DBG("Layer mode bounce RESET: recording stopped");
+                    audioLog.log(AudioLog::Event::LayerBounceReset);
                     layerModeBounceLayer = -1;
                     layerModeBounceStartSample = -1;
                     layerModeBounceProgress = 0;
@@ -1181,8 +1296,19 @@ public:
         // Check if solo is active (any layer is soloed)
         bool anySoloActive = soloCount.load() > 0;
 
+        // Three phases so independent layers can render concurrently:
+        //   1. plan (this thread) - decide what each layer does this block
+        //   2. render - each planned layer processes into its own buffer in layerOutputs,
+        //      on this thread or spread over layerWorkers in parallel mode
+        //   3. mix (this thread) - in layer order, exactly as a single serial pass would
+        // A layer only touches its own state and reads inputBuffer/bounceBuffer while it
+        // renders, so both modes produce bit-identical output.
+        numPlannedLayers = 0;
         for (int i = 0; i <= highestLayer; ++i)
         {
+            auto& plan = layerPlans[i];
+            plan = {};
+
             bool hasContent = layers[i].hasContent();
             bool isRecording = (layers[i].getState() == LoopBuffer::State::Recording);
             bool isOverdubbing = (layers[i].getState() == LoopBuffer::State::Overdubbing);
@@ -1199,265 +1325,147 @@ public:
 
             // Check if layer is fully muted and not transitioning (can skip for efficiency)
             // But if transitioning, we need to process to get the smooth fade
-            if (effectivelyMuted && !isMuteTransitioning)
-            {
-                // Fully muted and stable - advance playhead but skip processing
-                dummyBuffer.clear();
-                layers[i].processBlock(dummyBuffer);
-                // Consume the mute gain value to keep smoother in sync
-                layers[i].getMuteGain();
-                continue;
-            }
-
             // Override layer skip: if there's an override layer above this one,
             // skip all Regular layers below it (they're "muted" by the mixdown)
             // Only skip Regular layers - override layers always play
-            if (highestOverride >= 0 && i < highestOverride && !layers[i].isOverrideLayer())
-            {
-                // This Regular layer is below an override layer - skip it
-                // Still advance playhead to stay in sync
-                dummyBuffer.clear();
-                layers[i].processBlock(dummyBuffer);
-                // Consume the mute gain value to keep smoother in sync
-                layers[i].getMuteGain();
+            // Either way the playhead still advances to stay in sync
+            if ((effectivelyMuted && !isMuteTransitioning)
+                || (highestOverride >= 0 && i < highestOverride && !layers[i].isOverrideLayer()))
+            {
+                plan.action = LayerAction::Advance;
+                plannedLayers[numPlannedLayers++] = i;
                 continue;
             }
 
+            plan.action = LayerAction::Render;
+            plan.applyMuteGain = isMuteTransitioning || isMutedState;
+
             // LAYER MODE BOUNCE: Prior layers being bounced should NOT be added to output
             // individually - they'll be heard via the bounce buffer added to the output once.
             // This prevents volume doubling where prior audio is heard twice.
-            bool skipOutputMixing = false;
-            if (layerMode && shouldBounce && recordingLayerIndex > 0 && i < recordingLayerIndex)
-            {
-                // This layer is being bounced - skip individual output mixing
-                // The bounce buffer will be added to output once after all layers are processed
-                skipOutputMixing = true;
-            }
+            plan.skipOutputMixing = layerMode && shouldBounce && recordingLayerIndex > 0 && i < recordingLayerIndex;
 
             // Only pass input to recording/overdubbing layers
             // Playback layers should only output their loop content (no input passthrough)
             if (isRecording || isOverdubbing)
             {
-                // Recording/overdubbing layer gets the input
-                // In Layer mode: also include bounced audio from all previous layers (for first loop pass only)
-                for (int ch = 0; ch < numChannels; ++ch)
-                    layerBuffer.copyFrom(ch, 0, inputBuffer, ch, 0, numSamples);
-
-                // Layer mode bounce: add previous layers' playback to what we're recording
-                // ONLY for the first loop pass - after that, just record input to prevent volume buildup
-                // NOTE: The bounce is recorded INTO the layer, but for MONITORING during recording
-                // we need to hear it. Since the recording layer's processBlock only outputs what
-                // it has recorded so far (which starts empty), we add bounceBuffer to OUTPUT below.
-                if (layerMode && shouldBounce && recordingLayerIndex > 0 && i == recordingLayerIndex)
-                {
-                    for (int ch = 0; ch < numChannels; ++ch)
-                        layerBuffer.addFrom(ch, 0, bounceBuffer, ch, 0, numSamples);
-                }
-
+                plan.feedInput = true;
+                plan.feedBounce = layerMode && shouldBounce && recordingLayerIndex > 0 && i == recordingLayerIndex;
                 inputAddedToOutput = true;  // processBlock will add input to output for monitoring
             }
-            else
-            {
-                // Playback layer gets silence as "input" - it will just output loop content
-                layerBuffer.clear();
-            }
-
-            layers[i].processBlock(layerBuffer);
-
-            // Apply smoothed mute gain for click-free muting
-            // This must be done per-sample to get the smooth transition
-            if (isMuteTransitioning || isMutedState)
-            {
-                // Get pointers for all channels
-                float* channelData[2] = { nullptr, nullptr };
-                for (int ch = 0; ch < numChannels && ch < 2; ++ch)
-                    channelData[ch] = layerBuffer.getWritePointer(ch);
-
-                // Apply gain per-sample (smoother advances once per sample, applied to all channels)
-                for (int s = 0; s < numSamples; ++s)
-                {
-                    float muteGain = layers[i].getMuteGain();
-                    for (int ch = 0; ch < numChannels && ch < 2; ++ch)
-                    {
-                        if (channelData[ch])
-                            channelData[ch][s] *= muteGain;
-                    }
-                }
-            }
 
-            // Check per-layer peak levels for diagnostic metering and VU meters
-            int layerClips = 0;
-            float layerPeak = 0.0f;
-            for (int ch = 0; ch < numChannels; ++ch)
-            {
-                const float* data = layerBuffer.getReadPointer(ch);
-                for (int s = 0; s < numSamples; ++s)
-                {
-                    float absVal = std::abs(data[s]);
-                    if (absVal > layerPeak)
-                        layerPeak = absVal;
-                    if (absVal > 1.0f)
-                        layerClips++;
-                }
-            }
-            if (layerClips > 0)
-                layerClipCounts[i].fetch_add(layerClips);
+            plannedLayers[numPlannedLayers++] = i;
+        }
 
-            // Update layer peak level with decay (for VU meter smoothing)
-            // This is called once per audio block, not per sample
-            // At 44.1kHz with 512 sample blocks, we get ~86 blocks/sec
-            // Decay of 0.9 per block = ~300ms time constant (reaches 10% after ~20 blocks)
-            float currentPeak = layerPeakLevels[i].load();
-            if (layerPeak > currentPeak) {
-                layerPeakLevels[i].store(layerPeak);  // Attack: immediate
-            } else {
-                // Decay per block: 0.9 = fast meter response, 0.95 = slower/smoother
-                layerPeakLevels[i].store(currentPeak * 0.92f);
-            }
+        blockNumSamples = numSamples;
+        blockNumChannels = numChannels;
+        if (parallelLayerRendering.load())
+        {
+            layerWorkers->run(&renderPlannedLayer, this, numPlannedLayers);
+        }
+        else
+        {
+            for (int n = 0; n < numPlannedLayers; ++n)
+                renderLayer(plannedLayers[n]);
+        }
 
-            // Mix into main output (loop + input combined)
-            // Track mode: sum all layers (additive mixing)
-            // Layer mode: higher layers completely override lower layers DURING PLAYBACK
-            //
-            // SKIP OUTPUT MIXING for layers being bounced - they're already included
-            // in the recording layer's output via the bounce buffer
-            if (!skipOutputMixing)
-            {
-                for (int ch = 0; ch < numChannels; ++ch)
-                {
-                    if (!layerMode)
-                    {
-                        // Track mode: simple additive mixing
-                        buffer.addFrom(ch, 0, layerBuffer, ch, 0, numSamples);
-                    }
-                    else
-                    {
-                        // Layer mode: ALL layers use copyFrom to override prior layers
-                        // This includes recording/overdubbing layers - they contain the full mix
-                        // (bounce + input + existing content) and should completely replace
-                        // any prior layer content in the output buffer.
-                        //
-                        // During bounce: prior layers are skipped via skipOutputMixing
-                        // After bounce complete: recording layer has the bounced content baked in,
-                        // so it should override (not add to) prior layers' output.
-                        buffer.copyFrom(ch, 0, layerBuffer, ch, 0, numSamples);
-                    }
-                }
-            }
+        // Phase 3: mix. One fused pass per channel (OutputMixKernel) writes the layer mix
+        // over the output and the loop-only bus (no separate clear), subtracts input/bounce
+        // from recording layers, adds the monitored input, meters every layer and both
+        // buses, and soft clips.
+        //
+        // Track mode: sum all layers (additive mixing)
+        // Layer mode: ALL layers override prior layers (copy semantics) - this includes
+        // recording/overdubbing layers, which contain the full mix (bounce + input +
+        // existing content). During bounce, prior layers are skipped (skipOutputMixing):
+        // they're heard via the bounce buffer inside the recording layer's output, and are
+        // kept out of the loop-only bus so effects don't double them.
+        //
+        // Loop-only bus: just the loop playback portion (without input) so effects like
+        // degrade only affect loop playback. A recording/overdubbing layer outputs
+        // existingLoop + input (+ bounce in Layer mode), so both are subtracted - otherwise
+        // the bounce audio leaks into loopOnlyBuffer and gets re-added in PluginProcessor,
+        // causing volume doubling at recording start.
+        int numMixSources = 0;
+        for (int i = 0; i <= highestLayer; ++i)
+        {
+            const auto& plan = layerPlans[i];
+            if (plan.action != LayerAction::Render)
+                continue;
 
-            // Also accumulate JUST the loop playback portion (without input) for separate processing
-            // This allows effects like degrade to only affect loop playback, not input
-            // Also skip for bounced layers to prevent double-counting in effects
-            if (!skipOutputMixing)
-            {
-                if (!isRecording && !isOverdubbing)
-                {
-                    // Pure playback layer - apply same mixing logic as main buffer
-                    for (int ch = 0; ch < numChannels; ++ch)
-                    {
-                        if (!layerMode)
-                        {
-                            loopOnlyBuffer.addFrom(ch, 0, layerBuffer, ch, 0, numSamples);
-                        }
-                        else
-                        {
-                            // Layer mode PLAYBACK: complete override
-                            loopOnlyBuffer.copyFrom(ch, 0, layerBuffer, ch, 0, numSamples);
-                        }
-                    }
-                }
-                else
-                {
-                    // Recording/overdubbing: the layer buffer contains input + loop playback mixed
-                    // We need to subtract input to get just the loop portion for degrading
-                    // Actually, during recording the loop portion IS the input being written
-                    // During overdubbing, the layer outputs existing loop + input
-                    // For Blooper-style: we want to degrade existing loop content, not new input
-                    // So we read the existing content BEFORE it's mixed with input
-
-                    // For overdubbing, processBlock already outputs existingLoop + input
-                    // We need the existing loop part only. Let's get it by subtracting input.
-                    //
-                    // IMPORTANT for Layer mode bounce: layerBuffer = existingLoop + (input + bounce)
-                    // We must subtract BOTH input AND bounce to get just existing loop content
-                    // Otherwise the bounce audio (prior layers) leaks into loopOnlyBuffer and gets
-                    // re-added in PluginProcessor, causing volume doubling at recording start
-                    for (int ch = 0; ch < numChannels; ++ch)
-                    {
-                        const float* layerData = layerBuffer.getReadPointer(ch);
-                        const float* inputData = inputBuffer.getReadPointer(ch);
-                        float* loopOnlyData = loopOnlyBuffer.getWritePointer(ch);
-                        for (int s = 0; s < numSamples; ++s)
-                        {
-                            float loopPortion = layerData[s] - inputData[s];
-
-                            // In Layer mode with bounce, also subtract the bounce audio
-                            // to prevent it from appearing in loopOnlyBuffer
-                            if (layerMode && shouldBounce && i == recordingLayerIndex && bounceBuffer.getNumSamples() > 0)
-                            {
-                                loopPortion -= bounceBuffer.getSample(ch, s);
-                            }
-
-                            // Layer mode: override (recording layer has full content baked in)
-                            // Track mode: additive (sum all layers)
-                            if (layerMode)
-                                loopOnlyData[s] = loopPortion;
-                            else
-                                loopOnlyData[s] += loopPortion;
-                        }
-                    }
-                }
-            }
+            mixMeters[static_cast<size_t>(numMixSources)].reset();
+            mixSourceLayers[numMixSources++] = i;
 
             if (layers[i].getState() != LoopBuffer::State::Idle)
-            {
                 anyPlaying = true;
-            }
-        }
-
-        // LAYER MODE BOUNCE: Add bounce to loopOnlyBuffer for effects processing only
-        // The main buffer already has bounce via the recording layer's output (input+bounce),
-        // so we do NOT add bounceBuffer to buffer again - that would cause double summing.
-        // We only need bounce in loopOnlyBuffer so effects (degrade, reverb) apply to prior layers' audio.
-        if (layerMode && shouldBounce && bounceBuffer.getNumSamples() > 0)
-        {
-            // Only add to loopOnlyBuffer for effects processing
-            for (int ch = 0; ch < numChannels; ++ch)
-            {
-                loopOnlyBuffer.addFrom(ch, 0, bounceBuffer, ch, 0, numSamples);
-            }
         }
 
         // If nothing is playing/recording, pass through input
         // Also add input if we have playback but no recording (for monitoring during playback)
+        auto inputMode = OutputMixKernel::InputMode::None;
         if (!anyPlaying && highestLayer == 0 && !layers[0].hasContent())
-        {
-            buffer.makeCopyOf(inputBuffer);
-            // No loop content, so loopOnlyBuffer stays empty (just input passthrough)
-        }
+            inputMode = OutputMixKernel::InputMode::Replace;  // loopOnlyBuffer stays empty
         else if (anyPlaying && !inputAddedToOutput)
-        {
-            // Playback-only mode: add input for monitoring
-            for (int ch = 0; ch < numChannels; ++ch)
-            {
-                buffer.addFrom(ch, 0, inputBuffer, ch, 0, numSamples);
-            }
-        }
+            inputMode = OutputMixKernel::InputMode::Add;
+
+        // LAYER MODE BOUNCE: bounce goes into loopOnlyBuffer for effects processing only.
+        // The main buffer already has it via the recording layer's output (input+bounce).
+        const bool addBounceToLoop = layerMode && shouldBounce;
 
-        // Measure pre-clip peak levels and count clip events for diagnostics
         float peakPreClipL = 0.0f;
         float peakPreClipR = 0.0f;
+        float peakLoopL = 0.0f;
+        float peakLoopR = 0.0f;
         int clipsThisBlock = 0;
 
         for (int ch = 0; ch < numChannels; ++ch)
         {
-            const float* channelData = buffer.getReadPointer(ch);
-            float& peak = (ch == 0) ? peakPreClipL : peakPreClipR;
-            for (int i = 0; i < numSamples; ++i)
+            std::array<OutputMixKernel::Source, NUM_LAYERS> sources;
+            for (int n = 0; n < numMixSources; ++n)
             {
-                float absVal = std::abs(channelData[i]);
-                if (absVal > peak) peak = absVal;
-                if (absVal > 1.0f) clipsThisBlock++;
+                const int i = mixSourceLayers[n];
+                const auto& plan = layerPlans[i];
+                auto& source = sources[static_cast<size_t>(n)];
+                source.data = layerOutputs[i].getReadPointer(ch);
+                source.mixed = !plan.skipOutputMixing;
+                source.loopPortion = !plan.feedInput ? OutputMixKernel::LoopPortion::Whole
+                                   : plan.feedBounce ? OutputMixKernel::LoopPortion::MinusInputAndBounce
+                                                     : OutputMixKernel::LoopPortion::MinusInput;
+            }
+
+            const auto result = OutputMixKernel::mixChannel(
+                sources.data(), mixMeters.data(), numMixSources,
+                layerMode ? OutputMixKernel::MixMode::Override : OutputMixKernel::MixMode::Sum,
+                inputMode, inputBuffer.getReadPointer(ch), bounceBuffer.getReadPointer(ch), addBounceToLoop,
+                buffer.getWritePointer(ch), loopOnlyBuffer.getWritePointer(ch), numSamples);
+
+            float& peakPreClip = (ch == 0) ? peakPreClipL : peakPreClipR;
+            float& peakLoop = (ch == 0) ? peakLoopL : peakLoopR;
+            peakPreClip = std::max(peakPreClip, result.outputPeak);
+            peakLoop = std::max(peakLoop, result.loopPeak);
+            clipsThisBlock += result.outputClips;
+        }
+
+        for (int n = 0; n < numMixSources; ++n)
+        {
+            const int i = mixSourceLayers[n];
+            const auto& meter = mixMeters[static_cast<size_t>(n)];
+
+            // Per-layer clip counts for diagnostics
+            if (const int layerClips = meter.clips(); layerClips > 0)
+                layerClipCounts[i].fetch_add(layerClips);
+
+            // Update layer peak level with decay (for VU meter smoothing)
+            // This is called once per audio block, not per sample
+            // At 44.1kHz with 512 sample blocks, we get ~86 blocks/sec
+            // Decay of 0.9 per block = ~300ms time constant (reaches 10% after ~20 blocks)
+            const float layerPeak = meter.peak();
+            float currentPeak = layerPeakLevels[i].load();
+            if (layerPeak > currentPeak) {
+                layerPeakLevels[i].store(layerPeak);  // Attack: immediate
+            } else {
+                // Decay per block: 0.9 = fast meter response, 0.95 = slower/smoother
+                layerPeakLevels[i].store(currentPeak * 0.92f);
             }
         }
 
@@ -1470,34 +1478,11 @@ public:
         if (clipsThisBlock > 0)
             clipEventCount.fetch_add(clipsThisBlock);
 
-        // Also measure loop-only peak levels
-        float peakLoopL = 0.0f;
-        float peakLoopR = 0.0f;
-        for (int ch = 0; ch < numChannels; ++ch)
-        {
-            const float* data = loopOnlyBuffer.getReadPointer(ch);
-            float& peak = (ch == 0) ? peakLoopL : peakLoopR;
-            for (int i = 0; i < numSamples; ++i)
-            {
-                float absVal = std::abs(data[i]);
-                if (absVal > peak) peak = absVal;
-            }
-        }
         float curLoopL = loopOutputPeakL.load();
         float curLoopR = loopOutputPeakR.load();
         loopOutputPeakL.store(peakLoopL > curLoopL ? peakLoopL : curLoopL * 0.99f);
         loopOutputPeakR.store(peakLoopR > curLoopR ? peakLoopR : curLoopR * 0.99f);
 
-        // Soft clip the mixed output
-        for (int ch = 0; ch < numChannels; ++ch)
-        {
-            float* channelData = buffer.getWritePointer(ch);
-            for (int i = 0; i < numSamples; ++i)
-            {
-                channelData[i] = softClip(channelData[i]);
-            }
-        }
-
         // Apply anti-click ducking at loop boundaries
         // BEFORE the boundary: fade OUT as we approach
         // AFTER the boundary: fade IN as we move away
@@ -1508,10 +1493,8 @@ public:
         if (xfadeDebugCounter >= 500)  // Log every ~500 blocks (~10ms)
         {
             xfadeDebugCounter = 0;
-            DBG("*** XFADE CHECK: loopLen=" + juce::String(masterLoopLength) +
-                " content=" + juce::String(layers[0].hasContent() ? 1 : 0) +
-                " state=" + juce::String(static_cast<int>(layers[0].getState())) +
-                " highest=" + juce::String(highestLayer));
+            audioLog.log(AudioLog::Event::CrossfadeCheck, -1, masterLoopLength, layers[0].hasContent() ? 1 : 0,
+                         static_cast<int>(layers[0].getState()), highestLayer);
         }
 
         if (masterLoopLength > 0 && layers[0].hasContent())
@@ -1548,6 +1531,7 @@ public:
 
             if (loopWrapped)
             {
+                loopBoundaryThisBlock = true;
                 antiClickCountdown = postSamples;
                 approachingBoundary = false;
                 // Snapshot the smear write position for playback
@@ -1583,16 +1567,11 @@ public:
             lastMasterPlayheadPos = currentMasterPos;
 
             // DEBUG: Log position periodically
-            static int debugCounter = 0;
-            if (++debugCounter >= 1000)  // Log every ~1000 blocks
+            if (++crossfadeZoneDebugCounter >= 1000)  // Log every ~1000 blocks
             {
-                debugCounter = 0;
-                DBG("XFADE DEBUG: pos=" + juce::String(currentMasterPos, 3) +
-                    " preThreshold=" + juce::String(preThreshold, 3) +
-                    " inPre=" + juce::String(inPreBoundaryZone ? 1 : 0) +
-                    " countdown=" + juce::String(antiClickCountdown) +
-                    " filterFreq=" + juce::String(filterFreq, 0) +
-                    " filterMix=" + juce::String(filterMix, 2));
+                crossfadeZoneDebugCounter = 0;
+                audioLog.log(AudioLog::Event::CrossfadeZone, -1, currentMasterPos, preThreshold, inPreBoundaryZone ? 1 : 0,
+                             antiClickCountdown, filterFreq, filterMix);
             }
 
             // Calculate effect strength based on where we are
@@ -1778,9 +1757,11 @@ public:
             }
         }
 
-        // Process incremental flatten if one is in progress
-        // This spreads the flatten work across multiple audio blocks for seamless operation
-        processIncrementalFlatten();
+        // Finish an ADD+ stop requested from the message thread
+        processAdditiveStop();
+
+        // Capture/collect background renders (flatten, export)
+        processRenderJobs();
     }
 
     // State getters
@@ -1974,6 +1955,20 @@ public:
     float getInputLevelL() const { return inputLevelL.load(); }
     float getInputLevelR() const { return inputLevelR.load(); }
 
+    // Master clock: layer 0's fixed-point phase. New layers copy it exactly, so layers
+    // advancing at the same rate never drift apart.
+    LoopPhase getMasterPhase() const { return layers[0].getRawPlayhead(); }
+
+    // Loop storage memory (leased from the process-wide LoopMemoryManager)
+    size_t getLoopMemoryBytes() const { return chunkPool.getBytesAllocated(); }
+    bool isLoopMemoryExhausted() const { return chunkPool.isBudgetExhausted(); }
+    LoopMemoryManager& getLoopMemoryManager() { return chunkPool.getMemoryManager(); }
+
+    // Pitch shifters prepared / currently leased by layers / times a layer found none free
+    int getNumPitchShifters() const { return pitchShifterPool.getNumShifters(); }
+    int getNumLeasedPitchShifters() const { return pitchShifterPool.getNumLeased(); }
+    int getPitchShifterLeaseMisses() const { return pitchShifterPool.getLeaseMissCount(); }
+
     // Diagnostic metering getters for debugging audio issues
     float getPreClipPeakL() const { return preClipPeakL.load(); }
     float getPreClipPeakR() const { return preClipPeakR.load(); }
@@ -2070,7 +2065,6 @@ public:
     void setAdditiveModeEnabled(bool enabled)
     {
         additiveModeEnabled.store(enabled);
-        DBG("ADD+ MODE: " + juce::String(enabled ? "ENABLED" : "DISABLED"));
 
         // If disabling while actively capturing, stop capture
         if (!enabled && additiveRecordingActive.load())
@@ -2097,19 +2091,33 @@ public:
         return layerModeEnabled.load();
     }
 
+    // Parallel layer rendering: independent layers render concurrently on layerWorkers
+    // (real-time threads shared by every engine in the process). Output is identical either
+    // way - the mix still happens in layer order on the audio thread. No effect without
+    // spare cores, or while another engine's batch holds the workers.
+    void setParallelLayerRendering(bool enabled)
+    {
+        parallelLayerRendering.store(enabled);
+        DBG("PARALLEL LAYERS: " + juce::String(enabled ? "ON" : "OFF")
+            + " (" + juce::String(layerWorkers->getNumWorkers()) + " workers)");
+    }
+
+    bool isParallelLayerRendering() const
+    {
+        return parallelLayerRendering.load();
+    }
+
     // Start additive capture (called when DUB is pressed while ADD+ mode is ON)
     // If already capturing, this creates a NEW override layer on top
     void startAdditiveCapture()
     {
         if (!additiveModeEnabled.load())
         {
-            DBG("ADD+ CAPTURE: Cannot start - ADD+ mode not enabled");
             return;
         }
 
         if (masterLoopLength <= 0 || !hasContent())
         {
-            DBG("ADD+ CAPTURE: Cannot start - no loop content");
             return;
         }
 
@@ -2118,32 +2126,35 @@ public:
         {
             // Force create a new layer for the NEXT capture cycle
             additiveCreateNewLayer = true;
-            DBG("ADD+ CAPTURE: Will create NEW override layer on next boundary");
             return;
         }
 
-        // Allocate capture buffer if needed
-        if (additiveCaptureBuffer.getNumSamples() < masterLoopLength)
-        {
-            additiveCaptureBuffer.setSize(2, masterLoopLength);
-        }
-        additiveCaptureBuffer.clear();
+        // additiveCaptureStorage is already clean: the audio thread releases it after every
+        // commit and when a capture stops
         additiveCaptureWritePos = 0;
         additiveNeedsReprint = false;
         additiveCreateNewLayer = true;  // First capture always creates new layer
         additiveTargetLayer = -1;       // No target yet
 
         additiveRecordingActive.store(true);
-        DBG("ADD+ CAPTURE: Started capturing effected output");
     }
 
     // Stop additive capture (called when DUB ends while in ADD+ mode)
+    // The final commit touches layer storage, so it is left to the audio thread
     void stopAdditiveCapture()
     {
         if (!additiveRecordingActive.load())
             return;
 
         additiveRecordingActive.store(false);
+        additiveStopPending.store(true);
+    }
+
+    // Audio thread: finish a stop requested by stopAdditiveCapture()
+    void processAdditiveStop()
+    {
+        if (!additiveStopPending.exchange(false))
+            return;
 
         // If we have enough captured, update/create the override layer now
         if (additiveCaptureWritePos >= masterLoopLength)
@@ -2151,11 +2162,12 @@ public:
             updateOrCreateOverrideLayer();
         }
 
+        additiveCaptureStorage.release();
+        additiveCapturePeaks.reset();
         additiveNeedsReprint = false;
         additiveCaptureWritePos = 0;
         additiveTargetLayer = -1;
         additiveCreateNewLayer = false;
-        DBG("ADD+ CAPTURE: Stopped");
     }
 
     // Called from processBlock when loop boundary is crossed
@@ -2169,24 +2181,24 @@ public:
         {
             updateOrCreateOverrideLayer();
 
-            // Reset for next cycle if still capturing
-            additiveCaptureBuffer.clear();
+            // Start the next cycle in the storage the layer just handed back
             additiveCaptureWritePos = 0;
-            DBG("ADD+ BOUNDARY: Updated override layer, starting new capture cycle");
         }
     }
 
     // Update existing override layer OR create new one based on additiveCreateNewLayer flag
+    // O(1): the capture storage (already soft clipped, waveform summary kept current) is
+    // swapped with the layer's, and the layer's old audio is released for the next cycle
     void updateOrCreateOverrideLayer()
     {
         if (additiveCaptureWritePos < masterLoopLength)
         {
-            DBG("ADD+ UPDATE: Not enough captured audio");
+            audioLog.log(AudioLog::Event::AdditiveLayerSkipped, -1, additiveCaptureWritePos, masterLoopLength);
             return;
         }
 
         // Get current playback state
-        const float savedPlayhead = layers[0].getRawPlayhead();
+        const LoopPhase savedPlayhead = getMasterPhase();
         const LoopBuffer::State savedState = layers[0].getState();
 
         if (additiveCreateNewLayer || additiveTargetLayer < 0)
@@ -2194,8 +2206,7 @@ public:
             // Create NEW override layer
             if (highestLayer >= NUM_LAYERS - 1)
             {
-                DBG("ADD+ CREATE: Max layers reached, overwriting top layer instead");
-                // Overwrite the top layer instead
+                // Max layers reached - overwrite the top layer instead
                 additiveTargetLayer = highestLayer;
             }
             else
@@ -2204,20 +2215,20 @@ public:
                 highestLayer = newLayerIdx;
                 currentLayer = newLayerIdx;
                 additiveTargetLayer = newLayerIdx;
-                DBG("ADD+ CREATE: Created new override layer " + juce::String(newLayerIdx + 1));
             }
             additiveCreateNewLayer = false;  // Only create once per DUB press
         }
 
-        // Update the target layer with captured audio
-        layers[additiveTargetLayer].setFromBufferSeamless(additiveCaptureBuffer, masterLoopLength, savedPlayhead, savedState);
+        // Swap the captured loop into the target layer
+        additiveCapturePeaks.flush();
+        layers[additiveTargetLayer].adoptRenderedAudio(additiveCaptureStorage, additiveCapturePeaks,
+                                                       masterLoopLength, savedPlayhead, savedState);
         layers[additiveTargetLayer].setLayerType(LoopBuffer::LayerType::Override);
-        layers[additiveTargetLayer].applyBufferSoftClip();
+        additiveCaptureStorage.release();
+        additiveCapturePeaks.reset();
 
         currentLayer = additiveTargetLayer;
-
-        DBG("ADD+ UPDATE: Updated override layer " + juce::String(additiveTargetLayer + 1) +
-            " with " + juce::String(masterLoopLength) + " samples");
+        audioLog.log(AudioLog::Event::AdditiveLayerCommitted, additiveTargetLayer, masterLoopLength);
     }
 
     bool isAdditiveRecordingActive() const
@@ -2226,31 +2237,52 @@ public:
     }
 
     // Called from PluginProcessor after effects chain to capture effected audio
+    // Soft clips the block into additiveScratch, then copies it into the capture storage at
+    // the playhead-synced position as at most two spans (before and after the loop wrap)
     void captureForAdditive(const juce::AudioBuffer<float>& buffer, int numSamples)
     {
         if (!additiveRecordingActive.load() || masterLoopLength <= 0)
             return;
 
-        // Ensure buffer is allocated
-        if (additiveCaptureBuffer.getNumSamples() < masterLoopLength)
-            return;
-
         const int numChannels = std::min(buffer.getNumChannels(), 2);
+        numSamples = std::min(numSamples, additiveScratch.getNumSamples());
 
         // Get the current playhead position to sync capture with playback
-        int playheadSamples = static_cast<int>(layers[0].getRawPlayhead());
+        int playheadSamples = getMasterPhase().index();
         if (playheadSamples < 0) playheadSamples = 0;
         if (playheadSamples >= masterLoopLength) playheadSamples = playheadSamples % masterLoopLength;
 
-        // Write to capture buffer at playhead-synced position
-        for (int i = 0; i < numSamples; ++i)
+        // Soft clip here rather than over the whole loop at commit (it's per-sample anyway)
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* dest = additiveScratch.getWritePointer(ch);
+            std::copy(buffer.getReadPointer(ch), buffer.getReadPointer(ch) + numSamples, dest);
+            OutputMixKernel::softClipBlock(dest, numSamples);
+        }
+
+        // A block longer than the loop only keeps its last masterLoopLength samples
+        int srcOffset = 0;
+        int remaining = numSamples;
+        int writePos = playheadSamples;
+        if (remaining > masterLoopLength)
+        {
+            srcOffset = remaining - masterLoopLength;
+            writePos = (playheadSamples + srcOffset) % masterLoopLength;
+            remaining = masterLoopLength;
+        }
+
+        while (remaining > 0)
         {
-            int writePos = (playheadSamples + i) % masterLoopLength;
+            const int span = std::min(remaining, masterLoopLength - writePos);
             for (int ch = 0; ch < numChannels; ++ch)
-            {
-                additiveCaptureBuffer.setSample(ch, writePos, buffer.getSample(ch, i));
-            }
+                additiveCaptureStorage.copyFrom(ch, writePos, additiveScratch.getReadPointer(ch, srcOffset), span);
+            additiveCapturePeaks.markWrittenRange(writePos, span);
+
+            srcOffset += span;
+            remaining -= span;
+            writePos = 0;  // Wrapped
         }
+        additiveCapturePeaks.flush();
 
         // Track total samples captured
         additiveCaptureWritePos += numSamples;
@@ -2258,7 +2290,9 @@ public:
 
     // Flatten all non-muted layers into layer 0
     // Sums all active layer buffers into layer 0 and clears the others
-    // SEAMLESS: processes incrementally during audio callbacks to avoid audio dropouts
+    // SEAMLESS: rendered by the LayerRenderService workers from a snapshot of the layers,
+    // then swapped into layer 0 at the next loop boundary - the audio thread only pays
+    // for the snapshot and the O(1) swap
     // NOW APPLIES ALL PER-LAYER EFFECTS: volume, pan, EQ, pitch shift, reverse, loop bounds
     void flattenLayers()
     {
@@ -2267,135 +2301,146 @@ public:
 
         if (!hasLayers)
         {
-            DBG("flattenLayers() - Nothing to flatten");
             return;
         }
 
         if (highestLayer == 0)
         {
-            DBG("flattenLayers() - Only one layer, nothing to flatten");
             return;
         }
 
         // Don't start a new flatten if one is already in progress
-        if (flattenInProgress.load())
-        {
-            DBG("flattenLayers() - Flatten already in progress, ignoring");
-            return;
-        }
-
-        DBG("flattenLayers() - Requesting flatten of " + juce::String(highestLayer + 1) + " layers");
+        if (!renderService.request(LayerRenderService::Kind::Flatten))
+            audioLog.log(AudioLog::Event::FlattenBusy, -1, highestLayer);
+    }
 
-        // Capture current playback state BEFORE modifying anything
-        flattenSavedPlayhead = layers[0].getRawPlayhead();
-        flattenSavedState = layers[0].getState();
-        flattenSavedHighestLayer = highestLayer;
+    bool isFlattenInProgress() const
+    {
+        return !renderService.isIdle(LayerRenderService::Kind::Flatten);
+    }
 
-        // Initialize staging buffer
-        flattenStagingBuffer.setSize(2, masterLoopLength, false, true, false);
-        flattenStagingBuffer.clear();
+    // Service render jobs from the audio thread (end of processBlock):
+    // capture requested snapshots, and take finished results
+    void processRenderJobs()
+    {
+        using Kind = LayerRenderService::Kind;
 
-        // Reset processing state
-        flattenCurrentLayer = 0;
-        flattenCurrentSample = 0;
+        if (auto* job = renderService.takeRequest(Kind::Flatten))
+        {
+            if (captureLayersForRender(*job))
+                audioLog.log(AudioLog::Event::FlattenStarted, -1, job->numLayers);
+        }
 
-        // Request flatten to begin during processBlock
-        flattenRequested.store(true);
-    }
+        if (auto* job = renderService.takeRequest(Kind::Export))
+            captureLayersForRender(*job);
 
-    // Process incremental flatten during audio callback
-    // Called from processBlock - processes a chunk of the flatten operation each audio block
-    // Returns true when flatten is complete
-    void processIncrementalFlatten()
-    {
-        // Check if flatten was requested
-        if (flattenRequested.load() && !flattenInProgress.load())
+        // The flattened loop replaces the layers at a loop boundary so the swap lands where
+        // the loop restarts anyway (immediately when nothing is playing)
+        if (renderService.getStage(Kind::Flatten) == LayerRenderService::Stage::Done)
         {
-            flattenInProgress.store(true);
-            flattenRequested.store(false);
-            DBG("processIncrementalFlatten() - Starting flatten, " + juce::String(flattenSavedHighestLayer + 1) + " layers");
+            const auto state = layers[0].getState();
+            const bool audible = state == LoopBuffer::State::Playing || state == LoopBuffer::State::Overdubbing;
+            if (loopBoundaryThisBlock || !audible)
+                completeFlatten(renderService.getJob(Kind::Flatten));
         }
 
-        if (!flattenInProgress.load())
-            return;
+        processPlaybackCacheJobs();
+    }
 
-        // Process a chunk of samples this block
-        // We process enough to complete flatten within a reasonable time (~10-50ms)
-        // but not so much that it causes audio dropouts
-        const int samplesPerChunk = 4096;  // Process 4096 samples per block call
-        int samplesProcessed = 0;
+    // Per-layer playback caches: install finished renders (the layer ignores stale ones),
+    // flag running renders whose layer moved on, and start a render for layers whose
+    // pitch/EQ/reverse settings have settled
+    void processPlaybackCacheJobs()
+    {
+        using Stage = LayerRenderService::Stage;
 
-        while (samplesProcessed < samplesPerChunk && flattenCurrentLayer <= flattenSavedHighestLayer)
+        for (int i = 0; i < NUM_LAYERS; ++i)
         {
-            // Skip muted or empty layers
-            if (layers[flattenCurrentLayer].getMuted() || !layers[flattenCurrentLayer].hasContent())
+            auto& job = renderService.getCacheJob(i);
+            const Stage stage = job.stage.load(std::memory_order_acquire);
+
+            if (stage == Stage::Done)
             {
-                flattenCurrentLayer++;
-                flattenCurrentSample = 0;
-                continue;
+                if (!job.cancelled)
+                    layers[i].installPlaybackCache(job.result, job.render.key, job.failed);
+                renderService.finishCache(job);
             }
-
-            // Process this layer in chunks
-            int samplesRemaining = masterLoopLength - flattenCurrentSample;
-            int samplesToProcess = std::min(samplesPerChunk - samplesProcessed, samplesRemaining);
-
-            if (samplesToProcess > 0)
+            else if (stage == Stage::Rendering)
             {
-                // Use addToBufferWithEffects but only for a portion
-                // Since addToBufferWithEffects processes the whole buffer, we need a different approach
-                // We'll process the layer in full but only once
-                if (flattenCurrentSample == 0)
-                {
-                    // Process entire layer at once (simpler, still fast enough for most loops)
-                    layers[flattenCurrentLayer].addToBufferWithEffects(flattenStagingBuffer, currentSampleRate);
-                    flattenCurrentSample = masterLoopLength;  // Mark as complete
-                    samplesProcessed += masterLoopLength;
-                }
+                // Settings or audio moved on - the worker abandons it at its next block
+                if (!layers[i].isPlaybackCacheKeyCurrent(job.render.key))
+                    job.stale.store(true, std::memory_order_relaxed);
+            }
+            else if (stage == Stage::Idle && layers[i].wantsPlaybackCache())
+            {
+                layers[i].capturePlaybackCache(job.audio, job.render);
+                renderService.submitCache(job);
             }
+        }
+    }
 
-            // Move to next layer if this one is done
-            if (flattenCurrentSample >= masterLoopLength)
+    // Snapshot every audible layer into a captured job and submit it (audio thread).
+    // O(layers x chunks) - chunk references and parameters only, no audio is copied.
+    bool captureLayersForRender(LayerRenderService::Job& job)
+    {
+        job.length = masterLoopLength;
+        job.tag = highestLayer;
+        job.numLayers = 0;
+        for (int i = 0; i < NUM_LAYERS; ++i)
+            job.contentVersions[static_cast<size_t>(i)] = layers[i].getContentVersion();
+
+        if (masterLoopLength > 0)
+        {
+            for (int i = 0; i <= highestLayer; ++i)
             {
-                DBG("  Flatten: completed layer " + juce::String(flattenCurrentLayer + 1));
-                flattenCurrentLayer++;
-                flattenCurrentSample = 0;
+                if (layers[i].getMuted() || !layers[i].hasContent())
+                    continue;
+
+                auto& snapshot = job.layers[static_cast<size_t>(job.numLayers++)];
+                layers[i].captureForRender(snapshot.audio, snapshot.params, currentSampleRate);
             }
         }
 
-        // Check if flatten is complete
-        if (flattenCurrentLayer > flattenSavedHighestLayer)
+        if (job.numLayers == 0)
         {
-            completeFlatten();
+            renderService.cancelCapture(job);
+            return false;
         }
+
+        renderService.submit(job);
+        return true;
     }
 
-    // Finish the flatten operation - called when all layers have been processed
-    void completeFlatten()
+    // Finish the flatten operation - the render is done, swap it in
+    void completeFlatten(LayerRenderService::Job& job)
     {
-        DBG("completeFlatten() - Finalizing flatten");
+        // The loop was re-recorded, cleared, overdubbed or memory ran out while rendering -
+        // the result is stale (swapping it in would throw away the newer audio)
+        bool stale = job.failed || job.length != masterLoopLength || !layers[0].hasContent();
+        for (int i = 0; i < NUM_LAYERS && !stale; ++i)
+            stale = job.contentVersions[static_cast<size_t>(i)] != layers[i].getContentVersion();
 
-        // Soft clip the summed buffer to prevent clipping
-        for (int ch = 0; ch < 2; ++ch)
+        if (stale)
         {
-            float* data = flattenStagingBuffer.getWritePointer(ch);
-            for (int s = 0; s < masterLoopLength; ++s)
-            {
-                data[s] = softClip(data[s]);
-            }
+            audioLog.log(AudioLog::Event::FlattenAborted, -1, job.length);
+            renderService.finish(job);
+            return;
         }
 
-        // Clear layers 1+ (not layer 0 yet - we'll replace its buffer in place)
+        // Clear layers 1+ (not layer 0 - it adopts the rendered audio below)
         for (int i = 1; i < NUM_LAYERS; ++i)
         {
             layers[i].clear();
         }
 
         // Get current playhead position to maintain seamless playback
-        const float currentPlayhead = layers[0].getRawPlayhead();
+        const LoopPhase currentPlayhead = getMasterPhase();
         const LoopBuffer::State currentState = layers[0].getState();
 
-        // Replace layer 0's buffer content in-place while preserving playback state
-        layers[0].setFromBufferSeamless(flattenStagingBuffer, masterLoopLength, currentPlayhead, currentState);
+        // Swap the rendered chunk table into layer 0 while preserving playback state;
+        // finish() then drops layer 0's old audio (released by the pool's maintenance thread)
+        layers[0].adoptRenderedAudio(job.result, job.resultPeaks, job.length, currentPlayhead, currentState);
+        renderService.finish(job);
 
         // Reset all layer settings to default (effects are now baked into the audio)
         for (int i = 0; i < NUM_LAYERS; ++i)
@@ -2411,18 +2456,13 @@ public:
             layers[i].setLoopStart(0.0f);   // Full loop
             layers[i].setLoopEnd(1.0f);
         }
+        updatePitchShifterDemand();  // Pitch is baked in - hand the layers' shifters back
 
         // Reset state
         currentLayer = 0;
         highestLayer = 0;
 
-        // Mark flatten as complete
-        flattenInProgress.store(false);
-
-        // Clear staging buffer to free memory
-        flattenStagingBuffer.setSize(0, 0);
-
-        DBG("completeFlatten() - Complete, layer 0 now contains flattened audio with all effects baked in");
+        audioLog.log(AudioLog::Event::FlattenComplete);
     }
 
     // ============================================
@@ -2431,40 +2471,69 @@ public:
 
     // Render all layers to a buffer (for export, doesn't modify state)
     // Returns the rendered buffer, or empty buffer if no content
-    juce::AudioBuffer<float> renderMixToBuffer() const
+    // Message thread: the audio thread snapshots the layers at its next block and the
+    // render service renders them, so the export never races the audio thread's writes.
+    // If the audio thread isn't running the snapshot is never taken and the export fails
+    // (reading the layers here could race an audio thread that is merely late).
+    juce::AudioBuffer<float> renderMixToBuffer()
     {
+        using Kind = LayerRenderService::Kind;
+        using Stage = LayerRenderService::Stage;
+
         if (masterLoopLength <= 0 || !hasContent())
         {
             return juce::AudioBuffer<float>();
         }
 
-        // Create output buffer
-        juce::AudioBuffer<float> mixBuffer(2, masterLoopLength);
-        mixBuffer.clear();
+        // Left over from an export that timed out
+        if (renderService.getStage(Kind::Export) == Stage::Done)
+            renderService.finish(renderService.getJob(Kind::Export));
 
-        // Sum all non-muted layers with their effects
-        for (int i = 0; i <= highestLayer; ++i)
+        if (!renderService.request(Kind::Export))
+            return juce::AudioBuffer<float>();  // Another export is still rendering
+
+        const auto startMs = juce::Time::getMillisecondCounter();
+        for (;;)
         {
-            if (layers[i].getMuted() || !layers[i].hasContent())
-                continue;
+            const Stage stage = renderService.getStage(Kind::Export);
+            const auto elapsedMs = juce::Time::getMillisecondCounter() - startMs;
 
-            layers[i].addToBufferWithEffects(mixBuffer, currentSampleRate);
-        }
+            if (stage == Stage::Done)
+            {
+                auto& job = renderService.getJob(Kind::Export);
+                if (job.failed)
+                {
+                    renderService.finish(job);
+                    DBG("renderMixToBuffer() - Memory budget ran out");
+                    return juce::AudioBuffer<float>();
+                }
 
-        // Apply soft clipping to prevent clipping
-        for (int ch = 0; ch < 2; ++ch)
-        {
-            float* data = mixBuffer.getWritePointer(ch);
-            for (int s = 0; s < masterLoopLength; ++s)
+                juce::AudioBuffer<float> mixBuffer(std::move(job.mix));
+                renderService.finish(job);
+
+                DBG("renderMixToBuffer() - Rendered " + juce::String(job.numLayers) +
+                    " layers, " + juce::String(mixBuffer.getNumSamples()) + " samples");
+                return mixBuffer;
+            }
+
+            if (stage == Stage::Idle)
+                return juce::AudioBuffer<float>();  // Nothing audible to render
+
+            if (stage == Stage::Requested && elapsedMs > EXPORT_SNAPSHOT_TIMEOUT_MS
+                && renderService.cancelRequest(Kind::Export))
             {
-                data[s] = softClip(data[s]);
+                DBG("renderMixToBuffer() - Audio thread didn't take the snapshot");
+                return juce::AudioBuffer<float>();
             }
-        }
 
-        DBG("renderMixToBuffer() - Rendered " + juce::String(highestLayer + 1) +
-            " layers, " + juce::String(masterLoopLength) + " samples");
+            if (elapsedMs > EXPORT_RENDER_TIMEOUT_MS)
+            {
+                DBG("renderMixToBuffer() - Render timed out");
+                return juce::AudioBuffer<float>();
+            }
 
-        return mixBuffer;
+            juce::Thread::sleep(2);
+        }
     }
 
     // Get the current sample rate (needed for WAV export)
@@ -2480,19 +2549,58 @@ public:
         if (bars <= 0 && beats <= 0)
             return 0;  // Free mode - no limit
 
-        float bpm = hostBpm.load();
-        if (bpm <= 0.0f)
-            bpm = 120.0f;  // Default fallback
-
         // Calculate total beats: bars * 4 + additional beats
         int totalBeats = (bars * 4) + beats;
+        return static_cast<int>(getSamplesPerBeat() * totalBeats);
+    }
 
-        // samples per beat = sampleRate * 60 / BPM
-        double samplesPerBeat = currentSampleRate * 60.0 / static_cast<double>(bpm);
-        return static_cast<int>(samplesPerBeat * totalBeats);
+    // samples per beat = sampleRate * 60 / BPM
+    double getSamplesPerBeat() const
+    {
+        float bpm = hostBpm.load();
+        if (bpm <= 0.0f)
+            bpm = 120.0f;  // Default fallback
+        return currentSampleRate * 60.0 / static_cast<double>(bpm);
     }
 
 private:
+    // Declared before layers so it outlives them (layers return chunks on destruction)
+    LoopChunkPool chunkPool;
+    PitchShifterPool pitchShifterPool;
+    static_assert(PitchShifterPool::MAX_LAYERS >= NUM_LAYERS, "Every layer must be able to lease and switch shifters");
+
+    // Wait-free diagnostics ring for the audio thread (formatted and written off-thread)
+    AudioLog audioLog;
+
+    // UI transport/layer commands, drained at the top of processBlock
+    LoopCommandQueue commandQueue;
+
+    // Commands timestamped on the engine sample clock, earliest first (audio thread)
+    struct ScheduledCommand
+    {
+        LoopCommand command;
+        juce::int64 time = 0;
+    };
+
+    static constexpr int MAX_SCHEDULED_COMMANDS = 32;
+    std::array<ScheduledCommand, MAX_SCHEDULED_COMMANDS> scheduled;
+    int numScheduled = 0;
+    std::atomic<int> numPendingCommands { 0 };
+    std::atomic<LoopCommand::Quantize> transportQuantize { LoopCommand::Quantize::Off };
+
+    juce::int64 blockStartTime = 0;     // Engine sample clock at the start of this block
+    juce::int64 segmentStartTime = 0;   // ... and of the segment being processed
+    juce::int64 recordStartTime = 0;    // When the current recording started
+
+    // Host timeline at the start of the block (set by the processor)
+    bool hostTimelineValid = false;
+    double hostPpq = 0.0;
+    double hostBarStartPpq = 0.0;
+
+    // Flatten/export/ADD+ renders on background workers (snapshots and results borrow pool chunks)
+    LayerRenderService renderService;
+    static_assert(LayerRenderService::MAX_LAYERS >= NUM_LAYERS, "Render snapshots must cover every layer");
+
     std::array<LoopBuffer, NUM_LAYERS> layers;
     int currentLayer = 0;
     int highestLayer = 0;
@@ -2523,9 +2631,9 @@ private:
 
     // Pre-allocated buffers to avoid allocation in processBlock
     juce::AudioBuffer<float> inputBuffer;
-    juce::AudioBuffer<float> layerBuffer;
-    juce::AudioBuffer<float> dummyBuffer;
     juce::AudioBuffer<float> loopOnlyBuffer;  // Loop playback only, no input (for Blooper-style effects)
+    juce::AudioBuffer<float> bounceBuffer;      // Layer mode: audio bounced from the layer below this block
+    juce::AudioBuffer<float> bounceLayerBuffer; // Layer mode: raw playback peeked from the bounce source
 
     // Anti-click ducking state - fades out BEFORE boundary and fades in AFTER
     // This creates a smooth volume envelope that straddles the loop crossing point
@@ -2570,24 +2678,279 @@ private:
     // additiveRecordingActive = actually capturing (mode ON + DUB pressed)
     std::atomic<bool> additiveModeEnabled { false };      // ADD+ mode toggle
     std::atomic<bool> additiveRecordingActive { false };  // Currently capturing
+    std::atomic<bool> additiveStopPending { false };      // Stop requested, final commit pending
     bool additiveNeedsReprint = false;            // True when capture is complete
-    juce::AudioBuffer<float> additiveCaptureBuffer;  // Buffer to capture effected audio
+    LoopStorage additiveCaptureStorage;           // Effected audio being captured - swapped into the override layer
+    WaveformPyramid additiveCapturePeaks;         // Its waveform summary, swapped in alongside
+    juce::AudioBuffer<float> additiveScratch;     // One soft-clipped block on its way into the capture storage
     int additiveCaptureWritePos = 0;              // Tracks total samples captured
     int additiveTargetLayer = -1;                 // Which override layer we're updating (-1 = none)
     bool additiveCreateNewLayer = false;          // If true, next boundary creates NEW override layer
 
-    // Debug counter (member variable to avoid static issues)
+    // Debug counters (member variables to avoid static issues)
     int xfadeDebugCounter = 0;
+    int crossfadeZoneDebugCounter = 0;
+
+    // Export waits: for the audio thread to take its snapshot, then for the render itself
+    static constexpr juce::uint32 EXPORT_SNAPSHOT_TIMEOUT_MS = 500;
+    static constexpr juce::uint32 EXPORT_RENDER_TIMEOUT_MS = 30000;
+
+    // Set when the master playhead wrapped during this block (flatten results swap in here)
+    bool loopBoundaryThisBlock = false;
+
+    // Per-block layer plan, filled in phase 1 of the layer loop in processBlock
+    enum class LayerAction
+    {
+        Skip = 0,   // No content - not processed at all
+        Advance,    // Muted or below an override layer - playhead advances, output discarded
+        Render      // Processed and mixed
+    };
+
+    struct LayerPlan
+    {
+        LayerAction action = LayerAction::Skip;
+        bool feedInput = false;         // Recording/overdubbing: gets the input as its buffer
+        bool feedBounce = false;        // Layer mode bounce target: input + bounce buffer
+        bool applyMuteGain = false;     // Muted or mid mute fade
+        bool skipOutputMixing = false;  // Being bounced - heard through the recording layer
+    };
+
+    std::array<LayerPlan, NUM_LAYERS> layerPlans;
+    std::array<int, NUM_LAYERS> plannedLayers {};     // Indices of non-Skip layers, in order
+    int numPlannedLayers = 0;
+    int blockNumSamples = 0;
+    int blockNumChannels = 0;
+    std::array<juce::AudioBuffer<float>, NUM_LAYERS> layerOutputs;  // One per layer, so renders can overlap
+    std::array<int, NUM_LAYERS> mixSourceLayers {};                  // Rendered layers, in mix order
+    std::array<OutputMixKernel::Meter, NUM_LAYERS> mixMeters;         // Their peak/clip lanes, same order
+
+    std::atomic<bool> parallelLayerRendering { false };
+    juce::SharedResourcePointer<RealtimeWorkerPool> layerWorkers;
+
+    // Audio thread: timestamp a command coming out of the queue and insert it in time order
+    void scheduleCommand(const LoopCommand& command)
+    {
+        // STOP and CLEAR override anything still waiting for its beat. Commands already due
+        // (popped earlier in this drain, unquantized) stay and are applied first, in order.
+        if (command.type == LoopCommand::Type::Stop || command.type == LoopCommand::Type::Clear)
+        {
+            while (numScheduled > 0 && scheduled[static_cast<size_t>(numScheduled - 1)].time > segmentStartTime)
+                --numScheduled;
+        }
+
+        const juce::int64 time = segmentStartTime + samplesUntilQuantized(command);
+
+        if (numScheduled == MAX_SCHEDULED_COMMANDS)
+        {
+            // Make room by applying whatever is already due (they precede this command anyway);
+            // if everything is still waiting for its beat, drop this one rather than reorder
+            applyDueCommands();
+            if (numScheduled == MAX_SCHEDULED_COMMANDS)
+            {
+                audioLog.log(AudioLog::Event::CommandDropped, -1, static_cast<int>(command.type), command.layer);
+                return;
+            }
+        }
+
+        int slot = numScheduled;
+        while (slot > 0 && scheduled[static_cast<size_t>(slot - 1)].time > time)
+        {
+            scheduled[static_cast<size_t>(slot)] = scheduled[static_cast<size_t>(slot - 1)];
+            --slot;
+        }
+        scheduled[static_cast<size_t>(slot)] = { command, time };
+        ++numScheduled;
+    }
+
+    // Audio thread: apply every scheduled command due at or before segmentStartTime
+    void applyDueCommands()
+    {
+        int due = 0;
+        while (due < numScheduled && scheduled[static_cast<size_t>(due)].time <= segmentStartTime)
+            ++due;
+        if (due == 0)
+            return;
+
+        // Take them out first - applying STOP/CLEAR may not touch the ones still waiting
+        std::array<LoopCommand, MAX_SCHEDULED_COMMANDS> dueCommands;
+        for (int i = 0; i < due; ++i)
+            dueCommands[static_cast<size_t>(i)] = scheduled[static_cast<size_t>(i)].command;
+        std::move(scheduled.begin() + due, scheduled.begin() + numScheduled, scheduled.begin());
+        numScheduled -= due;
+
+        for (int i = 0; i < due; ++i)
+            applyCommand(dueCommands[static_cast<size_t>(i)]);
+    }
+
+    // Samples from segmentStartTime until the command's quantization point (0 = now).
+    // The grid comes from, in order: the playing master loop (beats counted from the loop
+    // start, so a quantized overdub or stop lands on the loop's own beats), the first
+    // recording in progress (beats counted from where it started, so a quantized stop
+    // gives exactly getTargetLoopLengthSamples() for that many beats), or the host
+    // timeline. With none of these there is nothing to align to and the command is immediate.
+    juce::int64 samplesUntilQuantized(const LoopCommand& command) const
+    {
+        if (!command.isQuantizable())
+            return 0;
+
+        auto quantize = command.quantize == LoopCommand::Quantize::Default ? transportQuantize.load() : command.quantize;
+        if (quantize == LoopCommand::Quantize::Off || quantize == LoopCommand::Quantize::Default)
+            return 0;
+
+        const double samplesPerBeat = getSamplesPerBeat();
+
+        if (masterLoopLength > 0)
+        {
+            const double grid = quantize == LoopCommand::Quantize::Beat ? samplesPerBeat
+                              : quantize == LoopCommand::Quantize::Bar  ? samplesPerBeat * 4.0
+                                                                        : static_cast<double>(masterLoopLength);
+            const double distance = layers[0].samplesUntilGridLine(grid);
+            if (distance >= 0.0)
+                return static_cast<juce::int64>(std::llround(distance));
+        }
+
+        const int beatsPerUnit = quantize == LoopCommand::Quantize::Beat ? 1 : 4;
+
+        if (masterLoopLength == 0 && getCurrentState() == LoopBuffer::State::Recording)
+        {
+            // Next whole number of units since the recording started, truncated exactly
+            // like getTargetLoopLengthSamples()
+            const juce::int64 elapsed = segmentStartTime - recordStartTime;
+            const double unit = samplesPerBeat * beatsPerUnit;
+            int units = std::max(1, static_cast<int>(std::ceil(static_cast<double>(elapsed) / unit)));
+            juce::int64 length = static_cast<int>(samplesPerBeat * (units * beatsPerUnit));
+            if (length < elapsed)
+                length = static_cast<int>(samplesPerBeat * (++units * beatsPerUnit));
+            return length - elapsed;
+        }
+
+        if (hostTimelineValid)
+        {
+            const double beatsIntoBar = hostPpq - hostBarStartPpq;
+            const double beatsToGo = beatsPerUnit == 1 ? std::ceil(hostPpq) - hostPpq
+                                                       : std::ceil(beatsIntoBar / 4.0) * 4.0 - beatsIntoBar;
+            return static_cast<juce::int64>(std::llround(std::max(0.0, beatsToGo) * samplesPerBeat));
+        }
+
+        return 0;
+    }
+
+    // Audio thread: run one queued UI command, then log what it left behind
+    void applyCommand(const LoopCommand& command)
+    {
+        using Type = LoopCommand::Type;
+        switch (command.type)
+        {
+            case Type::Record:          record(); break;
+            case Type::StopRecording:   stopRecording(command.flag); break;
+            case Type::Play:            play(); break;
+            case Type::Stop:            stop(); break;
+            case Type::Overdub:         overdub(); break;
+            case Type::Undo:            undo(); break;
+            case Type::Redo:            redo(); break;
+            case Type::Clear:           clear(); break;
+            case Type::ClearLayer:      clearLayer(command.layer); break;
+            case Type::DeleteLayer:     deleteLayer(command.layer); break;
+            case Type::JumpToLayer:     jumpToLayer(command.layer); break;
+            case Type::SetLayerMuted:   setLayerMuted(command.layer, command.flag); break;
+            case Type::SetLayerSoloed:  setLayerSoloed(command.layer, command.flag); break;
+            case Type::SetReverse:      setReverse(command.flag); break;
+            case Type::ResetLoopParams: resetLoopParams(); break;
+            case Type::SetAdditiveMode: setAdditiveModeEnabled(command.flag); break;
+            case Type::Flatten:         flattenLayers(); break;
+            case Type::SetLayerLoopStart: setLayerLoopStart(command.layer, command.value); break;
+            case Type::SetLayerLoopEnd:   setLayerLoopEnd(command.layer, command.value); break;
+            case Type::SetLayerReverse:   setLayerReverse(command.layer, command.flag); break;
+        }
+
+        audioLog.log(AudioLog::Event::CommandApplied, -1, static_cast<int>(command.type), command.layer,
+                     command.flag ? 1 : 0, static_cast<int>(getCurrentState()), currentLayer, highestLayer);
+    }
+
+    // Phase 2 of the layer loop in processBlock: one planned layer into layerOutputs[i].
+    // Runs on the audio thread or a layer worker - touches nothing shared but read-only input.
+    void renderLayer(int i)
+    {
+        const auto& plan = layerPlans[i];
+        const int numSamples = blockNumSamples;
+        const int numChannels = blockNumChannels;
+
+        if (plan.action == LayerAction::Advance)
+        {
+            // Fully muted and stable, or below an override layer - its output is thrown
+            // away, so a playing layer only moves its playhead and fade (no reads, no
+            // pitch shifter). Anything else still runs the full block.
+            if (!layers[i].advance(numSamples))
+            {
+                juce::AudioBuffer<float> discard(layerOutputs[i].getArrayOfWritePointers(), numChannels, numSamples);
+                discard.clear();
+                layers[i].processBlock(discard);
+            }
+            // Consume the mute gain value to keep smoother in sync
+            layers[i].getMuteGain();
+            return;
+        }
+
+        // Non-owning view of the preallocated output, exactly numSamples long - the layer
+        // advances by its buffer's length, which has to match what advance() would use
+        juce::AudioBuffer<float> layerBuffer(layerOutputs[i].getArrayOfWritePointers(), numChannels, numSamples);
+
+        if (plan.feedInput)
+        {
+            // Recording/overdubbing layer gets the input
+            // In Layer mode: also include bounced audio from all previous layers (for first loop pass only)
+            for (int ch = 0; ch < numChannels; ++ch)
+                layerBuffer.copyFrom(ch, 0, inputBuffer, ch, 0, numSamples);
+
+            // Layer mode bounce: add previous layers' playback to what we're recording
+            // ONLY for the first loop pass - after that, just record input to prevent volume buildup
+            // NOTE: The bounce is recorded INTO the layer, but for MONITORING during recording
+            // we need to hear it. Since the recording layer's processBlock only outputs what
+            // it has recorded so far (which starts empty), we add bounceBuffer to OUTPUT below.
+            if (plan.feedBounce)
+            {
+                for (int ch = 0; ch < numChannels; ++ch)
+                    layerBuffer.addFrom(ch, 0, bounceBuffer, ch, 0, numSamples);
+            }
+        }
+        else
+        {
+            // Playback layer gets silence as "input" - it will just output loop content
+            layerBuffer.clear();
+        }
+
+        layers[i].processBlock(layerBuffer);
+
+        // Apply smoothed mute gain for click-free muting
+        // This must be done per-sample to get the smooth transition
+        if (plan.applyMuteGain)
+        {
+            // Get pointers for all channels
+            float* channelData[2] = { nullptr, nullptr };
+            for (int ch = 0; ch < numChannels && ch < 2; ++ch)
+                channelData[ch] = layerBuffer.getWritePointer(ch);
+
+            // Apply gain per-sample (smoother advances once per sample, applied to all channels)
+            for (int s = 0; s < numSamples; ++s)
+            {
+                float muteGain = layers[i].getMuteGain();
+                for (int ch = 0; ch < numChannels && ch < 2; ++ch)
+                {
+                    if (channelData[ch])
+                        channelData[ch][s] *= muteGain;
+                }
+            }
+        }
+    }
+
+    static void renderPlannedLayer(void* context, int index)
+    {
+        // Workers are audio-thread code too - the RT-check build traps them the same way
+        LOOPENGINE_AUDIO_THREAD_SCOPE();
+        auto* engine = static_cast<LoopEngine*>(context);
+        engine->renderLayer(engine->plannedLayers[index]);
+    }
 
-    // Incremental flatten state - processes flatten over multiple audio blocks for seamless operation
-    std::atomic<bool> flattenRequested { false };     // True when flatten has been requested
-    std::atomic<bool> flattenInProgress { false };    // True while flatten is being processed
-    juce::AudioBuffer<float> flattenStagingBuffer;   // Buffer being built up during flatten
-    int flattenCurrentLayer = 0;                      // Which layer we're currently processing
-    int flattenCurrentSample = 0;                     // Current sample position in that layer
-    int flattenSavedHighestLayer = 0;                 // Snapshot of highestLayer when flatten started
-    float flattenSavedPlayhead = 0.0f;                // Snapshot of playhead for seamless transition
-    LoopBuffer::State flattenSavedState = LoopBuffer::State::Idle;
 
     LoopBuffer::State getCurrentState() const
     {
@@ -2610,14 +2973,5 @@ private:
         return LoopBuffer::State::Idle;
     }
 
-    static float softClip(float x)
-    {
-        if (x > 1.0f)
-            return 1.0f - std::exp(-(x - 1.0f));
-        else if (x < -1.0f)
-            return -1.0f + std::exp(-(-x - 1.0f));
-        return x;
-    }
-
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoopEngine)
 };
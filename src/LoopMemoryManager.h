@@ -0,0 +1,142 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+/**
+ * LoopMemoryManager - Process-wide budget for loop layer storage
+ *
+ * Every plugin instance in the host process shares one manager (obtained through
+ * juce::SharedResourcePointer), and each LoopChunkPool leases chunk memory from it.
+ * Instead of every instance reserving worst-case storage up front, a session with
+ * many instances only pays for the audio actually recorded, up to a global budget.
+ *
+ * When the budget is exhausted, reserve() fails and the recording layer closes its
+ * loop at the current length instead of allocating past the budget.
+ *
+ * The budget is stored in the user's LoopEngine settings folder so it applies to every
+ * session, with or without an editor open.
+ */
+class LoopMemoryManager
+{
+public:
+    // Per-instance usage record. Owned by the instance's chunk pool.
+    struct Client
+    {
+        std::atomic<juce::int64> bytesInUse { 0 };
+    };
+
+    static constexpr juce::int64 MIN_BUDGET_MB = 64;
+
+    LoopMemoryManager()
+    {
+        // Default: half of physical RAM, overridden by the saved setting if present
+        const juce::int64 physicalMB = static_cast<juce::int64>(juce::SystemStats::getMemorySizeInMegabytes());
+        budgetBytes.store(std::max(MIN_BUDGET_MB, physicalMB / 2) * 1024 * 1024);
+        loadBudgetSetting();
+    }
+
+    // Called from the message thread when a pool is created / destroyed
+    void registerClient(Client* client)
+    {
+        const juce::ScopedLock lock(clientLock);
+        clients.push_back(client);
+    }
+
+    void unregisterClient(Client* client)
+    {
+        const juce::ScopedLock lock(clientLock);
+        clients.erase(std::remove(clients.begin(), clients.end(), client), clients.end());
+    }
+
+    // Lease bytes against the global budget. Lock-free, safe on the audio thread.
+    bool reserve(Client& client, juce::int64 bytes)
+    {
+        juce::int64 current = totalBytesInUse.load();
+        do
+        {
+            if (current + bytes > budgetBytes.load())
+                return false;
+        } while (!totalBytesInUse.compare_exchange_weak(current, current + bytes));
+
+        client.bytesInUse.fetch_add(bytes);
+        return true;
+    }
+
+    void release(Client& client, juce::int64 bytes)
+    {
+        totalBytesInUse.fetch_sub(bytes);
+        client.bytesInUse.fetch_sub(bytes);
+    }
+
+    juce::int64 getBudgetBytes() const { return budgetBytes.load(); }
+    juce::int64 getTotalBytesInUse() const { return totalBytesInUse.load(); }
+
+    // Lowering the budget below current usage doesn't evict anything -
+    // it only stops new chunks being leased until usage drops.
+    void setBudgetBytes(juce::int64 newBudget)
+    {
+        budgetBytes.store(std::max(MIN_BUDGET_MB * 1024 * 1024, newBudget));
+        saveBudgetSetting();
+        DBG("LoopMemoryManager: budget set to " + juce::String(budgetBytes.load() / (1024 * 1024)) + " MB");
+    }
+
+    int getNumClients() const
+    {
+        const juce::ScopedLock lock(clientLock);
+        return static_cast<int>(clients.size());
+    }
+
+    // Usage of every registered instance, in registration order
+    std::vector<juce::int64> getClientUsage() const
+    {
+        const juce::ScopedLock lock(clientLock);
+        std::vector<juce::int64> usage;
+        usage.reserve(clients.size());
+        for (const auto* client : clients)
+            usage.push_back(client->bytesInUse.load());
+        return usage;
+    }
+
+private:
+    std::atomic<juce::int64> budgetBytes { 0 };
+    std::atomic<juce::int64> totalBytesInUse { 0 };
+
+    juce::CriticalSection clientLock;
+    std::vector<Client*> clients;
+
+    static juce::File getSettingsFile()
+    {
+        return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+            .getChildFile("LoopEngine")
+            .getChildFile("memory_settings.json");
+    }
+
+    void loadBudgetSetting()
+    {
+        const auto settingsFile = getSettingsFile();
+        if (!settingsFile.existsAsFile())
+            return;
+
+        const juce::var settings = juce::JSON::parse(settingsFile.loadFileAsString());
+        if (settings.hasProperty("budgetMB"))
+        {
+            const juce::int64 budgetMB = static_cast<juce::int64>(static_cast<double>(settings["budgetMB"]));
+            budgetBytes.store(std::max(MIN_BUDGET_MB, budgetMB) * 1024 * 1024);
+        }
+    }
+
+    void saveBudgetSetting() const
+    {
+        const auto settingsFile = getSettingsFile();
+        settingsFile.getParentDirectory().createDirectory();
+
+        juce::DynamicObject::Ptr settings = new juce::DynamicObject();
+        settings->setProperty("budgetMB", static_cast<double>(budgetBytes.load() / (1024 * 1024)));
+        settingsFile.replaceWithText(juce::JSON::toString(juce::var(settings.get())));
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoopMemoryManager)
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cmath>
+
+/**
+ * LoopPhase - 32.32 fixed-point loop playhead
+ *
+ * A float playhead at 60s x 96kHz (5.76M samples) has about half a sample of
+ * fractional resolution left, so rate/pitch reads drift against layer 0 and the
+ * wrap needs while-loops. LoopPhase keeps the integer sample index in the high
+ * 32 bits and the fraction in the low 32 bits of one int64:
+ *
+ *   - adding a rate increment is exact integer math, so layers advancing at the
+ *     same rate stay locked to the master clock indefinitely
+ *   - wrapping is a compare plus (rarely) one integer modulo, never a loop
+ *   - readers get an integer index and a fraction directly, with no floor()
+ */
+struct LoopPhase
+{
+    static constexpr int FRACTION_BITS = 32;
+    static constexpr juce::int64 ONE = static_cast<juce::int64>(1) << FRACTION_BITS;
+    static constexpr juce::int64 FRACTION_MASK = ONE - 1;
+
+    juce::int64 raw = 0;
+
+    static LoopPhase fromIndex(int index)
+    {
+        return { static_cast<juce::int64>(index) * ONE };
+    }
+
+    static LoopPhase fromSamples(double samples)
+    {
+        return { static_cast<juce::int64>(std::floor(samples * static_cast<double>(ONE))) };
+    }
+
+    // Per-sample increment for a playback rate in samples/sample (negative = reverse)
+    static juce::int64 incrementForRate(double rate)
+    {
+        return static_cast<juce::int64>(std::llround(rate * static_cast<double>(ONE)));
+    }
+
+    // Integer sample index (floor, also for negative phases)
+    int index() const noexcept { return static_cast<int>(raw >> FRACTION_BITS); }
+
+    // Fractional part in [0, 1). Uses the top 24 fraction bits so it never rounds up to 1.0f.
+    float fraction() const noexcept
+    {
+        return static_cast<float>((raw & FRACTION_MASK) >> (FRACTION_BITS - 24)) * (1.0f / 16777216.0f);
+    }
+
+    double toSamples() const noexcept { return static_cast<double>(raw) / static_cast<double>(ONE); }
+
+    // Advance by increment and wrap into [start, end) samples
+    void advance(juce::int64 increment, int start, int end) noexcept
+    {
+        raw += increment;
+        wrap(start, end);
+    }
+
+    void wrap(int start, int end) noexcept
+    {
+        const juce::int64 startRaw = static_cast<juce::int64>(start) * ONE;
+        const juce::int64 endRaw = static_cast<juce::int64>(end) * ONE;
+        const juce::int64 lengthRaw = endRaw - startRaw;
+        if (lengthRaw <= 0 || (raw >= startRaw && raw < endRaw))
+            return;
+
+        juce::int64 offset = (raw - startRaw) % lengthRaw;
+        if (offset < 0)
+            offset += lengthRaw;
+        raw = startRaw + offset;
+    }
+
+    bool operator==(const LoopPhase& other) const noexcept { return raw == other.raw; }
+    bool operator!=(const LoopPhase& other) const noexcept { return raw != other.raw; }
+};
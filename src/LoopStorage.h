@@ -0,0 +1,353 @@
+#pragma once
+
+#include "LoopChunkPool.h"
+#include <algorithm>
+#include <vector>
+
+/**
+ * LoopStorage - Stereo sample storage for one loop layer, backed by pool chunks
+ *
+ * Looks like a flat [0, maxSamples) stereo buffer to LoopBuffer, but only the
+ * chunks that have actually been written hold memory. Reading a region that was
+ * never written returns silence without touching the pool.
+ *
+ * Chunks are committed lazily on the first write that lands in them. A write whose
+ * chunk can't be committed (memory budget exhausted) is dropped.
+ *
+ * release() is O(1): the chunk table is handed back to the pool whole and swapped for
+ * a clean one, so clearing a full 60s layer costs the same as clearing an empty one.
+ *
+ * Layers can share audio: shareFrom() references another layer's chunks (copy-on-write)
+ * and swapWith() exchanges tables outright. Audio is only copied, one chunk at a time,
+ * when a shared chunk is written to.
+ */
+class LoopStorage
+{
+public:
+    using Chunk = LoopChunkPool::Chunk;
+    static constexpr int CHUNK_SHIFT = LoopChunkPool::CHUNK_SHIFT;
+    static constexpr int CHUNK_FRAMES = LoopChunkPool::CHUNK_FRAMES;
+    static constexpr int CHUNK_MASK = LoopChunkPool::CHUNK_MASK;
+
+    LoopStorage() = default;
+    ~LoopStorage() { detach(); }
+
+    // Borrow a chunk table sized for maxSamples frames. No audio memory is committed here.
+    // The pool must already be prepared for this sample rate.
+    void prepare(LoopChunkPool& chunkPool, int maxSamples)
+    {
+        detach();
+        pool = &chunkPool;
+        maxSampleCount = maxSamples;
+        table = pool->acquireTable();
+        jassert(table != nullptr && static_cast<int>(table->slots.size()) >= LoopChunkPool::chunksForSamples(maxSamples));
+    }
+
+    // Commit chunks through the pool's background path (LoopChunkPool::acquireBackground)
+    // instead of the audio thread's spare stock. For storages only written by render workers.
+    void setBackgroundWriter(int headroomChunks)
+    {
+        backgroundHeadroomChunks = headroomChunks;
+    }
+
+    // Give the chunk table (and everything in it) back to the pool. Required before
+    // the pool is re-prepared.
+    void detach()
+    {
+        if (table != nullptr && pool != nullptr)
+            pool->releaseTable(table);
+        table = nullptr;
+        anyCommitted = false;
+    }
+
+    // Forget all audio in O(1). The old table's chunks are released and zeroed by the
+    // pool's maintenance thread.
+    void release()
+    {
+        if (table == nullptr || pool == nullptr || !anyCommitted)
+            return;
+
+        anyCommitted = false;
+        if (ChunkTable* cleanTable = pool->acquireTable())
+        {
+            // Swap first, release after: a pinned reader never finds a retired table here
+            ChunkTable* oldTable = table;
+            table = cleanTable;
+            pool->releaseTable(oldTable);
+            return;
+        }
+
+        // Every spare table is still being recycled (many clears in a few ms) -
+        // release chunk by chunk instead. Still no zeroing on this thread.
+        releaseFrom(0);
+    }
+
+    // Release chunks lying entirely past numSamples (e.g. after the loop got shorter)
+    void releaseFrom(int numSamples)
+    {
+        if (table == nullptr)
+            return;
+
+        auto& chunks = table->slots;
+        for (size_t c = static_cast<size_t>(LoopChunkPool::chunksForSamples(numSamples)); c < chunks.size(); ++c)
+        {
+            Chunk* released = chunks[c];
+            chunks[c] = nullptr;
+            if (released != nullptr && pool != nullptr)
+                pool->release(released);
+        }
+    }
+
+    int getMaxSamples() const { return maxSampleCount; }
+
+    // For LoopChunkPool::ReadPin - readers that don't own this storage pin its pool
+    const LoopChunkPool* getPool() const { return pool; }
+
+    int getNumCommittedChunks() const
+    {
+        if (table == nullptr)
+            return 0;
+
+        const auto& chunks = table->slots;
+        return static_cast<int>(std::count_if(chunks.begin(), chunks.end(),
+                                              [](const Chunk* c) { return c != nullptr; }));
+    }
+
+    // Make sure the chunk holding index has memory. Fails when the memory budget is exhausted.
+    bool commit(int index)
+    {
+        return commitChunk(index >> CHUNK_SHIFT) != nullptr;
+    }
+
+    bool isCommitted(int index) const noexcept
+    {
+        return table->slots[static_cast<size_t>(index >> CHUNK_SHIFT)] != nullptr;
+    }
+
+    // Single sample access - uncommitted regions read as silence
+    float getSample(int channel, int index) const noexcept
+    {
+        const Chunk* chunk = table->slots[static_cast<size_t>(index >> CHUNK_SHIFT)];
+        return chunk != nullptr ? chunk->getChannel(channel)[index & CHUNK_MASK] : 0.0f;
+    }
+
+    void setSample(int channel, int index, float value)
+    {
+        if (Chunk* chunk = commitChunk(index >> CHUNK_SHIFT))
+            chunk->getChannel(channel)[index & CHUNK_MASK] = value;
+    }
+
+    // Contiguous read span starting at index, limited to the end of its chunk.
+    // Returns nullptr for never-written regions (treat as silence).
+    const float* getReadSpan(int channel, int index, int& spanLength) const noexcept
+    {
+        spanLength = CHUNK_FRAMES - (index & CHUNK_MASK);
+        const Chunk* chunk = table->slots[static_cast<size_t>(index >> CHUNK_SHIFT)];
+        return chunk != nullptr ? chunk->getChannel(channel) + (index & CHUNK_MASK) : nullptr;
+    }
+
+    // Contiguous write span starting at index (commits its chunk), limited to the end of the chunk
+    float* getWriteSpan(int channel, int index, int& spanLength)
+    {
+        spanLength = CHUNK_FRAMES - (index & CHUNK_MASK);
+        Chunk* chunk = commitChunk(index >> CHUNK_SHIFT);
+        return chunk != nullptr ? chunk->getChannel(channel) + (index & CHUNK_MASK) : nullptr;
+    }
+
+    // Copy numSamples from src into this storage starting at destStart
+    void copyFrom(int channel, int destStart, const float* src, int numSamples)
+    {
+        int done = 0;
+        while (done < numSamples)
+        {
+            int span = 0;
+            float* dest = getWriteSpan(channel, destStart + done, span);
+            span = std::min(span, numSamples - done);
+            if (dest != nullptr)
+                std::copy(src + done, src + done + span, dest);
+            done += span;
+        }
+    }
+
+    // Copy numSamples out of this storage into dest (silence where nothing was written)
+    void copyTo(int channel, int srcStart, float* dest, int numSamples) const
+    {
+        int done = 0;
+        while (done < numSamples)
+        {
+            int span = 0;
+            const float* src = getReadSpan(channel, srcStart + done, span);
+            span = std::min(span, numSamples - done);
+            if (src != nullptr)
+                std::copy(src, src + span, dest + done);
+            else
+                std::fill(dest + done, dest + done + span, 0.0f);
+            done += span;
+        }
+    }
+
+    // Replace this storage's first numSamples with another layer's content, sharing its
+    // chunks copy-on-write (no audio is copied here). Chunks beyond numSamples are released.
+    void shareFrom(const LoopStorage& other, int numSamples)
+    {
+        if (table == nullptr || other.table == nullptr)
+            return;
+
+        auto& chunks = table->slots;
+        const auto& otherChunks = other.table->slots;
+        const size_t numChunks = static_cast<size_t>(LoopChunkPool::chunksForSamples(numSamples));
+        for (size_t c = 0; c < chunks.size(); ++c)
+        {
+            Chunk* source = c < numChunks && c < otherChunks.size() ? otherChunks[c] : nullptr;
+            if (source == chunks[c])
+                continue;
+
+            LoopChunkPool::retain(source);
+            Chunk* released = chunks[c];
+            chunks[c] = source;
+            if (released != nullptr)
+                pool->release(released);
+            anyCommitted = anyCommitted || source != nullptr;
+        }
+    }
+
+    // Exchange audio with another layer in O(1) - nothing is copied or reference counted
+    void swapWith(LoopStorage& other)
+    {
+        jassert(pool == other.pool);
+        std::swap(table, other.table);
+        std::swap(anyCommitted, other.anyCommitted);
+        std::swap(maxSampleCount, other.maxSampleCount);
+    }
+
+    // Zero [start, start + numSamples) without committing new chunks
+    void clearRange(int start, int numSamples)
+    {
+        int done = 0;
+        while (done < numSamples)
+        {
+            const int index = start + done;
+            const int span = std::min(CHUNK_FRAMES - (index & CHUNK_MASK), numSamples - done);
+            if (Chunk* chunk = commitChunkIfPresent(index >> CHUNK_SHIFT))
+            {
+                std::fill(chunk->left.begin() + (index & CHUNK_MASK), chunk->left.begin() + (index & CHUNK_MASK) + span, 0.0f);
+                std::fill(chunk->right.begin() + (index & CHUNK_MASK), chunk->right.begin() + (index & CHUNK_MASK) + span, 0.0f);
+            }
+            done += span;
+        }
+    }
+
+    // Read-only view of a layer's audio for rendering on another thread. capture() retains
+    // the layer's chunks, so they stay intact (copy-on-write) if the layer writes, clears or
+    // re-records afterwards. capture() must run on the thread that owns the source storage
+    // (the audio thread); reading and reset() are safe from any one thread after that.
+    class Snapshot
+    {
+    public:
+        Snapshot() = default;
+        ~Snapshot() { reset(); }
+
+        // Size the slot list (message thread) - capture() never allocates
+        void prepare(LoopChunkPool& chunkPool, int maxSamples)
+        {
+            reset();
+            pool = &chunkPool;
+            slots.assign(static_cast<size_t>(LoopChunkPool::chunksForSamples(maxSamples)), nullptr);
+        }
+
+        // O(chunks): references are retained, no audio is copied
+        void capture(const LoopStorage& source, int numSamples)
+        {
+            reset();
+            if (source.table == nullptr)
+                return;
+
+            const auto& sourceChunks = source.table->slots;
+            numSlots = std::min({ static_cast<size_t>(LoopChunkPool::chunksForSamples(numSamples)),
+                                  slots.size(), sourceChunks.size() });
+            for (size_t c = 0; c < numSlots; ++c)
+            {
+                slots[c] = sourceChunks[c];
+                LoopChunkPool::retain(slots[c]);
+            }
+        }
+
+        // Drop the references (the pool zeroes chunks nobody else holds)
+        void reset()
+        {
+            for (size_t c = 0; c < numSlots; ++c)
+            {
+                if (slots[c] != nullptr && pool != nullptr)
+                    pool->release(slots[c]);
+                slots[c] = nullptr;
+            }
+            numSlots = 0;
+        }
+
+        float getSample(int channel, int index) const noexcept
+        {
+            const size_t c = static_cast<size_t>(index >> CHUNK_SHIFT);
+            const Chunk* chunk = c < numSlots ? slots[c] : nullptr;
+            return chunk != nullptr ? chunk->getChannel(channel)[index & CHUNK_MASK] : 0.0f;
+        }
+
+    private:
+        LoopChunkPool* pool = nullptr;
+        std::vector<Chunk*> slots;
+        size_t numSlots = 0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Snapshot)
+    };
+
+private:
+    using ChunkTable = LoopChunkPool::ChunkTable;
+
+    LoopChunkPool* pool = nullptr;
+    ChunkTable* table = nullptr;  // Borrowed from the pool, swapped out whole on release()
+    int maxSampleCount = 0;
+    bool anyCommitted = false;    // Lets release() skip the table swap for untouched layers
+    int backgroundHeadroomChunks = -1;  // >= 0: written by a render worker, see setBackgroundWriter()
+
+    Chunk* acquireChunk()
+    {
+        return backgroundHeadroomChunks >= 0 ? pool->acquireBackground(backgroundHeadroomChunks) : pool->acquire();
+    }
+
+    // Get a chunk that is safe to write: commit it if missing, and give this layer its
+    // own copy if it is shared with another layer (copy-on-write)
+    Chunk* commitChunk(int chunkIndex)
+    {
+        if (table == nullptr || pool == nullptr)
+            return nullptr;
+
+        Chunk*& chunk = table->slots[static_cast<size_t>(chunkIndex)];
+        if (chunk == nullptr)
+        {
+            chunk = acquireChunk();
+            anyCommitted = anyCommitted || chunk != nullptr;
+        }
+        else if (LoopChunkPool::isShared(chunk))
+        {
+            Chunk* copy = acquireChunk();
+            if (copy == nullptr)
+                return nullptr;  // Over budget - the write is dropped, the shared audio is untouched
+
+            copy->left = chunk->left;
+            copy->right = chunk->right;
+            Chunk* released = chunk;
+            chunk = copy;
+            pool->release(released);
+        }
+        return chunk;
+    }
+
+    // Like commitChunk() but never commits a missing chunk (used when zeroing)
+    Chunk* commitChunkIfPresent(int chunkIndex)
+    {
+        if (table == nullptr || table->slots[static_cast<size_t>(chunkIndex)] == nullptr)
+            return nullptr;
+        return commitChunk(chunkIndex);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoopStorage)
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <juce_dsp/juce_dsp.h>
+#include "LoopPhase.h"
 #include <vector>
 #include <cmath>
 #include <atomic>
@@ -54,7 +55,7 @@ public:
 
         // Initialize state
         writePos = 0;
-        readPos = 0.0f;
+        readPos = LoopPhase();
         bufferLength = maxBufferSize;
         capturedLoopStart = 0;
         capturedLength = 0;
@@ -311,7 +312,7 @@ public:
             {
                 capturedLoopStart = (writePos - effectiveLength + maxBufferSize) % maxBufferSize;
                 capturedLength = effectiveLength;
-                readPos = 0.0f;
+                readPos = LoopPhase();
                 stretchGrainPos = 0.0f;
                 stretchGrainPhase = 0.0f;
                 isPlaying = true;
@@ -325,7 +326,7 @@ public:
     {
         isPlaying = false;
         isOverdubbing.store(false);
-        readPos = 0.0f;
+        readPos = LoopPhase();
         DBG("MicroLooper: STOP");
     }
 
@@ -367,7 +368,7 @@ public:
         std::fill(bufferL.begin(), bufferL.end(), 0.0f);
         std::fill(bufferR.begin(), bufferR.end(), 0.0f);
         writePos = 0;
-        readPos = 0.0f;
+        readPos = LoopPhase();
         samplesRecorded = 0;
         capturedLoopStart = 0;
         capturedLength = 0;
@@ -397,7 +398,7 @@ public:
     {
         if (!isPlaying || capturedLength == 0)
             return 0.0f;
-        return std::clamp(static_cast<float>(readPos) / static_cast<float>(capturedLength), 0.0f, 1.0f);
+        return std::clamp(static_cast<float>(readPos.toSamples() / capturedLength), 0.0f, 1.0f);
     }
 
     // Get recording position for visualization (0-1)
@@ -450,7 +451,7 @@ private:
     // Audio buffers
     std::vector<float> bufferL, bufferR;
     int writePos = 0;
-    float readPos = 0.0f;  // Floating point for sub-sample interpolation
+    LoopPhase readPos;  // 32.32 fixed-point playhead for sub-sample interpolation without drift
     int bufferLength = 0;
     int capturedLoopStart = 0;  // Where the captured loop starts in the buffer
     int capturedLength = 0;     // Length of the captured loop
@@ -586,15 +587,29 @@ private:
     // Read from buffer with Hermite interpolation for smooth playback
     float readBufferHermite(const std::vector<float>& buffer, float pos, int loopStart, int loopLength) const
     {
+        const float whole = std::floor(pos);
+        return readBufferHermite(buffer, static_cast<int>(whole), pos - whole, loopStart, loopLength);
+    }
+
+    float readBufferHermite(const std::vector<float>& buffer, LoopPhase pos, int loopStart, int loopLength) const
+    {
+        return readBufferHermite(buffer, pos.index(), pos.fraction(), loopStart, loopLength);
+    }
+
+    // Position given as integer index + fraction; the index is wrapped into the loop exactly
+    float readBufferHermite(const std::vector<float>& buffer, int index, float frac, int loopStart, int loopLength) const
+    {
+        if (loopLength <= 0)
+            return 0.0f;
+
         // Wrap position within loop
-        while (pos < 0.0f)
-            pos += static_cast<float>(loopLength);
-        while (pos >= static_cast<float>(loopLength))
-            pos -= static_cast<float>(loopLength);
+        index %= loopLength;
+        if (index < 0)
+            index += loopLength;
 
         // Get actual buffer indices
         auto getIdx = [&](int offset) {
-            int idx = loopStart + static_cast<int>(pos) + offset;
+            int idx = loopStart + index + offset;
             // Wrap within the loop region
             while (idx < loopStart) idx += loopLength;
             while (idx >= loopStart + loopLength) idx -= loopLength;
@@ -606,7 +621,6 @@ private:
         const int idxM1 = getIdx(-1);
         const int idx1 = getIdx(1);
         const int idx2 = getIdx(2);
-        const float frac = pos - std::floor(pos);
 
         const float y0 = buffer[idxM1];
         const float y1 = buffer[idx0];
@@ -670,14 +684,12 @@ private:
         }
 
         // Read from buffer with crossfade
-        float xfadeGain = getCrossfadeGain(readPos, activeLength);
+        float xfadeGain = getCrossfadeGain(static_cast<float>(readPos.toSamples()), activeLength);
         outputL = readBufferHermite(bufferL, readPos, capturedLoopStart, activeLength) * loopGain * xfadeGain;
         outputR = readBufferHermite(bufferR, readPos, capturedLoopStart, activeLength) * loopGain * xfadeGain;
 
         // Advance playhead (always forward in ENV mode at 1x speed)
-        readPos += 1.0f;
-        if (readPos >= static_cast<float>(activeLength))
-            readPos -= static_cast<float>(activeLength);
+        readPos.advance(LoopPhase::ONE, 0, activeLength);
     }
 
     // TAPE mode: speed and direction control like a tape reel
@@ -688,22 +700,17 @@ private:
         float effectiveSpeed = isReversed.load() ? -speed : speed;
 
         // Read from buffer with crossfade
-        float xfadeGain = getCrossfadeGain(readPos, activeLength);
+        const float readPosSamples = static_cast<float>(readPos.toSamples());
+        float xfadeGain = getCrossfadeGain(readPosSamples, activeLength);
         outputL = readBufferHermite(bufferL, readPos, capturedLoopStart, activeLength) * xfadeGain;
         outputR = readBufferHermite(bufferR, readPos, capturedLoopStart, activeLength) * xfadeGain;
 
         // Modify in TAPE mode controls a subtle pitch wobble (like tape wow)
         float wobbleAmount = modify * 0.002f;
-        float wobble = std::sin(readPos * 0.01f) * wobbleAmount;
+        float wobble = std::sin(readPosSamples * 0.01f) * wobbleAmount;
 
-        // Advance playhead with speed and wobble
-        readPos += effectiveSpeed + wobble;
-
-        // Wrap around loop
-        while (readPos < 0.0f)
-            readPos += static_cast<float>(activeLength);
-        while (readPos >= static_cast<float>(activeLength))
-            readPos -= static_cast<float>(activeLength);
+        // Advance playhead with speed and wobble, wrapping around the loop in one step
+        readPos.advance(LoopPhase::incrementForRate(effectiveSpeed + wobble), 0, activeLength);
     }
 
     // STRETCH mode: time-stretch using granular technique (change speed without pitch)
@@ -752,7 +759,8 @@ private:
         stretchGrainPos += effectiveSpeed;
 
         // Also update readPos for playhead visualization
-        readPos = stretchGrainPos;
+        readPos = LoopPhase::fromSamples(stretchGrainPos);
+        readPos.wrap(0, activeLength);
 
         // Wrap around loop
         while (stretchGrainPos < 0.0f)
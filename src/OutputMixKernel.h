@@ -0,0 +1,245 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+/**
+ * OutputMixKernel - Fused layer mix, metering and soft clip
+ *
+ * After the layers render, the engine used to walk each channel once per job: a peak/clip
+ * scan per layer, an addFrom/copyFrom per layer into the output and again into the
+ * loop-only bus, an input-subtraction loop for recording layers, the bounce add, the input
+ * passthrough, a pre-clip peak/clip scan, a loop-bus peak scan and the soft clip. mixChannel()
+ * does all of it in one pass:
+ *
+ *   - the block is walked in TILE-sample tiles that stay in L1; every source is read once
+ *     per tile and the output/loop tiles are written once
+ *   - all per-tile loops are contiguous and branch-free (peaks/clip counts accumulate in
+ *     per-lane arrays, reduced once at the end), so the compiler vectorises them
+ *   - soft clipping is an identity inside [-1, 1]; only tiles whose peak exceeds 1 take
+ *     the scalar exp() path
+ *
+ * Samples are summed in the same order as the serial addFrom/copyFrom sequence (sources in
+ * layer order, then bounce, then input), so the result is bit-identical to the multi-pass mix.
+ */
+namespace OutputMixKernel
+{
+    static constexpr int TILE = 64;
+
+    // Exponential soft clip above +/-1 (identity inside)
+    inline float softClip(float x) noexcept
+    {
+        if (x > 1.0f)
+            return 1.0f - std::exp(-(x - 1.0f));
+        else if (x < -1.0f)
+            return -1.0f + std::exp(-(-x - 1.0f));
+        return x;
+    }
+
+    // softClip() over a block, tile by tile: tiles that stay inside [-1, 1] (almost all of
+    // them) cost one vectorised peak scan and are left untouched. Bit-identical to the
+    // per-sample loop.
+    inline void softClipBlock(float* data, int numSamples) noexcept
+    {
+        for (int start = 0; start < numSamples; start += TILE)
+        {
+            float* x = data + start;
+            const int n = std::min(TILE, numSamples - start);
+
+            float tilePeak = 0.0f;
+            for (int j = 0; j < n; ++j)
+            {
+                const float a = std::abs(x[j]);
+                tilePeak = tilePeak < a ? a : tilePeak;
+            }
+            if (tilePeak > 1.0f)
+                for (int j = 0; j < n; ++j)
+                    x[j] = softClip(x[j]);
+        }
+    }
+
+    enum class MixMode
+    {
+        Sum = 0,    // Track mode: layers add
+        Override    // Layer mode: the last mixed layer replaces the ones below it
+    };
+
+    enum class InputMode
+    {
+        None = 0,   // A recording layer already carries the input
+        Add,        // Playback only: monitor the input on top of the loop
+        Replace     // Nothing has content yet: the output is the input
+    };
+
+    enum class LoopPortion
+    {
+        Whole = 0,            // Playback layer: all of it is loop audio
+        MinusInput,           // Recording/overdubbing: layer - input
+        MinusInputAndBounce   // Layer mode bounce target: layer - input - bounce
+    };
+
+    // One rendered layer, one channel
+    struct Source
+    {
+        const float* data = nullptr;
+        bool mixed = true;                       // false: metered only (being bounced)
+        LoopPortion loopPortion = LoopPortion::Whole;
+    };
+
+    // Per-layer peak/clip accumulator; carried across channels, reduced by the caller
+    struct Meter
+    {
+        std::array<float, TILE> lanePeak {};
+        std::array<int, TILE> laneClips {};
+
+        void reset() noexcept
+        {
+            lanePeak.fill(0.0f);
+            laneClips.fill(0);
+        }
+
+        float peak() const noexcept { return *std::max_element(lanePeak.begin(), lanePeak.end()); }
+
+        int clips() const noexcept
+        {
+            int total = 0;
+            for (const int c : laneClips)
+                total += c;
+            return total;
+        }
+    };
+
+    struct ChannelResult
+    {
+        float outputPeak = 0.0f;   // Before soft clipping
+        int outputClips = 0;       // Samples above 1 before soft clipping
+        float loopPeak = 0.0f;
+    };
+
+    // Accumulate |x| into a meter's lanes (elementwise - vectorises without a reduction)
+    inline void meterTile(Meter& meter, const float* x, int n) noexcept
+    {
+        float* peak = meter.lanePeak.data();
+        int* clips = meter.laneClips.data();
+        for (int j = 0; j < n; ++j)
+        {
+            const float a = std::abs(x[j]);
+            peak[j] = peak[j] < a ? a : peak[j];
+            clips[j] += a > 1.0f ? 1 : 0;
+        }
+    }
+
+    // Mix one channel of every source into out (soft clipped) and loopOut, metering each
+    // source into meters[k]. input/bounce may be null when unused.
+    inline ChannelResult mixChannel(const Source* sources, Meter* meters, int numSources,
+                                    MixMode mixMode, InputMode inputMode,
+                                    const float* input, const float* bounce, bool addBounceToLoop,
+                                    float* out, float* loopOut, int numSamples) noexcept
+    {
+        // Override mode: only the last mixed source reaches the buses
+        int firstMixed = 0;
+        if (mixMode == MixMode::Override)
+        {
+            firstMixed = numSources;
+            for (int k = numSources - 1; k >= 0; --k)
+                if (sources[k].mixed) { firstMixed = k; break; }
+        }
+
+        Meter outputMeter, loopMeter;
+        outputMeter.reset();
+        loopMeter.reset();
+
+        alignas(32) float acc[TILE];
+        alignas(32) float loopAcc[TILE];
+
+        for (int start = 0; start < numSamples; start += TILE)
+        {
+            const int n = std::min(TILE, numSamples - start);
+            std::fill(acc, acc + n, 0.0f);
+            std::fill(loopAcc, loopAcc + n, 0.0f);
+
+            for (int k = 0; k < numSources; ++k)
+            {
+                const Source& source = sources[k];
+                const float* x = source.data + start;
+                meterTile(meters[k], x, n);
+
+                if (!source.mixed || k < firstMixed)
+                    continue;
+
+                if (mixMode == MixMode::Sum)
+                {
+                    for (int j = 0; j < n; ++j)
+                        acc[j] += x[j];
+                }
+                else
+                {
+                    std::copy(x, x + n, acc);
+                }
+
+                const float* in = input + start;
+                switch (source.loopPortion)
+                {
+                    case LoopPortion::Whole:
+                        if (mixMode == MixMode::Sum)
+                            for (int j = 0; j < n; ++j) loopAcc[j] += x[j];
+                        else
+                            std::copy(x, x + n, loopAcc);
+                        break;
+
+                    case LoopPortion::MinusInput:
+                        if (mixMode == MixMode::Sum)
+                            for (int j = 0; j < n; ++j) loopAcc[j] += x[j] - in[j];
+                        else
+                            for (int j = 0; j < n; ++j) loopAcc[j] = x[j] - in[j];
+                        break;
+
+                    case LoopPortion::MinusInputAndBounce:
+                    {
+                        const float* b = bounce + start;
+                        if (mixMode == MixMode::Sum)
+                            for (int j = 0; j < n; ++j) loopAcc[j] += (x[j] - in[j]) - b[j];
+                        else
+                            for (int j = 0; j < n; ++j) loopAcc[j] = (x[j] - in[j]) - b[j];
+                        break;
+                    }
+                }
+            }
+
+            if (addBounceToLoop)
+            {
+                const float* b = bounce + start;
+                for (int j = 0; j < n; ++j)
+                    loopAcc[j] += b[j];
+            }
+
+            if (inputMode == InputMode::Add)
+            {
+                const float* in = input + start;
+                for (int j = 0; j < n; ++j)
+                    acc[j] += in[j];
+            }
+            else if (inputMode == InputMode::Replace)
+            {
+                std::copy(input + start, input + start + n, acc);
+            }
+
+            meterTile(outputMeter, acc, n);
+            meterTile(loopMeter, loopAcc, n);
+
+            // Soft clip only tiles that actually exceed full scale
+            softClipBlock(acc, n);
+
+            std::copy(acc, acc + n, out + start);
+            std::copy(loopAcc, loopAcc + n, loopOut + start);
+        }
+
+        ChannelResult result;
+        result.outputPeak = outputMeter.peak();
+        result.outputClips = outputMeter.clips();
+        result.loopPeak = loopMeter.peak();
+        return result;
+    }
+}
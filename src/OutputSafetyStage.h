@@ -0,0 +1,366 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <vector>
+
+/**
+ * OutputSafetyStage - Last processing stage of the plugin output
+ *
+ * Replaces the per-sample safety loop at the end of processBlock (std::isnan/std::isinf
+ * checks, std::tanh above 0.95) with block passes the compiler vectorises:
+ *
+ *   - NaN/Inf scrubbing: a branch-free exponent-bits test, non-finite samples become 0
+ *   - soft knee: above |x| = 0.95 the sample becomes tanh(1.2 x) * 0.95, same curve as
+ *     before, computed with fastTanh() for every lane and selected without a branch
+ *   - optional true-peak limiter (off by default): inter-sample peaks are estimated at
+ *     4x from a Catmull-Rom fit through the neighbouring samples, the stereo-linked gain
+ *     needed to keep them under the ceiling is held as a sliding minimum over the
+ *     lookahead window and smoothed with a box filter of the same length, so gain
+ *     reduction is complete by the time the peak leaves the delay line. Release is a
+ *     one-pole recovery towards unity. Adds LOOKAHEAD_MS + 1 sample of latency.
+ *
+ * With the limiter off everything happens in one pass per channel (which also keeps the
+ * delay line fed); with it on there is a detect pass, a sequential gain pass and an apply
+ * pass (delay, gain, knee). Toggling the limiter crossfades between the direct and the
+ * delayed, limited signal over TOGGLE_FADE_MS instead of jumping. Blocks larger than the
+ * prepared size are processed in prepared-size pieces.
+ */
+class OutputSafetyStage
+{
+public:
+    static constexpr int MAX_CHANNELS = 2;            // Limiter link width; more channels are scrubbed/kneed only
+    static constexpr float KNEE_THRESHOLD = 0.95f;
+    static constexpr float KNEE_DRIVE = 1.2f;
+    static constexpr float LOOKAHEAD_MS = 1.5f;
+    static constexpr float RELEASE_MS = 60.0f;
+    static constexpr float DEFAULT_CEILING_DB = -1.0f;
+    static constexpr float TOGGLE_FADE_MS = 10.0f;
+
+    /**
+     * tanh via the [7/6] Pade approximant, input clamped to +/-4.97 (where it reaches 1).
+     * Absolute error against std::tanh (double reference, before float rounding):
+     *   < 2e-12 for |x| <= 1,  < 1.2e-8 for |x| <= 2,  < 1e-6 for |x| <= 3,
+     *   < 1e-4 for all x (worst case ~9.6e-5 near |x| = 4.97).
+     * Odd, monotonic on the clamped range, and never exceeds +/-1.
+     */
+    static float fastTanh(float x) noexcept
+    {
+        const float c = std::clamp(x, -4.97f, 4.97f);
+        const float x2 = c * c;
+        const float num = c * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
+        const float den = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + 28.0f * x2));
+        return std::clamp(num / den, -1.0f, 1.0f);
+    }
+
+    // Non-finite samples (NaN, +/-Inf) become 0 - exponent bits all set means non-finite
+    static float scrub(float x) noexcept
+    {
+        return (std::bit_cast<juce::uint32>(x) & 0x7f800000u) == 0x7f800000u ? 0.0f : x;
+    }
+
+    static float knee(float x) noexcept
+    {
+        const float shaped = fastTanh(x * KNEE_DRIVE) * KNEE_THRESHOLD;
+        return std::abs(x) > KNEE_THRESHOLD ? shaped : x;
+    }
+
+    OutputSafetyStage() = default;
+
+    // Message thread (prepareToPlay): allocates everything the limiter needs
+    void prepare(double sampleRate, int maxBlockSize)
+    {
+        lookahead = std::max(1, static_cast<int>(std::ceil(sampleRate * LOOKAHEAD_MS / 1000.0)));
+        releaseCoeff = 1.0f - std::exp(-1.0f / static_cast<float>(sampleRate * RELEASE_MS / 1000.0));
+        toggleFadeStep = 1.0f / std::max(1.0f, static_cast<float>(sampleRate * TOGGLE_FADE_MS / 1000.0));
+
+        const int delayLength = lookahead + 1;
+        ringSize = juce::nextPowerOfTwo(delayLength + 1);
+        for (auto& ring : delayRings)
+            ring.assign(static_cast<size_t>(ringSize), 0.0f);
+
+        minValues.assign(static_cast<size_t>(lookahead + 2), 1.0f);
+        minIndices.assign(static_cast<size_t>(lookahead + 2), 0);
+        boxValues.assign(static_cast<size_t>(lookahead), 1.0f);
+
+        for (auto& scratch : detectScratch)
+            scratch.assign(static_cast<size_t>(maxBlockSize + HISTORY), 0.0f);
+        linkedPeak.assign(static_cast<size_t>(maxBlockSize), 0.0f);
+        gains.assign(static_cast<size_t>(maxBlockSize), 1.0f);
+        mixes.assign(static_cast<size_t>(maxBlockSize), 0.0f);
+
+        resetLimiter();
+        limiterMix = limiterEnabled.load() ? 1.0f : 0.0f;
+    }
+
+    // Message thread. The host must be told the new latency (getLatencySamples()).
+    void setLimiterEnabled(bool enabled) { limiterEnabled.store(enabled); }
+    bool isLimiterEnabled() const { return limiterEnabled.load(); }
+
+    void setCeilingDb(float db) { ceiling.store(juce::Decibels::decibelsToGain(db)); }
+    float getCeilingDb() const { return juce::Decibels::gainToDecibels(ceiling.load()); }
+
+    int getLatencySamples() const { return limiterEnabled.load() ? lookahead + 1 : 0; }
+
+    // Audio thread
+    void process(juce::AudioBuffer<float>& buffer, int numSamples) noexcept
+    {
+        const int maxBlock = static_cast<int>(gains.size());
+        if (maxBlock == 0)
+        {
+            // Not prepared - scrub and knee only
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                scrubAndKnee(buffer.getWritePointer(ch), numSamples);
+            return;
+        }
+
+        for (int start = 0; start < numSamples; start += maxBlock)
+            processPiece(buffer, start, std::min(maxBlock, numSamples - start));
+    }
+
+private:
+    static constexpr int HISTORY = 3;  // Samples of the previous block the peak estimate looks back on
+
+    std::atomic<bool> limiterEnabled { false };
+    std::atomic<float> ceiling { juce::Decibels::decibelsToGain(DEFAULT_CEILING_DB) };
+    float limiterMix = 0.0f;        // 0 = direct, 1 = delayed + limited; ramps on toggle
+    float toggleFadeStep = 1.0f;
+
+    int lookahead = 1;
+    float releaseCoeff = 0.001f;
+
+    // Delay line (per channel), power-of-two ring
+    std::array<std::vector<float>, MAX_CHANNELS> delayRings;
+    int ringSize = 0;
+    int writePos = 0;
+
+    // Detection: [history | block] per channel, then the channel-linked estimate
+    std::array<std::vector<float>, MAX_CHANNELS> detectScratch;
+    std::vector<float> linkedPeak;
+    std::vector<float> gains;
+    std::vector<float> mixes;       // Per-sample limiterMix while a toggle fade runs
+
+    // Gain computer: release-smoothed target -> sliding minimum (monotonic queue) -> box filter
+    float releasedGain = 1.0f;
+    std::vector<float> minValues;
+    std::vector<juce::int64> minIndices;
+    int minHead = 0;
+    int minCount = 0;
+    juce::int64 sampleIndex = 0;
+    std::vector<float> boxValues;
+    int boxPos = 0;
+    double boxSum = 0.0;
+
+    void resetLimiter() noexcept
+    {
+        for (auto& ring : delayRings)
+            std::fill(ring.begin(), ring.end(), 0.0f);
+        for (auto& scratch : detectScratch)
+            std::fill(scratch.begin(), scratch.end(), 0.0f);
+        writePos = 0;
+        releasedGain = 1.0f;
+        minHead = 0;
+        minCount = 0;
+        sampleIndex = 0;
+        std::fill(boxValues.begin(), boxValues.end(), 1.0f);
+        boxPos = 0;
+        boxSum = static_cast<double>(boxValues.size());
+    }
+
+    // Gain computer back to unity (the delay line and detection history stay valid)
+    void resetGainComputer() noexcept
+    {
+        releasedGain = 1.0f;
+        minHead = 0;
+        minCount = 0;
+        sampleIndex = 0;
+        std::fill(boxValues.begin(), boxValues.end(), 1.0f);
+        boxPos = 0;
+        boxSum = static_cast<double>(boxValues.size());
+    }
+
+    // At most gains.size() samples starting at start
+    void processPiece(juce::AudioBuffer<float>& buffer, int start, int numSamples) noexcept
+    {
+        const int numChannels = buffer.getNumChannels();
+        const int linked = std::min(numChannels, MAX_CHANNELS);
+        const float target = limiterEnabled.load() ? 1.0f : 0.0f;
+
+        for (int ch = linked; ch < numChannels; ++ch)
+            scrubAndKnee(buffer.getWritePointer(ch, start), numSamples);
+
+        if (limiterMix == 0.0f && target == 0.0f)
+        {
+            // Off: direct path, but keep the delay line and detection history current so
+            // switching on can fade straight into valid delayed audio
+            for (int ch = 0; ch < linked; ++ch)
+                bypassDelayed(buffer.getWritePointer(ch, start), static_cast<size_t>(ch), numSamples);
+        }
+        else
+        {
+            if (limiterMix == 0.0f)
+                resetGainComputer();  // Switching on: no gain reduction carried over from before
+
+            detectPeaks(buffer, start, linked, numSamples);
+            computeGains(numSamples);
+            computeMixes(target, numSamples);
+
+            for (int ch = 0; ch < linked; ++ch)
+                applyDelayed(buffer.getWritePointer(ch, start), delayRings[static_cast<size_t>(ch)].data(), numSamples);
+        }
+
+        writePos = (writePos + numSamples) & (ringSize - 1);
+    }
+
+    static void scrubAndKnee(float* data, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = knee(scrub(data[i]));
+    }
+
+    // Limiter off: scrub, feed the delay line and detection history, knee in place
+    void bypassDelayed(float* data, size_t channel, int numSamples) noexcept
+    {
+        float* ring = delayRings[channel].data();
+        float* ext = detectScratch[channel].data();
+        const int mask = ringSize - 1;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = scrub(data[i]);
+            ring[(writePos + i) & mask] = x;
+            data[i] = knee(x);
+        }
+
+        // The detector looks back on the last HISTORY samples, which the ring still holds
+        for (int h = 0; h < HISTORY; ++h)
+            ext[h] = ring[(writePos + numSamples - HISTORY + h) & mask];
+    }
+
+    // Per-sample crossfade position between the direct and the limited signal
+    void computeMixes(float target, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            limiterMix = target > limiterMix ? std::min(target, limiterMix + toggleFadeStep)
+                                             : std::max(target, limiterMix - toggleFadeStep);
+            mixes[static_cast<size_t>(i)] = limiterMix;
+        }
+    }
+
+    // Scrub in place, then estimate the true peak of the segment ending at each sample:
+    // |x[n-1]|, and the Catmull-Rom curve through x[n-3..n] at 1/4, 1/2 and 3/4 between
+    // x[n-2] and x[n-1]. The estimate lags the input by up to two samples; the delay line
+    // is one sample longer than the lookahead to cover it.
+    void detectPeaks(juce::AudioBuffer<float>& buffer, int start, int linked, int numSamples) noexcept
+    {
+        float* peak = linkedPeak.data();
+        std::fill(peak, peak + numSamples, 0.0f);
+
+        for (int ch = 0; ch < linked; ++ch)
+        {
+            float* data = buffer.getWritePointer(ch, start);
+            float* ext = detectScratch[static_cast<size_t>(ch)].data();
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                data[i] = scrub(data[i]);
+                ext[HISTORY + i] = data[i];
+            }
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                // ext[i + 3] is x[n]; the segment is x[n-2] -> x[n-1]
+                const float y0 = ext[i];
+                const float y1 = ext[i + 1];
+                const float y2 = ext[i + 2];
+                const float y3 = ext[i + 3];
+
+                const float c1 = 0.5f * (y2 - y0);
+                const float c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+                const float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+
+                const float q1 = ((c3 * 0.25f + c2) * 0.25f + c1) * 0.25f + y1;
+                const float q2 = ((c3 * 0.5f + c2) * 0.5f + c1) * 0.5f + y1;
+                const float q3 = ((c3 * 0.75f + c2) * 0.75f + c1) * 0.75f + y1;
+
+                const float segment = std::max(std::max(std::abs(y2), std::abs(q1)),
+                                               std::max(std::abs(q2), std::abs(q3)));
+                peak[i] = std::max(peak[i], segment);
+            }
+
+            // Keep the last HISTORY samples for the next block
+            std::copy(ext + numSamples, ext + numSamples + HISTORY, ext);
+        }
+    }
+
+    // Sequential: target gain -> release -> sliding min over lookahead + 1 -> box of lookahead
+    void computeGains(int numSamples) noexcept
+    {
+        const float ceil = ceiling.load();
+        const int window = lookahead + 1;
+        const int capacity = static_cast<int>(minValues.size());
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float p = linkedPeak[static_cast<size_t>(i)];
+            const float target = p > ceil ? ceil / p : 1.0f;
+
+            releasedGain = target < releasedGain ? target
+                                                 : releasedGain + (target - releasedGain) * releaseCoeff;
+
+            // Monotonic queue: drop larger values from the back, expired ones from the front
+            while (minCount > 0)
+            {
+                const int back = (minHead + minCount - 1) % capacity;
+                if (minValues[static_cast<size_t>(back)] < releasedGain)
+                    break;
+                --minCount;
+            }
+            const int slot = (minHead + minCount) % capacity;
+            minValues[static_cast<size_t>(slot)] = releasedGain;
+            minIndices[static_cast<size_t>(slot)] = sampleIndex;
+            ++minCount;
+
+            if (minIndices[static_cast<size_t>(minHead)] <= sampleIndex - window)
+            {
+                minHead = (minHead + 1) % capacity;
+                --minCount;
+            }
+
+            const float windowMin = minValues[static_cast<size_t>(minHead)];
+
+            boxSum += static_cast<double>(windowMin) - static_cast<double>(boxValues[static_cast<size_t>(boxPos)]);
+            boxValues[static_cast<size_t>(boxPos)] = windowMin;
+            boxPos = (boxPos + 1) % lookahead;
+
+            gains[static_cast<size_t>(i)] = std::min(1.0f, static_cast<float>(boxSum / lookahead));
+            ++sampleIndex;
+        }
+    }
+
+    // Push the block through the delay line, apply the gain and the knee. While a toggle
+    // fade runs the result is blended with the direct (undelayed) signal.
+    void applyDelayed(float* data, float* ring, int numSamples) noexcept
+    {
+        const int delay = lookahead + 1;
+        const int mask = ringSize - 1;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const int w = (writePos + i) & mask;
+            const float direct = data[i];
+            ring[w] = direct;
+            const float delayed = ring[(w - delay) & mask];
+            const float limited = knee(delayed * gains[static_cast<size_t>(i)]);
+            const float mix = mixes[static_cast<size_t>(i)];
+            data[i] = mix >= 1.0f ? limited : limited * mix + knee(direct) * (1.0f - mix);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutputSafetyStage)
+};
@@ -6,6 +6,7 @@
 #endif
 
 #include "signalsmith-stretch.h"
+#include <algorithm>
 #include <vector>
 #include <cmath>
 
@@ -302,13 +303,217 @@ private:
     }
 };
 
+/**
+ * MultichannelBlockPitchShifter - One Signalsmith Stretch instance for all channels of a layer
+ *
+ * Where a pair of mono BlockPitchShifters runs two independent analyses (and can let the
+ * stereo image drift, since each channel picks its own phases), this drives a single
+ * SignalsmithStretch configured for numChannels: spectral peaks and phase advances are
+ * shared across channels, so inter-channel phase stays coherent, and the per-instance
+ * bookkeeping happens once. Input is read straight from the caller's channel pointers;
+ * output goes through one latency-compensation ring (channel-major, one pair of indices).
+ *
+ * Look-ahead feed: a caller that can read its input ahead of time (loop playback - the
+ * content is already in memory) feeds audio getLookAheadSamples() ahead of the position it
+ * wants to hear. The stretch engine's own delay then lines the output up with that
+ * position, so the ring is skipped and the shifter adds no latency at all.
+ */
+class MultichannelBlockPitchShifter
+{
+public:
+    MultichannelBlockPitchShifter() = default;
+
+    void prepare(double newSampleRate, int maxBlockSize, int newNumChannels, bool highQuality = false)
+    {
+        sampleRate = newSampleRate;
+        currentMaxBlockSize = maxBlockSize;
+        numChannels = std::max(1, newNumChannels);
+        isHighQuality = highQuality;
+        prepared = true;
+
+        if (highQuality)
+            stretch.presetDefault(numChannels, static_cast<float>(sampleRate));
+        else
+            stretch.presetCheaper(numChannels, static_cast<float>(sampleRate));
+
+        totalLatency = stretch.inputLatency() + stretch.outputLatency();
+
+        // Stretch output scratch; longer blocks are processed in chunks of this size
+        chunkSize = std::max(maxBlockSize * 2, 1024);
+        outputBuffers.resize(static_cast<size_t>(numChannels));
+        for (auto& channel : outputBuffers)
+            channel.assign(static_cast<size_t>(chunkSize), 0.0f);
+        inputPtrs.assign(static_cast<size_t>(numChannels), nullptr);
+        outputPtrs.resize(static_cast<size_t>(numChannels));
+        for (int c = 0; c < numChannels; ++c)
+            outputPtrs[static_cast<size_t>(c)] = outputBuffers[static_cast<size_t>(c)].data();
+
+        // Power-of-two ring so wrapping is a mask
+        ringSize = 1;
+        while (ringSize < totalLatency + chunkSize)
+            ringSize <<= 1;
+        latencyRing.assign(static_cast<size_t>(ringSize * numChannels), 0.0f);
+
+        reset();
+    }
+
+    // Reconfigure quality without full re-prepare (uses cached sampleRate/blockSize/channels)
+    void setHighQuality(bool highQuality)
+    {
+        if (!prepared || isHighQuality == highQuality)
+            return;
+
+        prepare(sampleRate, currentMaxBlockSize, numChannels, highQuality);
+    }
+
+    bool getHighQuality() const { return isHighQuality; }
+
+    void reset()
+    {
+        if (!prepared)
+            return;
+
+        stretch.reset();
+        pitchRatio = 1.0f;
+        targetPitchRatio = 1.0f;
+        std::fill(latencyRing.begin(), latencyRing.end(), 0.0f);
+        latencyWritePos = totalLatency;  // Pre-fill latency
+        latencyReadPos = 0;
+    }
+
+    // Switch between delayed output (default) and look-ahead feed. Resets when it changes.
+    void setLookAheadFeed(bool enabled)
+    {
+        if (lookAheadFeed == enabled)
+            return;
+
+        lookAheadFeed = enabled;
+        reset();
+    }
+
+    bool isLookAheadFeed() const { return lookAheadFeed; }
+
+    // How far ahead a look-ahead caller must feed: the stretch engine's input + output latency
+    int getLookAheadSamples() const
+    {
+        if (!prepared)
+            return 0;
+        return totalLatency;
+    }
+
+    void setPitchRatio(float ratio)
+    {
+        if (!prepared)
+            return;
+
+        targetPitchRatio = std::clamp(ratio, 0.25f, 4.0f);
+    }
+
+    // Process numSamples of every channel. Outputs may alias inputs.
+    void processBlock(const float* const* inputs, float* const* outputs, int numSamples)
+    {
+        if (!prepared || numSamples <= 0)
+        {
+            for (int c = 0; c < numChannels; ++c)
+                if (inputs[c] != outputs[c])
+                    std::copy(inputs[c], inputs[c] + std::max(numSamples, 0), outputs[c]);
+            return;
+        }
+
+        // Smooth pitch ratio changes per-block (not per-sample, saves CPU)
+        const float smoothingCoeff = 0.9f;
+        pitchRatio = pitchRatio * smoothingCoeff + targetPitchRatio * (1.0f - smoothingCoeff);
+        stretch.setTransposeFactor(pitchRatio);
+
+        const int mask = ringSize - 1;
+        for (int done = 0; done < numSamples;)
+        {
+            const int n = std::min(chunkSize, numSamples - done);
+            for (int c = 0; c < numChannels; ++c)
+                inputPtrs[static_cast<size_t>(c)] = inputs[c] + done;
+
+            // One call analyses and resynthesises every channel together
+            stretch.process(inputPtrs.data(), n, outputPtrs.data(), n);
+
+            if (lookAheadFeed)
+            {
+                // Already aligned with the caller's position - no compensation delay
+                for (int c = 0; c < numChannels; ++c)
+                    std::copy(outputPtrs[static_cast<size_t>(c)], outputPtrs[static_cast<size_t>(c)] + n,
+                              outputs[c] + done);
+                done += n;
+                continue;
+            }
+
+            for (int c = 0; c < numChannels; ++c)
+            {
+                float* ring = latencyRing.data() + static_cast<size_t>(c) * static_cast<size_t>(ringSize);
+                const float* processed = outputPtrs[static_cast<size_t>(c)];
+                float* out = outputs[c] + done;
+
+                for (int i = 0; i < n; ++i)
+                    ring[(latencyWritePos + i) & mask] = processed[i];
+
+                // Read back delayed by totalLatency, clearing as we go
+                for (int i = 0; i < n; ++i)
+                {
+                    float& slot = ring[(latencyReadPos + i) & mask];
+                    out[i] = slot;
+                    slot = 0.0f;
+                }
+            }
+
+            latencyWritePos = (latencyWritePos + n) & mask;
+            latencyReadPos = (latencyReadPos + n) & mask;
+            done += n;
+        }
+    }
+
+    int getLatencySamples() const
+    {
+        if (!prepared)
+            return 0;
+        return totalLatency;
+    }
+
+    int getNumChannels() const { return numChannels; }
+    float getCurrentPitchRatio() const { return pitchRatio; }
+
+private:
+    double sampleRate = 44100.0;
+    int currentMaxBlockSize = 512;
+    int numChannels = 2;
+    float pitchRatio = 1.0f;
+    float targetPitchRatio = 1.0f;
+    bool prepared = false;
+    bool isHighQuality = false;
+    bool lookAheadFeed = false;
+
+    signalsmith::stretch::SignalsmithStretch<float> stretch;
+    int totalLatency = 0;
+
+    int chunkSize = 1024;
+    std::vector<std::vector<float>> outputBuffers;
+    std::vector<const float*> inputPtrs;
+    std::vector<float*> outputPtrs;
+
+    // Latency compensation: numChannels rings of ringSize, shared indices
+    std::vector<float> latencyRing;
+    int ringSize = 0;
+    int latencyWritePos = 0;
+    int latencyReadPos = 0;
+};
+
 /**
  * StereoBlockPitchShifter - Efficient stereo block-based pitch shifting
  *
- * Processes both channels in blocks for maximum efficiency.
+ * Processes both channels in blocks through one two-channel MultichannelBlockPitchShifter
+ * (a single stretch instance, so the stereo image stays phase-coherent).
  * Use this for layer playback where entire blocks are available.
  *
- * Supports quality switching via setHighQuality() for per-layer HQ mode.
+ * Supports quality switching via setHighQuality(), which re-prepares (allocates) - loop
+ * layers never call it on the audio thread; PitchShifterPool prepares shifters in each
+ * quality and a layer crossfades to one of the other quality when HQ is toggled.
  */
 class StereoBlockPitchShifter
 {
@@ -317,55 +522,67 @@ public:
 
     void prepare(double sampleRate, int maxBlockSize, bool highQuality = false)
     {
-        shifterL.prepare(sampleRate, maxBlockSize, highQuality);
-        shifterR.prepare(sampleRate, maxBlockSize, highQuality);
+        shifter.prepare(sampleRate, maxBlockSize, 2, highQuality);
     }
 
     void reset()
     {
-        shifterL.reset();
-        shifterR.reset();
+        shifter.reset();
     }
 
     void setPitchRatio(float ratio)
     {
-        shifterL.setPitchRatio(ratio);
-        shifterR.setPitchRatio(ratio);
+        shifter.setPitchRatio(ratio);
     }
 
-    // Set quality mode (triggers re-prepare internally if changed)
+    // Set quality mode (triggers re-prepare internally if changed - allocates)
     void setHighQuality(bool highQuality)
     {
-        shifterL.setHighQuality(highQuality);
-        shifterR.setHighQuality(highQuality);
+        shifter.setHighQuality(highQuality);
     }
 
     bool getHighQuality() const
     {
-        return shifterL.getHighQuality();
+        return shifter.getHighQuality();
     }
 
     // Process stereo block - much more efficient than sample-by-sample
     void processBlock(const float* inputL, const float* inputR,
                       float* outputL, float* outputR, int numSamples)
     {
-        shifterL.processBlock(inputL, outputL, numSamples);
-        shifterR.processBlock(inputR, outputR, numSamples);
+        const float* inputs[2] = { inputL, inputR };
+        float* outputs[2] = { outputL, outputR };
+        shifter.processBlock(inputs, outputs, numSamples);
     }
 
     int getLatencySamples() const
     {
-        return shifterL.getLatencySamples();
+        return shifter.getLatencySamples();
+    }
+
+    // See MultichannelBlockPitchShifter: feed getLookAheadSamples() ahead, get aligned output
+    void setLookAheadFeed(bool enabled)
+    {
+        shifter.setLookAheadFeed(enabled);
+    }
+
+    bool isLookAheadFeed() const
+    {
+        return shifter.isLookAheadFeed();
+    }
+
+    int getLookAheadSamples() const
+    {
+        return shifter.getLookAheadSamples();
     }
 
     float getCurrentPitchRatio() const
     {
-        return shifterL.getCurrentPitchRatio();
+        return shifter.getCurrentPitchRatio();
     }
 
 private:
-    BlockPitchShifter shifterL;
-    BlockPitchShifter shifterR;
+    MultichannelBlockPitchShifter shifter;
 };
 
 /**
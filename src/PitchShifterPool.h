@@ -0,0 +1,218 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "PhaseVocoder.h"
+#include <array>
+#include <atomic>
+#include <memory>
+
+/**
+ * PitchShifterPool - Per-engine pool of pitch shifters leased by pitched layers
+ *
+ * Every layer used to own a StereoBlockPitchShifter (playback) and a StereoPhaseVocoder
+ * (overdub monitoring), all prepared up front: four Signalsmith stretch engines and their
+ * FFT buffers per layer, 32 per engine, even with nothing pitched. Layers now lease a
+ * Shifter (both processors) from this pool on the first block they play off unity pitch
+ * and hand it back after a tail-out once they return to unity.
+ *
+ * The pool only grows to what is used: the engine reports how many layers are set off
+ * unity (setDemand(), called from setLayerPitch/setPitchShift) and a low-priority
+ * background thread prepares shifters until that many plus SPARE_SHIFTERS exist, so a
+ * lease on the audio thread normally finds one ready. Handed-back shifters are reset on
+ * that thread before they are leased again. Shifters are kept until the next prepare()
+ * (high-water mark), because the audio thread may be scanning them at any time.
+ *
+ * Each shifter is prepared once in one quality preset (standard or HQ) and never
+ * re-prepared, so a layer's HQ toggle costs no allocation on the audio thread: the layer
+ * leases a shifter of the new quality - prepared here, on demand - primes it from its
+ * own feed and crossfades over to it. Demand is counted per quality; standard shifters also keep
+ * SPARE_SHIFTERS ready, HQ ones are prepared as layers ask for them.
+ *
+ * lease() and release() are lock-free and safe from any render thread. When no shifter
+ * is free lease() returns nullptr and the layer plays unpitched (or keeps its current
+ * quality) until one is ready.
+ */
+class PitchShifterPool : private juce::Thread
+{
+public:
+    static constexpr int MAX_LAYERS = 8;
+    static constexpr int SPARE_SHIFTERS = 1;  // Prepared, unleased standard shifters kept ready for the audio thread
+
+    // Every layer can hold its playback shifter plus the incoming one of the other quality
+    // during an HQ switch, on top of the spares. Shifters are never re-prepared, so a
+    // further MAX_LAYERS covers shifters left idle in the quality layers have moved away
+    // from while demand for the other one peaks.
+    static constexpr int MAX_SHIFTERS = 2 * MAX_LAYERS + SPARE_SHIFTERS + MAX_LAYERS;
+
+    class Shifter
+    {
+    public:
+        StereoBlockPitchShifter block;    // Block playback
+        StereoPhaseVocoder perSample;     // Sample-by-sample paths (overdub monitoring)
+
+        void reset()
+        {
+            block.reset();
+            perSample.reset();
+        }
+
+        // Fixed when the pool prepares the shifter
+        bool isHighQuality() const { return highQuality; }
+
+    private:
+        friend class PitchShifterPool;
+
+        bool highQuality = false;
+        enum class SlotState { Free = 0, Leased, Retired };
+        std::atomic<SlotState> slotState { SlotState::Free };
+    };
+
+    PitchShifterPool() : juce::Thread("PitchShifterPool") {}
+
+    ~PitchShifterPool() override
+    {
+        stopThread(2000);
+    }
+
+    // Drop every shifter, prepare SPARE_SHIFTERS for the new format and start the
+    // maintenance thread. Must be called before the audio thread starts (from
+    // prepareToPlay), after every layer has handed its shifter back.
+    void prepare(double newSampleRate, int newMaxBlockSize)
+    {
+        stopThread(2000);
+
+        jassert(getNumLeased() == 0);
+        numShifters.store(0);
+        for (auto& shifter : shifters)
+            shifter.reset();
+
+        sampleRate = newSampleRate;
+        maxBlockSize = newMaxBlockSize;
+
+        for (auto& d : demand)
+            d.store(0);
+        leaseMisses.store(0);
+        topUp();
+        startThread(juce::Thread::Priority::low);
+    }
+
+    // Number of layers that want a shifter of each quality right now (any thread, lock-free).
+    // The maintenance thread prepares shifters until that many (plus spares) exist.
+    void setDemand(int numStandardLayers, int numHighQualityLayers)
+    {
+        demand[0].store(juce::jlimit(0, MAX_LAYERS, numStandardLayers));
+        demand[1].store(juce::jlimit(0, MAX_LAYERS, numHighQualityLayers));
+    }
+
+    // Audio thread: take a reset shifter of the given quality, or nullptr if none is free yet
+    Shifter* lease(bool highQuality)
+    {
+        const int count = numShifters.load(std::memory_order_acquire);
+        for (int i = 0; i < count; ++i)
+        {
+            Shifter* shifter = shifters[static_cast<size_t>(i)].get();
+            if (shifter->highQuality != highQuality)
+                continue;
+
+            auto expected = Shifter::SlotState::Free;
+            if (shifter->slotState.compare_exchange_strong(expected, Shifter::SlotState::Leased))
+                return shifter;
+        }
+
+        leaseMisses.fetch_add(1);
+        return nullptr;
+    }
+
+    // Any thread: hand a shifter back. It is reset on the maintenance thread.
+    void release(Shifter* shifter)
+    {
+        if (shifter != nullptr)
+            shifter->slotState.store(Shifter::SlotState::Retired);
+    }
+
+    int getNumShifters() const { return numShifters.load(); }
+
+    int getNumLeased() const
+    {
+        int leased = 0;
+        const int count = numShifters.load(std::memory_order_acquire);
+        for (int i = 0; i < count; ++i)
+            if (shifters[static_cast<size_t>(i)]->slotState.load() == Shifter::SlotState::Leased)
+                ++leased;
+        return leased;
+    }
+
+    // How often a layer wanted a shifter and found none free (it played unpitched meanwhile)
+    int getLeaseMissCount() const { return leaseMisses.load(); }
+
+private:
+    std::array<std::unique_ptr<Shifter>, MAX_SHIFTERS> shifters;
+    std::atomic<int> numShifters { 0 };   // Published with release once a new shifter is prepared
+    std::array<std::atomic<int>, 2> demand {};   // Standard, HQ
+    std::atomic<int> leaseMisses { 0 };
+
+    // Only touched by prepare() while the maintenance thread is stopped, then by that thread
+    double sampleRate = 44100.0;
+    int maxBlockSize = 512;
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            recycleRetired();
+            topUp();
+            wait(10);
+        }
+    }
+
+    // Reset handed-back shifters before they are leased again
+    void recycleRetired()
+    {
+        const int count = numShifters.load(std::memory_order_acquire);
+        for (int i = 0; i < count; ++i)
+        {
+            Shifter* shifter = shifters[static_cast<size_t>(i)].get();
+            if (shifter->slotState.load() != Shifter::SlotState::Retired)
+                continue;
+
+            shifter->reset();
+            shifter->slotState.store(Shifter::SlotState::Free);
+        }
+    }
+
+    // Prepare shifters until every pitched layer can hold one of its quality, plus
+    // SPARE_SHIFTERS standard ones. HQ is checked first: a layer waiting on it is mid-toggle.
+    void topUp()
+    {
+        for (;;)
+        {
+            const int count = numShifters.load();
+            if (count >= MAX_SHIFTERS)
+                return;
+
+            std::array<int, 2> unleased {}, leased {};
+            for (int i = 0; i < count; ++i)
+            {
+                const Shifter& shifter = *shifters[static_cast<size_t>(i)];
+                auto& tally = shifter.slotState.load() == Shifter::SlotState::Leased ? leased : unleased;
+                ++tally[shifter.highQuality ? 1 : 0];
+            }
+
+            const bool needHighQuality = unleased[1] < std::max(demand[1].load() - leased[1], 0);
+            const bool needStandard = unleased[0] < std::max(demand[0].load() - leased[0], 0) + SPARE_SHIFTERS;
+            if (!needHighQuality && !needStandard)
+                return;
+
+            // FFT setup and buffers - the expensive part the audio thread never sees
+            auto shifter = std::make_unique<Shifter>();
+            shifter->highQuality = needHighQuality;
+            shifter->block.prepare(sampleRate, maxBlockSize, needHighQuality);
+            shifter->perSample.prepare(sampleRate);
+
+            shifters[static_cast<size_t>(count)] = std::move(shifter);
+            numShifters.store(count + 1, std::memory_order_release);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PitchShifterPool)
+};
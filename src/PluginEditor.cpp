@@ -76,41 +76,57 @@ LoopEngineEditor::LoopEngineEditor(LoopEngineProcessor& p)
                   .withOptionsFrom(reverbModDepthRelay)
                   .withNativeFunction("loopRecord", [this](const juce::Array<juce::var>&, auto complete)
                   {
-                      processorRef.getLoopEngine().record();
+                      processorRef.getLoopEngine().postCommand({ LoopCommand::Type::Record });
                       complete({});
                   })
                   .withNativeFunction("loopPlay", [this](const juce::Array<juce::var>&, auto complete)
                   {
-                      processorRef.getLoopEngine().play();
+                      processorRef.getLoopEngine().postCommand({ LoopCommand::Type::Play });
                       complete({});
                   })
                   .withNativeFunction("loopStop", [this](const juce::Array<juce::var>&, auto complete)
                   {
-                      processorRef.getLoopEngine().stop();
+                      processorRef.getLoopEngine().postCommand({ LoopCommand::Type::Stop });
                       complete({});
                   })
                   .withNativeFunction("loopOverdub", [this](const juce::Array<juce::var>&, auto complete)
                   {
-                      processorRef.getLoopEngine().overdub();
+                      processorRef.getLoopEngine().postCommand({ LoopCommand::Type::Overdub });
                       complete({});
                   })
                   .withNativeFunction("loopUndo", [this](const juce::Array<juce::var>&, auto complete)
                   {
-                      processorRef.getLoopEngine().undo();
+                      processorRef.getLoopEngine().postCommand({ LoopCommand::Type::Undo });
                       complete({});
                   })
                   .withNativeFunction("loopRedo", [this](const juce::Array<juce::var>&, auto complete)
                   {
-                      processorRef.getLoopEngine().redo();
+                      processorRef.getLoopEngine().postCommand({ LoopCommand::Type::Redo });
                       complete({});
                   })
+                  .withNativeFunction("setTransportQuantize", [this](const juce::Array<juce::var>& args, auto complete)
+                  {
+                      // 0 = off, 1 = beat, 2 = bar, 3 = loop boundary (REC/PLAY/DUB wait for it)
+                      if (args.size() > 0)
+                          processorRef.getLoopEngine().setTransportQuantize(
+                              static_cast<LoopCommand::Quantize>(juce::jlimit(0, 3, static_cast<int>(args[0])) + 1));
+                      complete({});
+                  })
+                  .withNativeFunction("getTransportQuantize", [this](const juce::Array<juce::var>&, auto complete)
+                  {
+                      const auto& loopEngine = processorRef.getLoopEngine();
+                      juce::DynamicObject::Ptr result = new juce::DynamicObject();
+                      result->setProperty("mode", static_cast<int>(loopEngine.getTransportQuantize()) - 1);
+                      result->setProperty("pending", loopEngine.getNumPendingCommands());
+                      complete(juce::var(result.get()));
+                  })
                   .withNativeFunction("setAdditiveModeEnabled", [this](const juce::Array<juce::var>& args, auto complete)
                   {
                       // Toggle ADD+ mode on/off (does NOT start recording)
                       if (args.size() > 0)
                       {
                           bool enabled = static_cast<bool>(args[0]);
-                          processorRef.getLoopEngine().setAdditiveModeEnabled(enabled);
+                          processorRef.getLoopEngine().postCommand({ LoopCommand::Type::SetAdditiveMode, 0, enabled });
                       }
                       complete({});
                   })
@@ -144,15 +160,37 @@ LoopEngineEditor::LoopEngineEditor(LoopEngineProcessor& p)
                   {
                       complete(processorRef.getLoopEngine().isLayerModeEnabled());
                   })
+                  .withNativeFunction("setParallelLayers", [this](const juce::Array<juce::var>& args, auto complete)
+                  {
+                      // Render independent layers on the real-time worker pool (output is unchanged)
+                      if (args.size() > 0)
+                          processorRef.getLoopEngine().setParallelLayerRendering(static_cast<bool>(args[0]));
+                      complete({});
+                  })
+                  .withNativeFunction("isParallelLayers", [this](const juce::Array<juce::var>&, auto complete)
+                  {
+                      complete(processorRef.getLoopEngine().isParallelLayerRendering());
+                  })
+                  .withNativeFunction("setOutputLimiter", [this](const juce::Array<juce::var>& args, auto complete)
+                  {
+                      // True-peak limiter ahead of the output soft knee (adds ~1.5 ms latency)
+                      if (args.size() > 0)
+                          processorRef.setOutputLimiterEnabled(static_cast<bool>(args[0]));
+                      complete({});
+                  })
+                  .withNativeFunction("isOutputLimiter", [this](const juce::Array<juce::var>&, auto complete)
+                  {
+                      complete(processorRef.getOutputLimiterEnabled());
+                  })
                   .withNativeFunction("loopClear", [this](const juce::Array<juce::var>&, auto complete)
                   {
-                      processorRef.getLoopEngine().clear();
+                      processorRef.getLoopEngine().postCommand({ LoopCommand::Type::Clear });
                       complete({});
                   })
                   .withNativeFunction("loopJumpToLayer", [this](const juce::Array<juce::var>& args, auto complete)
                   {
                       if (args.size() > 0)
-                          processorRef.getLoopEngine().jumpToLayer(static_cast<int>(args[0]) - 1);  // 1-indexed from UI
+                          processorRef.getLoopEngine().postCommand({ LoopCommand::Type::JumpToLayer, static_cast<int>(args[0]) - 1 });  // 1-indexed from UI
                       complete({});
                   })
                   .withNativeFunction("setLayerMuted", [this](const juce::Array<juce::var>& args, auto complete)
@@ -162,7 +200,7 @@ LoopEngineEditor::LoopEngineEditor(LoopEngineProcessor& p)
                           int layer = static_cast<int>(args[0]);
                           bool muted = static_cast<bool>(args[1]);
                           DBG("setLayerMuted native call: layer=" + juce::String(layer) + " muted=" + juce::String(muted ? "true" : "false"));
-                          processorRef.getLoopEngine().setLayerMuted(layer, muted);
+                          processorRef.getLoopEngine().postCommand({ LoopCommand::Type::SetLayerMuted, layer, muted });
                       }
                       complete({});
                   })
@@ -182,7 +220,7 @@ LoopEngineEditor::LoopEngineEditor(LoopEngineProcessor& p)
                       {
                           int layer = static_cast<int>(args[0]);
                           bool soloed = static_cast<bool>(args[1]);
-                          processorRef.getLoopEngine().setLayerSoloed(layer, soloed);
+                          processorRef.getLoopEngine().postCommand({ LoopCommand::Type::SetLayerSoloed, layer, soloed });
                       }
                       complete({});
                   })
@@ -295,7 +333,7 @@ LoopEngineEditor::LoopEngineEditor(LoopEngineProcessor& p)
                       {
                           int layer = static_cast<int>(args[0]);
                           float pos = static_cast<float>(args[1]);
-                          processorRef.getLoopEngine().setLayerLoopStart(layer, pos);
+                          processorRef.getLoopEngine().postCommand({ LoopCommand::Type::SetLayerLoopStart, layer, false, pos });
                       }
                       complete({});
                   })
@@ -305,7 +343,7 @@ LoopEngineEditor::LoopEngineEditor(LoopEngineProcessor& p)
                       {
                           int layer = static_cast<int>(args[0]);
                           float pos = static_cast<float>(args[1]);
-                          processorRef.getLoopEngine().setLayerLoopEnd(layer, pos);
+                          processorRef.getLoopEngine().postCommand({ LoopCommand::Type::SetLayerLoopEnd, layer, false, pos });
                       }
                       complete({});
                   })
@@ -325,6 +363,45 @@ LoopEngineEditor::LoopEngineEditor(LoopEngineProcessor& p)
                           complete(juce::var());
                       }
                   })
+                  .withNativeFunction("getLayerWaveformRange", [this](const juce::Array<juce::var>& args, auto complete)
+                  {
+                      // Args: layer (1-indexed), startSample, endSample, width (points)
+                      // Zoomable peak data for loop start/end editing, served from the layer's peak pyramid
+                      if (args.size() >= 4)
+                      {
+                          int layer = static_cast<int>(args[0]);
+                          int startSample = static_cast<int>(args[1]);
+                          int endSample = static_cast<int>(args[2]);
+                          int width = juce::jlimit(1, 8192, static_cast<int>(args[3]));
+
+                          auto& engine = processorRef.getLoopEngine();
+                          const auto peaks = engine.getLayerWaveformRange(layer, startSample, endSample, width);
+
+                          juce::Array<juce::var> minArray, maxArray, peakArray;
+                          minArray.ensureStorageAllocated(width);
+                          maxArray.ensureStorageAllocated(width);
+                          peakArray.ensureStorageAllocated(width);
+                          for (const auto& point : peaks)
+                          {
+                              minArray.add(point.min);
+                              maxArray.add(point.max);
+                              peakArray.add(point.peak);
+                          }
+
+                          juce::DynamicObject::Ptr result = new juce::DynamicObject();
+                          result->setProperty("length", engine.getLayerWaveformLength(layer));
+                          result->setProperty("start", startSample);
+                          result->setProperty("end", endSample);
+                          result->setProperty("min", minArray);
+                          result->setProperty("max", maxArray);
+                          result->setProperty("peak", peakArray);
+                          complete(juce::var(result.get()));
+                      }
+                      else
+                      {
+                          complete(juce::var());
+                      }
+                  })
                   // Per-layer reverse
                   .withNativeFunction("setLayerReverse", [this](const juce::Array<juce::var>& args, auto complete)
                   {
@@ -332,7 +409,7 @@ LoopEngineEditor::LoopEngineEditor(LoopEngineProcessor& p)
                       {
                           int layer = static_cast<int>(args[0]);
                           bool reversed = static_cast<bool>(args[1]);
-                          processorRef.getLoopEngine().setLayerReverse(layer, reversed);
+                          processorRef.getLoopEngine().postCommand({ LoopCommand::Type::SetLayerReverse, layer, reversed });
                       }
                       complete({});
                   })
@@ -433,12 +510,9 @@ LoopEngineEditor::LoopEngineEditor(LoopEngineProcessor& p)
                           bool reversed = static_cast<bool>(args[0]);
                           DBG("Parsed reversed value: " + juce::String(reversed ? "TRUE" : "FALSE"));
 
-                          // Set directly on loop engine
-                          processorRef.getLoopEngine().setReverse(reversed);
-                          DBG("Called loopEngine.setReverse(" + juce::String(reversed ? "true" : "false") + ")");
-
-                          // Verify engine state
-                          DBG("Engine isReversed now: " + juce::String(processorRef.getLoopEngine().getIsReversed() ? "TRUE" : "FALSE"));
+                          // Queue for the loop engine (applied at the start of the next block)
+                          processorRef.getLoopEngine().postCommand({ LoopCommand::Type::SetReverse, 0, reversed });
+                          DBG("Posted SetReverse(" + juce::String(reversed ? "true" : "false") + ")");
 
                           // Also update the APVTS parameter
                           if (auto* param = processorRef.getAPVTS().getParameter("loopReverse"))
@@ -463,7 +537,7 @@ LoopEngineEditor::LoopEngineEditor(LoopEngineProcessor& p)
                   {
                       DBG("resetLoopParams called");
                       // Reset loop parameters to defaults (called when UI opens)
-                      processorRef.getLoopEngine().resetLoopParams();
+                      processorRef.getLoopEngine().postCommand({ LoopCommand::Type::ResetLoopParams });
 
                       // Also reset the APVTS parameters to trigger UI updates
                       if (auto* param = processorRef.getAPVTS().getParameter("loopStart"))
@@ -498,6 +572,7 @@ LoopEngineEditor::LoopEngineEditor(LoopEngineProcessor& p)
                       result->setProperty("loopLength", loopEngine.getLoopLengthSeconds());
                       result->setProperty("hasContent", loopEngine.hasContent());
                       result->setProperty("isReversed", loopEngine.getIsReversed());
+                      result->setProperty("memoryExhausted", loopEngine.isLoopMemoryExhausted());
 
                       // Add per-layer playhead positions for accurate layer-specific visualization
                       juce::Array<juce::var> layerPlayheads;
@@ -852,7 +927,7 @@ LoopEngineEditor::LoopEngineEditor(LoopEngineProcessor& p)
                       if (args.size() > 0)
                       {
                           int layer = static_cast<int>(args[0]);
-                          processorRef.getLoopEngine().clearLayer(layer);
+                          processorRef.getLoopEngine().postCommand({ LoopCommand::Type::ClearLayer, layer });
                       }
                       complete({});
                   })
@@ -861,13 +936,13 @@ LoopEngineEditor::LoopEngineEditor(LoopEngineProcessor& p)
                       if (args.size() > 0)
                       {
                           int layer = static_cast<int>(args[0]);
-                          processorRef.getLoopEngine().deleteLayer(layer);
+                          processorRef.getLoopEngine().postCommand({ LoopCommand::Type::DeleteLayer, layer });
                       }
                       complete({});
                   })
                   .withNativeFunction("flattenLayers", [this](const juce::Array<juce::var>&, auto complete)
                   {
-                      processorRef.getLoopEngine().flattenLayers();
+                      processorRef.getLoopEngine().postCommand({ LoopCommand::Type::Flatten });
                       complete({});
                   })
                   .withNativeFunction("getLayerContentStates", [this](const juce::Array<juce::var>&, auto complete)
@@ -905,6 +980,38 @@ LoopEngineEditor::LoopEngineEditor(LoopEngineProcessor& p)
 
                       complete(juce::var(result.get()));
                   })
+                  .withNativeFunction("getLoopMemoryStats", [this](const juce::Array<juce::var>&, auto complete)
+                  {
+                      // Loop storage usage for this instance and across all instances in the process
+                      auto& loopEngine = processorRef.getLoopEngine();
+                      auto& memoryManager = loopEngine.getLoopMemoryManager();
+                      constexpr double bytesPerMB = 1024.0 * 1024.0;
+
+                      juce::DynamicObject::Ptr result = new juce::DynamicObject();
+                      result->setProperty("instanceMB", static_cast<double>(loopEngine.getLoopMemoryBytes()) / bytesPerMB);
+                      result->setProperty("totalMB", static_cast<double>(memoryManager.getTotalBytesInUse()) / bytesPerMB);
+                      result->setProperty("budgetMB", static_cast<double>(memoryManager.getBudgetBytes()) / bytesPerMB);
+                      result->setProperty("numInstances", memoryManager.getNumClients());
+                      result->setProperty("exhausted", loopEngine.isLoopMemoryExhausted());
+
+                      juce::Array<juce::var> instanceUsage;
+                      for (auto bytes : memoryManager.getClientUsage())
+                          instanceUsage.add(static_cast<double>(bytes) / bytesPerMB);
+                      result->setProperty("instanceUsageMB", instanceUsage);
+
+                      complete(juce::var(result.get()));
+                  })
+                  .withNativeFunction("setLoopMemoryBudget", [this](const juce::Array<juce::var>& args, auto complete)
+                  {
+                      // Args: budget in MB (process-wide, shared by all instances, persisted)
+                      if (args.size() >= 1)
+                      {
+                          const double budgetMB = static_cast<double>(args[0]);
+                          processorRef.getLoopEngine().getLoopMemoryManager()
+                              .setBudgetBytes(static_cast<juce::int64>(budgetMB * 1024.0 * 1024.0));
+                      }
+                      complete({});
+                  })
                   .withNativeFunction("resetAudioDiagnostics", [this](const juce::Array<juce::var>&, auto complete)
                   {
                       auto& loopEngine = processorRef.getLoopEngine();
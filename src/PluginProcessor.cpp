@@ -1,5 +1,6 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "RealtimeSafety.h"
 #include <algorithm>
 
 LoopEngineProcessor::LoopEngineProcessor()
@@ -634,6 +635,10 @@ void LoopEngineProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
     // Prepare micro looper
     microLooper.prepare(sampleRate, samplesPerBlock);
 
+    // Prepare output safety stage (limiter lookahead depends on the sample rate)
+    outputStage.prepare(sampleRate, samplesPerBlock);
+    setLatencySamples(outputStage.getLatencySamples());
+
     // Pre-allocate processing buffers to avoid allocation on audio thread
     loopPlaybackBuffer.setSize(2, samplesPerBlock);
     inputPassthroughBuffer.setSize(2, samplesPerBlock);
@@ -682,6 +687,9 @@ bool LoopEngineProcessor::isBusesLayoutSupported(const BusesLayout& layouts) con
 
 void LoopEngineProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    // No-op in the plugin; the RT-check build traps allocations, locks and I/O from here on
+    LOOPENGINE_AUDIO_THREAD_SCOPE();
+
     juce::ignoreUnused(midiMessages);
 
     juce::ScopedNoDenormals noDenormals;
@@ -701,6 +709,11 @@ void LoopEngineProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
                 loopEngine.setHostBpm(bpm);
             }
 
+            // Host timeline for quantized transport commands (beat/bar grid while no loop plays)
+            const auto ppq = posInfo->getPpqPosition();
+            loopEngine.setHostPosition(posInfo->getIsPlaying() && ppq.hasValue(), ppq.orFallback(0.0),
+                                       posInfo->getPpqPositionOfLastBarStart().orFallback(0.0));
+
             // Track host playing state for transport sync
             bool hostPlaying = posInfo->getIsPlaying();
             bool wasPlaying = lastHostPlaying.exchange(hostPlaying);
@@ -951,27 +964,18 @@ void LoopEngineProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
 
     // Final safety pass: sanitize any NaN/Inf values and apply soft limiting
     // This prevents buzzing from bad data after state transitions (STOP, etc.)
-    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-    {
-        float* data = buffer.getWritePointer(ch);
-        for (int i = 0; i < numSamples; ++i)
-        {
-            float sample = data[i];
+    outputStage.process(buffer, numSamples);
+}
 
-            // Check for NaN or Inf - reset to zero
-            if (std::isnan(sample) || std::isinf(sample))
-            {
-                data[i] = 0.0f;
-                continue;
-            }
+void LoopEngineProcessor::setOutputLimiterEnabled(bool enabled)
+{
+    outputStage.setLimiterEnabled(enabled);
+    setLatencySamples(outputStage.getLatencySamples());
+}
 
-            // Soft limit extreme values to prevent harsh clipping
-            if (std::abs(sample) > 0.95f)
-            {
-                data[i] = std::tanh(sample * 1.2f) * 0.95f;
-            }
-        }
-    }
+bool LoopEngineProcessor::getOutputLimiterEnabled() const
+{
+    return outputStage.isLimiterEnabled();
 }
 
 void LoopEngineProcessor::setTempoSync(bool enabled)
@@ -9,6 +9,7 @@
 #include "SubBassProcessor.h"
 #include "ReverbProcessor.h"
 #include "MicroLooper.h"
+#include "OutputSafetyStage.h"
 
 class LoopEngineProcessor : public juce::AudioProcessor
 {
@@ -104,6 +105,10 @@ public:
     bool getHostTransportSync() const;
     bool isHostPlaying() const;
 
+    // Output true-peak limiter (adds a few samples of latency, reported to the host)
+    void setOutputLimiterEnabled(bool enabled);
+    bool getOutputLimiterEnabled() const;
+
     // Loop engine access
     LoopEngine& getLoopEngine() { return loopEngine; }
     const LoopEngine& getLoopEngine() const { return loopEngine; }
@@ -121,6 +126,7 @@ private:
     SubBassProcessor subBassProcessor;
     ReverbProcessor reverbProcessor;
     MicroLooper microLooper;
+    OutputSafetyStage outputStage;
 
     // Parameter pointers for efficient access
     std::atomic<float>* delayTimeParam = nullptr;
@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+ * RealtimeSafety - Marks the audio callback for the real-time safety checker
+ *
+ * LOOPENGINE_AUDIO_THREAD_SCOPE() compiles to nothing in the plugin. The
+ * LoopEngineRTCheck target (see tools/rtcheck) builds with LOOPENGINE_RT_CHECK=1 and
+ * traps every heap allocation/free, mutex acquisition and file I/O made on a thread
+ * while a scope is open, printing the call stack of each distinct violation.
+ */
+#if LOOPENGINE_RT_CHECK
+
+namespace RealtimeSafety
+{
+    // Implemented in tools/rtcheck/RealtimeSafetyChecker.cpp
+    void enterAudioThreadScope() noexcept;
+    void exitAudioThreadScope() noexcept;
+
+    struct ScopedAudioThread
+    {
+        ScopedAudioThread() noexcept { enterAudioThreadScope(); }
+        ~ScopedAudioThread() noexcept { exitAudioThreadScope(); }
+
+        ScopedAudioThread(const ScopedAudioThread&) = delete;
+        ScopedAudioThread& operator=(const ScopedAudioThread&) = delete;
+    };
+}
+
+#define LOOPENGINE_AUDIO_THREAD_SCOPE() const RealtimeSafety::ScopedAudioThread loopEngineAudioThreadScope
+
+#else
+
+#define LOOPENGINE_AUDIO_THREAD_SCOPE()
+
+#endif
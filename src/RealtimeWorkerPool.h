@@ -0,0 +1,191 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+/**
+ * RealtimeWorkerPool - Fork/join helper threads for work inside the audio callback
+ *
+ * The audio thread hands a batch of independent items (task(context, 0..numItems-1)) to
+ * the pool with run(), works on the batch itself and returns once every item is done.
+ * Workers are real-time threads (JUCE RealtimeOptions, period = one audio block) with no
+ * core affinity - pinning them would fight the host's own audio threads for fixed cores.
+ *
+ * One pool is shared by every engine in the process (SharedResourcePointer), so N plugin
+ * instances don't start N sets of real-time threads. Only one batch runs at a time: an
+ * engine whose run() finds another engine's batch in flight renders its items serially
+ * rather than wait for it.
+ *
+ * Nothing on the audio side locks or allocates:
+ *   - items are claimed with a CAS on one 64-bit word holding (batch generation << 32 |
+ *     next item), so a worker that wakes late can never claim an item of a newer batch
+ *   - workers sleep in std::atomic::wait on the generation; run() bumps it and calls
+ *     notify_all (a futex wake, and a no-op when nobody is waiting)
+ *   - completion is an atomic counter the audio thread spins on after it runs out of
+ *     items to claim, so the wait is at most one item long
+ *
+ * With no workers (single/dual core machines, or before start()) run() is a plain loop.
+ */
+class RealtimeWorkerPool
+{
+public:
+    using Task = void (*)(void* context, int index);
+
+    static constexpr int MAX_WORKERS = 3;
+
+    RealtimeWorkerPool() = default;
+    ~RealtimeWorkerPool() { stop(); }
+
+    // Message thread (prepareToPlay); periodMs is the audio block duration. The first
+    // engine to prepare starts the workers, later calls keep them - other engines may be
+    // running batches. Leaves two cores for the host.
+    void start(double periodMs)
+    {
+        const juce::ScopedLock lock(startLock);
+        if (started)
+            return;
+        started = true;
+
+        const int numCpus = juce::SystemStats::getNumCpus();
+        const int numThreads = juce::jlimit(0, MAX_WORKERS, numCpus - 2);
+
+        for (int i = 0; i < numThreads; ++i)
+        {
+            auto worker = std::make_unique<Worker>(*this, i);
+            if (!worker->startRealtimeThread(juce::Thread::RealtimeOptions{}.withPeriodMs(periodMs)))
+                break;  // No real-time scheduling here - fewer (or no) workers, never normal-priority ones
+            workers[static_cast<size_t>(i)] = std::move(worker);
+            numWorkers.store(i + 1, std::memory_order_release);
+        }
+    }
+
+    int getNumWorkers() const { return numWorkers.load(std::memory_order_acquire); }
+
+    // Audio thread: run task(context, i) for every i in [0, numItems), in any order and on
+    // any thread, and return when all have finished.
+    void run(Task task, void* context, int numItems) noexcept
+    {
+        if (numItems <= 1 || getNumWorkers() == 0 || batchInFlight.exchange(true, std::memory_order_acquire))
+        {
+            for (int i = 0; i < numItems; ++i)
+                task(context, i);
+            return;
+        }
+
+        batchTask = task;
+        batchContext = context;
+        batchSize.store(numItems, std::memory_order_relaxed);
+        itemsDone.store(0, std::memory_order_relaxed);
+
+        const std::uint32_t gen = generation.load(std::memory_order_relaxed) + 1;
+        nextClaim.store(static_cast<std::uint64_t>(gen) << 32, std::memory_order_release);
+        generation.store(gen, std::memory_order_release);
+        generation.notify_all();
+
+        workOn(gen);
+
+        while (itemsDone.load(std::memory_order_acquire) < numItems)
+            pause();
+
+        batchInFlight.store(false, std::memory_order_release);
+    }
+
+private:
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(RealtimeWorkerPool& ownerRef, int index)
+            : juce::Thread("LayerWorker " + juce::String(index + 1)), owner(ownerRef) {}
+
+        void run() override
+        {
+            std::uint32_t seen = owner.generation.load(std::memory_order_acquire);
+            for (;;)
+            {
+                owner.generation.wait(seen, std::memory_order_acquire);
+                if (owner.shouldExit.load())
+                    return;
+
+                seen = owner.generation.load(std::memory_order_acquire);
+                owner.workOn(seen);
+            }
+        }
+
+    private:
+        RealtimeWorkerPool& owner;
+    };
+
+    // Claim and run items of batch gen until none are left (or a newer batch has started)
+    void workOn(std::uint32_t gen) noexcept
+    {
+        for (;;)
+        {
+            std::uint64_t claim = nextClaim.load(std::memory_order_acquire);
+            if (static_cast<std::uint32_t>(claim >> 32) != gen)
+                return;
+
+            // May read a newer batch's size if this one just ended - the CAS then fails
+            const int index = static_cast<int>(claim & 0xffffffffu);
+            if (index >= batchSize.load(std::memory_order_acquire))
+                return;
+
+            if (!nextClaim.compare_exchange_weak(claim, claim + 1, std::memory_order_acq_rel))
+                continue;
+
+            // A claimed item keeps the batch open, so task/context are still this batch's
+            batchTask(batchContext, index);
+            itemsDone.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    // Last engine released the shared pool
+    void stop()
+    {
+        const int count = getNumWorkers();
+        if (count == 0)
+            return;
+
+        shouldExit.store(true);
+        generation.fetch_add(1, std::memory_order_release);
+        generation.notify_all();
+
+        for (int i = 0; i < count; ++i)
+            workers[static_cast<size_t>(i)]->stopThread(2000);
+        for (auto& worker : workers)
+            worker.reset();
+
+        numWorkers.store(0);
+    }
+
+    static void pause() noexcept
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && (defined (__aarch64__) || defined (_M_ARM64))
+        __asm__ __volatile__ ("yield");
+       #endif
+    }
+
+    juce::CriticalSection startLock;
+    bool started = false;
+    std::array<std::unique_ptr<Worker>, MAX_WORKERS> workers;
+    std::atomic<int> numWorkers { 0 };
+    std::atomic<bool> batchInFlight { false };  // One engine's batch owns the workers
+
+    Task batchTask = nullptr;
+    void* batchContext = nullptr;
+    std::atomic<int> batchSize { 0 };
+    std::atomic<int> itemsDone { 0 };
+    std::atomic<std::uint64_t> nextClaim { 0 };
+    std::atomic<std::uint32_t> generation { 0 };
+    std::atomic<bool> shouldExit { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeWorkerPool)
+};
@@ -37,6 +37,9 @@ public:
         reverb.prepare(spec);
         reverb.reset();  // Clear any stale data in reverb buffers
 
+        // Dry copy scratch - sized here so processBlock never allocates
+        dryBuffer.setSize(2, samplesPerBlock);
+
         // Bypass gain smoother
         bypassGain.reset(sampleRate, 0.050);
         bypassGain.setCurrentAndTargetValue(0.0f);
@@ -88,8 +91,9 @@ public:
         // Update reverb parameters from smoothed values
         updateReverbParams();
 
-        // Store dry signal
-        juce::AudioBuffer<float> dryBuffer(numChannels, numSamples);
+        // Store dry signal (grows only if the host exceeds the prepared block size)
+        if (dryBuffer.getNumSamples() < numSamples || dryBuffer.getNumChannels() < numChannels)
+            dryBuffer.setSize(numChannels, numSamples, false, false, true);
         for (int ch = 0; ch < numChannels; ++ch)
             dryBuffer.copyFrom(ch, 0, buffer, ch, 0, numSamples);
 
@@ -203,6 +207,7 @@ private:
 
     // JUCE's high-quality reverb
     juce::dsp::Reverb reverb;
+    juce::AudioBuffer<float> dryBuffer;  // Dry signal scratch, sized in prepare()
 
     // Bypass
     juce::SmoothedValue<float> bypassGain;
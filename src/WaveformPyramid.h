@@ -0,0 +1,334 @@
+#pragma once
+
+#include "LoopStorage.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+/**
+ * WaveformPyramid - Incremental multi-resolution peak summary of one loop layer
+ *
+ * Level 0 holds one min/max/peak entry per BLOCK_SIZE samples; every level above
+ * halves the resolution, up to a single entry for the whole buffer. The audio thread
+ * marks samples as it writes them and flush() recomputes only the touched blocks
+ * (plus their parents), so keeping the summary current costs a few hundred samples
+ * of reading per block of audio, independent of loop length.
+ *
+ * Queries combine at most ~2 entries per level, so drawing N points costs O(N log)
+ * entries instead of a rescan of the recorded audio on every UI poll. Points of at most
+ * MAX_EXACT_SCAN samples (zoomed far in) read the audio directly from the chunk spans;
+ * anything wider uses the pyramid at block resolution.
+ *
+ * Entries are written on the audio thread and read on the message thread without a
+ * lock. Readers never reach freed memory: all levels live in one buffer allocated in
+ * prepare(), and swapWith() hands buffers over by exchanging the pointer readers load
+ * (each buffer stays owned by one of the two pyramids). Zoomed-in scans hold a
+ * LoopChunkPool::ReadPin, so no chunk is zeroed or freed under them. A point read while
+ * the audio thread rewrites it can still mix old and new values - one stale point for
+ * one frame.
+ */
+class WaveformPyramid
+{
+public:
+    static constexpr int BLOCK_SHIFT = 8;
+    static constexpr int BLOCK_SIZE = 1 << BLOCK_SHIFT;  // 256 samples (~5ms at 48kHz)
+    static constexpr int MAX_EXACT_SCAN = 32;            // Widest point read sample by sample
+
+    struct Peak
+    {
+        float min = 0.0f;   // Lowest mid ((L+R)/2) sample
+        float max = 0.0f;   // Highest mid sample
+        float peak = 0.0f;  // Highest (|L|+|R|)/2 - the envelope the UI draws
+
+        void merge(const Peak& other) noexcept
+        {
+            min = std::min(min, other.min);
+            max = std::max(max, other.max);
+            peak = std::max(peak, other.peak);
+        }
+    };
+
+    WaveformPyramid() = default;
+
+    // Allocate every level for maxSamples. Called from prepare(), never on the audio thread.
+    void prepare(const LoopStorage& sourceStorage, int maxSamples)
+    {
+        source = &sourceStorage;
+        maxSampleCount = maxSamples;
+
+        levelOffsets.clear();
+        levelSizes.clear();
+        int levelSize = std::max(1, (maxSamples + BLOCK_SIZE - 1) >> BLOCK_SHIFT);
+        int totalEntries = 0;
+        for (;;)
+        {
+            levelOffsets.push_back(totalEntries);
+            levelSizes.push_back(levelSize);
+            totalEntries += levelSize;
+            if (levelSize == 1)
+                break;
+            levelSize = (levelSize + 1) >> 1;
+        }
+
+        ownedEntries.assign(static_cast<size_t>(totalEntries), Peak {});
+        entries.store(ownedEntries.data());
+
+        reset();
+    }
+
+    // Forget everything in O(1) - entries past writtenBlocks are never read
+    void reset() noexcept
+    {
+        writtenBlocks.store(0);
+        dirtyFirst = -1;
+        dirtyLast = -1;
+    }
+
+    // Note that the sample at index was written. Audio thread, called per sample.
+    void markWritten(int index) noexcept
+    {
+        const int block = index >> BLOCK_SHIFT;
+        if (dirtyFirst >= 0 && block >= dirtyFirst - 1 && block <= dirtyLast + 1)
+        {
+            dirtyFirst = std::min(dirtyFirst, block);
+            dirtyLast = std::max(dirtyLast, block);
+            return;
+        }
+
+        // Non-contiguous write (loop wrap) - settle the pending range first
+        flush();
+        dirtyFirst = block;
+        dirtyLast = block;
+    }
+
+    // Note that numSamples contiguous samples from start were written (block writers)
+    void markWrittenRange(int start, int numSamples) noexcept
+    {
+        if (numSamples <= 0)
+            return;
+
+        markWritten(start);
+        dirtyLast = std::max(dirtyLast, (start + numSamples - 1) >> BLOCK_SHIFT);
+    }
+
+    // Recompute the blocks touched since the last flush. Audio thread, once per block.
+    void flush() noexcept
+    {
+        Peak* const base = entries.load(std::memory_order_relaxed);
+        if (dirtyFirst < 0 || source == nullptr || base == nullptr)
+            return;
+
+        int first = dirtyFirst;
+        int last = std::min(dirtyLast, levelSizes[0] - 1);
+        dirtyFirst = -1;
+        dirtyLast = -1;
+
+        // Blocks skipped between the old high-water mark and this write hold stale
+        // entries from a previous take - recompute them too (silent chunks are free)
+        const int written = writtenBlocks.load();
+        if (first > written)
+            first = written;
+
+        Peak* const blocks = base + levelOffsets[0];
+        for (int b = first; b <= last; ++b)
+            blocks[b] = computeBlock(b);
+
+        const int newWritten = std::max(written, last + 1);
+
+        for (size_t level = 1; level < levelSizes.size(); ++level)
+        {
+            first >>= 1;
+            last >>= 1;
+            const Peak* children = base + levelOffsets[level - 1];
+            Peak* parents = base + levelOffsets[level];
+            const int validChildren = validCount(newWritten, static_cast<int>(level) - 1);
+
+            for (int p = first; p <= last; ++p)
+            {
+                Peak parent = children[p * 2];
+                if (p * 2 + 1 < validChildren)
+                    parent.merge(children[p * 2 + 1]);
+                parents[p] = parent;
+            }
+        }
+
+        writtenBlocks.store(newWritten);
+    }
+
+    // Recompute the first numSamples from scratch (after bulk edits like flatten or DC removal)
+    void rebuild(int numSamples) noexcept
+    {
+        reset();
+        if (numSamples <= 0)
+            return;
+
+        dirtyFirst = 0;
+        dirtyLast = (std::min(numSamples, maxSampleCount) - 1) >> BLOCK_SHIFT;
+        flush();
+    }
+
+    // Duplicate another layer's summary (buffers are the same size, so nothing is allocated)
+    void copyFrom(const WaveformPyramid& other)
+    {
+        jassert(ownedEntries.size() == other.ownedEntries.size());
+        std::copy(other.ownedEntries.begin(), other.ownedEntries.end(), ownedEntries.begin());
+
+        writtenBlocks.store(other.writtenBlocks.load());
+        dirtyFirst = other.dirtyFirst;
+        dirtyLast = other.dirtyLast;
+    }
+
+    // Exchange summaries in O(1), alongside LoopStorage::swapWith(). Both were prepared for
+    // the same size, so only the buffers change hands - the level layout a reader uses stays.
+    void swapWith(WaveformPyramid& other) noexcept
+    {
+        jassert(maxSampleCount == other.maxSampleCount);
+        ownedEntries.swap(other.ownedEntries);
+        entries.store(ownedEntries.data());
+        other.entries.store(other.ownedEntries.data());
+        std::swap(dirtyFirst, other.dirtyFirst);
+        std::swap(dirtyLast, other.dirtyLast);
+
+        const int written = writtenBlocks.load();
+        writtenBlocks.store(other.writtenBlocks.load());
+        other.writtenBlocks.store(written);
+    }
+
+    // Combined peak over [start, end), at block resolution. O(log(range)) entries.
+    Peak getRange(int start, int end) const noexcept
+    {
+        Peak result;
+        const Peak* const base = entries.load();
+        if (base == nullptr || end <= start)
+            return result;
+
+        const int written = writtenBlocks.load();
+        int first = std::max(0, start) >> BLOCK_SHIFT;
+        int last = std::min((end + BLOCK_SIZE - 1) >> BLOCK_SHIFT, written);  // Exclusive
+
+        // Canonical segment-tree walk: take the odd edges at each level, then move up
+        for (size_t level = 0; level < levelSizes.size() && first < last; ++level)
+        {
+            const Peak* levelEntries = base + levelOffsets[level];
+            if (first & 1)
+                result.merge(levelEntries[first++]);
+            if (last & 1)
+                result.merge(levelEntries[--last]);
+            first >>= 1;
+            last >>= 1;
+        }
+        return result;
+    }
+
+    // Fill numPoints evenly spaced peaks covering [start, end). Wide points come from the
+    // pyramid; points of at most MAX_EXACT_SCAN samples are scanned from the audio.
+    void getPeaks(int start, int end, int numPoints, Peak* out) const noexcept
+    {
+        const juce::int64 range = static_cast<juce::int64>(end - start);
+        const bool sampleResolution = range <= static_cast<juce::int64>(numPoints) * MAX_EXACT_SCAN;
+
+        // Sample-resolution points dereference chunks this thread doesn't own
+        const LoopChunkPool::ReadPin pin(sampleResolution && source != nullptr ? source->getPool() : nullptr);
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const int pointStart = start + static_cast<int>(range * i / numPoints);
+            const int pointEnd = std::max(start + static_cast<int>(range * (i + 1) / numPoints), pointStart + 1);
+            out[i] = sampleResolution ? scanRange(pointStart, pointEnd) : getRange(pointStart, pointEnd);
+        }
+    }
+
+    int getWrittenSamples() const noexcept
+    {
+        return std::min(writtenBlocks.load() << BLOCK_SHIFT, maxSampleCount);
+    }
+
+private:
+    const LoopStorage* source = nullptr;
+    int maxSampleCount = 0;
+    std::vector<Peak> ownedEntries;         // Every level back to back, allocated in prepare()
+    std::atomic<Peak*> entries { nullptr }; // ownedEntries.data() - what readers load
+    std::vector<int> levelOffsets;          // levelOffsets[0] = per-block, back() = whole buffer
+    std::vector<int> levelSizes;
+
+    std::atomic<int> writtenBlocks { 0 };   // Level-0 entries that hold current data
+    int dirtyFirst = -1;                    // Audio thread only: blocks awaiting flush()
+    int dirtyLast = -1;
+
+    static int validCount(int blocks, int level) noexcept
+    {
+        return (blocks + (1 << level) - 1) >> level;
+    }
+
+    // Exact peak over a short range, read straight from the chunk spans. Callers keep the
+    // range to MAX_EXACT_SCAN samples (clamped here too so a stray call stays cheap) and
+    // hold a ReadPin on the source's pool.
+    Peak scanRange(int start, int end) const noexcept
+    {
+        Peak result;
+        start = std::max(0, start);
+        end = std::min({ end, getWrittenSamples(), start + MAX_EXACT_SCAN });
+        if (source == nullptr || end <= start)
+            return result;
+
+        bool first = true;
+        for (int pos = start; pos < end;)
+        {
+            int span = 0;
+            const float* left = source->getReadSpan(0, pos, span);
+            const float* right = source->getReadSpan(1, pos, span);
+            const int length = std::min(span, end - pos);
+
+            if (left == nullptr || right == nullptr)
+            {
+                // Uncommitted chunk - silence
+                result.merge(Peak {});
+                first = false;
+                pos += length;
+                continue;
+            }
+
+            if (first)
+                result.min = result.max = (left[0] + right[0]) * 0.5f;
+            first = false;
+
+            for (int i = 0; i < length; ++i)
+            {
+                const float mid = (left[i] + right[i]) * 0.5f;
+                result.min = std::min(result.min, mid);
+                result.max = std::max(result.max, mid);
+                result.peak = std::max(result.peak, (std::abs(left[i]) + std::abs(right[i])) * 0.5f);
+            }
+            pos += length;
+        }
+        return result;
+    }
+
+    Peak computeBlock(int block) const noexcept
+    {
+        const int start = block << BLOCK_SHIFT;
+        const int length = std::min(BLOCK_SIZE, maxSampleCount - start);
+
+        // Blocks never straddle a storage chunk, so one span covers the whole block
+        int span = 0;
+        const float* left = source->getReadSpan(0, start, span);
+        const float* right = source->getReadSpan(1, start, span);
+
+        Peak result;
+        if (left == nullptr || right == nullptr)
+            return result;  // Never written - silence
+
+        result.min = result.max = (left[0] + right[0]) * 0.5f;
+        for (int i = 0; i < length; ++i)
+        {
+            const float mid = (left[i] + right[i]) * 0.5f;
+            result.min = std::min(result.min, mid);
+            result.max = std::max(result.max, mid);
+            result.peak = std::max(result.peak, (std::abs(left[i]) + std::abs(right[i])) * 0.5f);
+        }
+        return result;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformPyramid)
+};
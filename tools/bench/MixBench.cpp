@@ -0,0 +1,231 @@
+/**
+ * LoopEngineMixBench - Fused output mix vs the previous multi-pass mix
+ *
+ * Times OutputMixKernel::mixChannel() against a reference copy of the mix stage it
+ * replaced in LoopEngine::processBlock (per-layer peak/clip scans, addFrom/copyFrom per
+ * layer into the output and loop-only buses, input subtraction, bounce add, input
+ * passthrough, pre-clip and loop peak scans, soft clip), on synthetic layers. Also
+ * reports the largest sample difference between the two, which should be 0.
+ *
+ * Usage: LoopEngineMixBench [numLayers] [blockSize] [iterations]
+ */
+#include "OutputMixKernel.h"
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    constexpr int NUM_CHANNELS = 2;
+    constexpr int MAX_LAYERS = 64;
+
+    struct BenchLayer
+    {
+        juce::AudioBuffer<float> audio;
+        bool recording = false;
+        float peak = 0.0f;
+        int clips = 0;
+    };
+
+    struct Totals
+    {
+        float preClipL = 0.0f, preClipR = 0.0f, loopL = 0.0f, loopR = 0.0f;
+        int clips = 0;
+    };
+
+    // The multi-pass mix stage as it was (Track mode, playback input monitored)
+    Totals mixMultiPass(std::vector<BenchLayer>& layers, const juce::AudioBuffer<float>& input,
+                        juce::AudioBuffer<float>& out, juce::AudioBuffer<float>& loopOnly, int numSamples)
+    {
+        out.clear();
+        loopOnly.clear();
+        bool inputAdded = false;
+
+        for (auto& layer : layers)
+        {
+            int layerClips = 0;
+            float layerPeak = 0.0f;
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+            {
+                const float* data = layer.audio.getReadPointer(ch);
+                for (int s = 0; s < numSamples; ++s)
+                {
+                    const float absVal = std::abs(data[s]);
+                    if (absVal > layerPeak) layerPeak = absVal;
+                    if (absVal > 1.0f) layerClips++;
+                }
+            }
+            layer.peak = layerPeak;
+            layer.clips = layerClips;
+
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+                out.addFrom(ch, 0, layer.audio, ch, 0, numSamples);
+
+            if (!layer.recording)
+            {
+                for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+                    loopOnly.addFrom(ch, 0, layer.audio, ch, 0, numSamples);
+            }
+            else
+            {
+                inputAdded = true;
+                for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+                {
+                    const float* layerData = layer.audio.getReadPointer(ch);
+                    const float* inputData = input.getReadPointer(ch);
+                    float* loopOnlyData = loopOnly.getWritePointer(ch);
+                    for (int s = 0; s < numSamples; ++s)
+                        loopOnlyData[s] += layerData[s] - inputData[s];
+                }
+            }
+        }
+
+        if (!inputAdded)
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+                out.addFrom(ch, 0, input, ch, 0, numSamples);
+
+        Totals totals;
+        for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+        {
+            const float* data = out.getReadPointer(ch);
+            float& peak = ch == 0 ? totals.preClipL : totals.preClipR;
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float absVal = std::abs(data[i]);
+                if (absVal > peak) peak = absVal;
+                if (absVal > 1.0f) totals.clips++;
+            }
+        }
+        for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+        {
+            const float* data = loopOnly.getReadPointer(ch);
+            float& peak = ch == 0 ? totals.loopL : totals.loopR;
+            for (int i = 0; i < numSamples; ++i)
+                peak = std::max(peak, std::abs(data[i]));
+        }
+        for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+        {
+            float* data = out.getWritePointer(ch);
+            for (int i = 0; i < numSamples; ++i)
+                data[i] = OutputMixKernel::softClip(data[i]);
+        }
+        return totals;
+    }
+
+    Totals mixFused(std::vector<BenchLayer>& layers, const juce::AudioBuffer<float>& input,
+                    juce::AudioBuffer<float>& out, juce::AudioBuffer<float>& loopOnly, int numSamples,
+                    std::vector<OutputMixKernel::Meter>& meters)
+    {
+        const int numSources = static_cast<int>(layers.size());
+        bool inputAdded = false;
+        for (int k = 0; k < numSources; ++k)
+        {
+            meters[static_cast<size_t>(k)].reset();
+            inputAdded = inputAdded || layers[static_cast<size_t>(k)].recording;
+        }
+
+        Totals totals;
+        std::array<OutputMixKernel::Source, MAX_LAYERS> sources;
+        for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+        {
+            for (int k = 0; k < numSources; ++k)
+            {
+                auto& source = sources[static_cast<size_t>(k)];
+                source.data = layers[static_cast<size_t>(k)].audio.getReadPointer(ch);
+                source.loopPortion = layers[static_cast<size_t>(k)].recording ? OutputMixKernel::LoopPortion::MinusInput
+                                                                              : OutputMixKernel::LoopPortion::Whole;
+            }
+
+            const auto result = OutputMixKernel::mixChannel(
+                sources.data(), meters.data(), numSources, OutputMixKernel::MixMode::Sum,
+                inputAdded ? OutputMixKernel::InputMode::None : OutputMixKernel::InputMode::Add,
+                input.getReadPointer(ch), nullptr, false,
+                out.getWritePointer(ch), loopOnly.getWritePointer(ch), numSamples);
+
+            (ch == 0 ? totals.preClipL : totals.preClipR) = result.outputPeak;
+            (ch == 0 ? totals.loopL : totals.loopR) = result.loopPeak;
+            totals.clips += result.outputClips;
+        }
+
+        for (int k = 0; k < numSources; ++k)
+        {
+            layers[static_cast<size_t>(k)].peak = meters[static_cast<size_t>(k)].peak();
+            layers[static_cast<size_t>(k)].clips = meters[static_cast<size_t>(k)].clips();
+        }
+        return totals;
+    }
+
+    template <typename Fn>
+    double nanosPerBlock(int iterations, Fn&& fn)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+            fn();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int numLayers = juce::jlimit(1, MAX_LAYERS, argc > 1 ? std::atoi(argv[1]) : 8);
+    const int blockSize = argc > 2 ? std::atoi(argv[2]) : 512;
+    const int iterations = argc > 3 ? std::atoi(argv[3]) : 20000;
+
+    juce::Random random(1234);
+    juce::AudioBuffer<float> input(NUM_CHANNELS, blockSize);
+    for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+            input.setSample(ch, i, random.nextFloat() * 0.4f - 0.2f);
+
+    // Layer 1 is overdubbing; levels are high enough that some samples clip
+    std::vector<BenchLayer> layers(static_cast<size_t>(numLayers));
+    for (int k = 0; k < numLayers; ++k)
+    {
+        auto& layer = layers[static_cast<size_t>(k)];
+        layer.audio.setSize(NUM_CHANNELS, blockSize);
+        layer.recording = (k == 1);
+        for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                layer.audio.setSample(ch, i, (random.nextFloat() * 2.0f - 1.0f) * 0.35f
+                                                 + (layer.recording ? input.getSample(ch, i) : 0.0f));
+    }
+
+    juce::AudioBuffer<float> outRef(NUM_CHANNELS, blockSize), loopRef(NUM_CHANNELS, blockSize);
+    juce::AudioBuffer<float> outFused(NUM_CHANNELS, blockSize), loopFused(NUM_CHANNELS, blockSize);
+    std::vector<OutputMixKernel::Meter> meters(static_cast<size_t>(numLayers));
+
+    const Totals ref = mixMultiPass(layers, input, outRef, loopRef, blockSize);
+    std::vector<float> refPeaks;
+    for (const auto& layer : layers)
+        refPeaks.push_back(layer.peak);
+    const Totals fused = mixFused(layers, input, outFused, loopFused, blockSize, meters);
+
+    float maxDiff = 0.0f;
+    for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+        {
+            maxDiff = std::max(maxDiff, std::abs(outRef.getSample(ch, i) - outFused.getSample(ch, i)));
+            maxDiff = std::max(maxDiff, std::abs(loopRef.getSample(ch, i) - loopFused.getSample(ch, i)));
+        }
+    for (int k = 0; k < numLayers; ++k)
+        maxDiff = std::max(maxDiff, std::abs(refPeaks[static_cast<size_t>(k)] - layers[static_cast<size_t>(k)].peak));
+    const bool metersMatch = ref.clips == fused.clips && ref.preClipL == fused.preClipL
+                          && ref.preClipR == fused.preClipR && ref.loopL == fused.loopL && ref.loopR == fused.loopR;
+
+    const double multiPassNs = nanosPerBlock(iterations, [&] { mixMultiPass(layers, input, outRef, loopRef, blockSize); });
+    const double fusedNs = nanosPerBlock(iterations, [&] { mixFused(layers, input, outFused, loopFused, blockSize, meters); });
+
+    std::printf("LoopEngineMixBench: %d layers, %d-sample stereo blocks, %d iterations\n", numLayers, blockSize, iterations);
+    std::printf("  multi-pass  %9.1f ns/block\n", multiPassNs);
+    std::printf("  fused       %9.1f ns/block  (%.2fx)\n", fusedNs, multiPassNs / fusedNs);
+    std::printf("  max sample difference %g, meters %s\n", static_cast<double>(maxDiff), metersMatch ? "match" : "DIFFER");
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * LoopEngineOutputStageBench - Output safety stage vs the previous per-sample safety loop
+ *
+ * Times OutputSafetyStage::process() (limiter off, then on) against a reference copy of
+ * the loop it replaced at the end of LoopEngineProcessor::processBlock (std::isnan/std::isinf
+ * per sample, std::tanh above 0.95), on a hot synthetic signal with a few NaN/Inf samples.
+ * Also reports the largest difference between the two with the limiter off (the fastTanh
+ * approximation error, scaled by the 0.95 knee), the worst fastTanh error over a sweep,
+ * and the largest sample the limiter lets through.
+ *
+ * Usage: LoopEngineOutputStageBench [blockSize] [iterations]
+ */
+#include "OutputSafetyStage.h"
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+namespace
+{
+    constexpr int NUM_CHANNELS = 2;
+    constexpr double SAMPLE_RATE = 48000.0;
+
+    // The safety loop as it was
+    void safetyLoop(juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            float* data = buffer.getWritePointer(ch);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                float sample = data[i];
+                if (std::isnan(sample) || std::isinf(sample))
+                {
+                    data[i] = 0.0f;
+                    continue;
+                }
+                if (std::abs(sample) > 0.95f)
+                    data[i] = std::tanh(sample * 1.2f) * 0.95f;
+            }
+        }
+    }
+
+    template <typename Fn>
+    double nanosPerBlock(int iterations, Fn&& fn)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+            fn();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int blockSize = juce::jmax(1, argc > 1 ? std::atoi(argv[1]) : 512);
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 20000;
+
+    // Loud enough that a good share of samples goes through the knee
+    juce::Random random(1234);
+    juce::AudioBuffer<float> source(NUM_CHANNELS, blockSize);
+    for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+            source.setSample(ch, i, 1.6f * std::sin(0.05f * static_cast<float>(i + ch))
+                                        + (random.nextFloat() - 0.5f) * 0.2f);
+    source.setSample(0, blockSize / 3, std::numeric_limits<float>::quiet_NaN());
+    source.setSample(1, blockSize / 2, std::numeric_limits<float>::infinity());
+
+    juce::AudioBuffer<float> ref, work;
+    ref.makeCopyOf(source);
+    work.makeCopyOf(source);
+
+    OutputSafetyStage stage;
+    stage.prepare(SAMPLE_RATE, blockSize);
+
+    safetyLoop(ref, blockSize);
+    stage.process(work, blockSize);
+
+    float maxDiff = 0.0f;
+    for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+            maxDiff = std::max(maxDiff, std::abs(ref.getSample(ch, i) - work.getSample(ch, i)));
+
+    double maxTanhError = 0.0;
+    for (int i = -80000; i <= 80000; ++i)
+    {
+        const float x = static_cast<float>(i) * 1.0e-4f;
+        maxTanhError = std::max(maxTanhError, std::abs(static_cast<double>(OutputSafetyStage::fastTanh(x))
+                                                       - std::tanh(static_cast<double>(x))));
+    }
+
+    const double loopNs = nanosPerBlock(iterations, [&] {
+        ref.makeCopyOf(source, true);
+        safetyLoop(ref, blockSize);
+    });
+    const double stageNs = nanosPerBlock(iterations, [&] {
+        work.makeCopyOf(source, true);
+        stage.process(work, blockSize);
+    });
+
+    // Limiter on: the knee then only ever sees samples that are already below the ceiling
+    stage.setLimiterEnabled(true);
+    for (int i = 0; i < 64; ++i)  // Let the toggle crossfade finish
+    {
+        work.makeCopyOf(source, true);
+        stage.process(work, blockSize);
+    }
+    float limitedPeak = 0.0f;
+    const double limiterNs = nanosPerBlock(iterations, [&] {
+        work.makeCopyOf(source, true);
+        stage.process(work, blockSize);
+        limitedPeak = std::max(limitedPeak, work.getMagnitude(0, blockSize));
+    });
+
+    std::printf("LoopEngineOutputStageBench: %d-sample stereo blocks, %d iterations\n", blockSize, iterations);
+    std::printf("  per-sample loop   %9.1f ns/block\n", loopNs);
+    std::printf("  safety stage      %9.1f ns/block  (%.2fx)\n", stageNs, loopNs / stageNs);
+    std::printf("  + TP limiter      %9.1f ns/block  (%d samples latency)\n", limiterNs, stage.getLatencySamples());
+    std::printf("  max sample difference %g, fastTanh max error %g, limited peak %g\n",
+                static_cast<double>(maxDiff), maxTanhError, static_cast<double>(limitedPeak));
+    return 0;
+}
@@ -0,0 +1,219 @@
+/**
+ * LoopEnginePitchShiftBench - Two-channel stretch instance vs a pair of mono shifters
+ *
+ * Times StereoBlockPitchShifter (one MultichannelBlockPitchShifter driving a single
+ * two-channel SignalsmithStretch) against the pair of mono BlockPitchShifters it replaced,
+ * per layer, in both quality presets.
+ *
+ * Also checks inter-channel phase coherence: the input is a sine with a fixed phase
+ * offset between left and right; after pitch shifting, the phase difference between the
+ * output channels at the shifted frequency is measured over consecutive windows. The
+ * spread of that difference across windows is the stereo-image drift. A mono-compatible
+ * input (right = left) must also come out with identical channels.
+ *
+ * Usage: LoopEnginePitchShiftBench [blockSize] [semitones] [seconds]
+ */
+#include "PhaseVocoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    constexpr double SAMPLE_RATE = 48000.0;
+    constexpr double TEST_FREQUENCY = 440.0;
+    constexpr double PHASE_OFFSET = 1.0471975511965976;  // pi/3 between left and right
+    constexpr double PI = 3.14159265358979323846;
+    constexpr int WINDOW = 4096;
+
+    // The previous StereoBlockPitchShifter: two independent mono instances
+    struct MonoPair
+    {
+        BlockPitchShifter left, right;
+
+        void prepare(double sampleRate, int maxBlockSize, bool highQuality)
+        {
+            left.prepare(sampleRate, maxBlockSize, highQuality);
+            right.prepare(sampleRate, maxBlockSize, highQuality);
+        }
+
+        void setPitchRatio(float ratio)
+        {
+            left.setPitchRatio(ratio);
+            right.setPitchRatio(ratio);
+        }
+
+        void processBlock(const float* inL, const float* inR, float* outL, float* outR, int numSamples)
+        {
+            left.processBlock(inL, outL, numSamples);
+            right.processBlock(inR, outR, numSamples);
+        }
+
+        int getLatencySamples() const { return left.getLatencySamples(); }
+    };
+
+    struct Signal
+    {
+        std::vector<float> left, right;
+    };
+
+    Signal makeSine(int numSamples, double offset)
+    {
+        Signal s;
+        s.left.resize(static_cast<size_t>(numSamples));
+        s.right.resize(static_cast<size_t>(numSamples));
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double phase = 2.0 * PI * TEST_FREQUENCY * i / SAMPLE_RATE;
+            s.left[static_cast<size_t>(i)] = static_cast<float>(0.5 * std::sin(phase));
+            s.right[static_cast<size_t>(i)] = static_cast<float>(0.5 * std::sin(phase + offset));
+        }
+        return s;
+    }
+
+    template <typename Shifter>
+    Signal run(Shifter& shifter, const Signal& input, int blockSize, float ratio)
+    {
+        const int numSamples = static_cast<int>(input.left.size());
+        Signal out;
+        out.left.assign(input.left.size(), 0.0f);
+        out.right.assign(input.right.size(), 0.0f);
+
+        shifter.setPitchRatio(ratio);
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            const int n = std::min(blockSize, numSamples - start);
+            shifter.processBlock(input.left.data() + start, input.right.data() + start,
+                                 out.left.data() + start, out.right.data() + start, n);
+        }
+        return out;
+    }
+
+    double wrap(double phase)
+    {
+        return std::remainder(phase, 2.0 * PI);
+    }
+
+    struct Coherence
+    {
+        double meanOffset = 0.0;   // Average right-minus-left phase at the shifted frequency
+        double drift = 0.0;        // Standard deviation of that offset across windows
+        double maxDeviation = 0.0; // Largest window offset away from the mean
+    };
+
+    // Demodulate both channels at the shifted frequency per window, skipping the
+    // shifter's latency plus half a second of settling
+    Coherence measureCoherence(const Signal& out, double frequency, int skip)
+    {
+        std::vector<double> offsets;
+        const int numSamples = static_cast<int>(out.left.size());
+        const double w = 2.0 * PI * frequency / SAMPLE_RATE;
+
+        for (int start = skip; start + WINDOW <= numSamples; start += WINDOW)
+        {
+            std::complex<double> zl, zr;
+            for (int i = start; i < start + WINDOW; ++i)
+            {
+                const std::complex<double> osc = std::polar(1.0, -w * i);
+                zl += static_cast<double>(out.left[static_cast<size_t>(i)]) * osc;
+                zr += static_cast<double>(out.right[static_cast<size_t>(i)]) * osc;
+            }
+            offsets.push_back(std::arg(zr * std::conj(zl)));
+        }
+
+        Coherence c;
+        if (offsets.empty())
+            return c;
+
+        // Circular mean, then spread around it
+        std::complex<double> sum;
+        for (const double o : offsets)
+            sum += std::polar(1.0, o);
+        c.meanOffset = std::arg(sum);
+
+        double sq = 0.0;
+        for (const double o : offsets)
+        {
+            const double d = wrap(o - c.meanOffset);
+            sq += d * d;
+            c.maxDeviation = std::max(c.maxDeviation, std::abs(d));
+        }
+        c.drift = std::sqrt(sq / static_cast<double>(offsets.size()));
+        return c;
+    }
+
+    float maxChannelDifference(const Signal& out)
+    {
+        float maxDiff = 0.0f;
+        for (size_t i = 0; i < out.left.size(); ++i)
+            maxDiff = std::max(maxDiff, std::abs(out.left[i] - out.right[i]));
+        return maxDiff;
+    }
+
+    template <typename Shifter>
+    double nanosPerBlock(Shifter& shifter, const Signal& input, int blockSize, float ratio)
+    {
+        std::vector<float> outL(static_cast<size_t>(blockSize)), outR(static_cast<size_t>(blockSize));
+        const int numBlocks = static_cast<int>(input.left.size()) / blockSize;
+
+        shifter.setPitchRatio(ratio);
+        const auto start = std::chrono::steady_clock::now();
+        for (int b = 0; b < numBlocks; ++b)
+            shifter.processBlock(input.left.data() + b * blockSize, input.right.data() + b * blockSize,
+                                 outL.data(), outR.data(), blockSize);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / std::max(numBlocks, 1);
+    }
+
+    template <typename Shifter>
+    void report(const char* name, bool highQuality, int blockSize, float ratio, int numSamples)
+    {
+        const double shiftedFrequency = TEST_FREQUENCY * ratio;
+
+        Shifter timing;
+        timing.prepare(SAMPLE_RATE, blockSize, highQuality);
+        const double ns = nanosPerBlock(timing, makeSine(numSamples, PHASE_OFFSET), blockSize, ratio);
+
+        Shifter stereo;
+        stereo.prepare(SAMPLE_RATE, blockSize, highQuality);
+        const Signal wide = run(stereo, makeSine(numSamples, PHASE_OFFSET), blockSize, ratio);
+        const int skip = stereo.getLatencySamples() + static_cast<int>(SAMPLE_RATE / 2);
+        const Coherence c = measureCoherence(wide, shiftedFrequency, skip);
+
+        Shifter mono;
+        mono.prepare(SAMPLE_RATE, blockSize, highQuality);
+        const Signal centred = run(mono, makeSine(numSamples, 0.0), blockSize, ratio);
+
+        std::printf("  %-28s %9.1f ns/block  (%.2f%% of a block)  phase offset %+.3f rad (in %+.3f), "
+                    "drift %.4f rad, max dev %.4f rad, mono L-R %g\n",
+                    name, ns, 100.0 * ns / (1.0e9 * blockSize / SAMPLE_RATE),
+                    c.meanOffset, PHASE_OFFSET, c.drift, c.maxDeviation,
+                    static_cast<double>(maxChannelDifference(centred)));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int blockSize = std::max(16, argc > 1 ? std::atoi(argv[1]) : 512);
+    const float semitones = argc > 2 ? static_cast<float>(std::atof(argv[2])) : 7.0f;
+    const double seconds = argc > 3 ? std::atof(argv[3]) : 10.0;
+
+    const float ratio = std::pow(2.0f, semitones / 12.0f);
+    const int numSamples = static_cast<int>(seconds * SAMPLE_RATE);
+
+    std::printf("LoopEnginePitchShiftBench: %d-sample stereo blocks, %+.1f semitones, %.1f s per run\n",
+                blockSize, static_cast<double>(semitones), seconds);
+
+    for (const bool highQuality : { false, true })
+    {
+        std::printf(" %s preset\n", highQuality ? "default (HQ)" : "cheaper");
+        report<MonoPair>("2 x mono BlockPitchShifter", highQuality, blockSize, ratio, numSamples);
+        report<StereoBlockPitchShifter>("1 x two-channel stretch", highQuality, blockSize, ratio, numSamples);
+    }
+    return 0;
+}
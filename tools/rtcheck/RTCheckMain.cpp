@@ -0,0 +1,175 @@
+/**
+ * LoopEngineRTCheck - Headless real-time safety run of LoopEngineProcessor
+ *
+ * Drives the processor through scripted record/overdub/parallel/layer-mode/ADD+/quantized/
+ * flatten scenarios with a synthetic input signal. Transport commands are posted from this
+ * (message) thread between blocks, exactly like the WebView native functions, and
+ * applied inside the next processBlock, which runs inside LOOPENGINE_AUDIO_THREAD_SCOPE(),
+ * so anything the audio path (commands included) allocates, locks or reads/writes on
+ * disk is reported with its stack.
+ *
+ * Usage: LoopEngineRTCheck [sampleRate] [blockSize]
+ * Exit code is 0 when no violations were found, 1 otherwise.
+ */
+#include "PluginProcessor.h"
+#include "RealtimeSafetyChecker.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+namespace
+{
+    struct Step
+    {
+        const char* description;
+        std::function<void(LoopEngine&)> action;  // Issued before the blocks run (may be empty)
+        double seconds;                           // Audio to process after the action
+    };
+
+    struct Scenario
+    {
+        const char* name;
+        std::vector<Step> steps;
+    };
+
+    // Queue a command the way the native functions do; it runs inside the next processBlock
+    std::function<void(LoopEngine&)> post(LoopCommand::Type type, bool flag = false)
+    {
+        return [type, flag](LoopEngine& e) { e.postCommand({ type, 0, flag }); };
+    }
+
+    std::vector<Scenario> buildScenarios()
+    {
+        return {
+            { "record and play", {
+                { "record", post(LoopCommand::Type::Record), 2.0 },
+                { "stop recording", post(LoopCommand::Type::StopRecording), 1.0 },
+                { "stop", post(LoopCommand::Type::Stop), 0.2 },
+                { "play", post(LoopCommand::Type::Play), 2.5 },
+            } },
+            { "overdub layers", {
+                { "overdub layer 2", post(LoopCommand::Type::Overdub), 2.5 },
+                { "overdub layer 3", post(LoopCommand::Type::Overdub), 2.5 },
+                { "play", post(LoopCommand::Type::Play), 1.0 },
+                { "undo", post(LoopCommand::Type::Undo), 0.5 },
+                { "redo", post(LoopCommand::Type::Redo), 0.5 },
+            } },
+            { "parallel layers", {
+                { "parallel on", [](LoopEngine& e) { e.setParallelLayerRendering(true); }, 0.1 },
+                { "overdub", post(LoopCommand::Type::Overdub), 2.5 },
+                { "play", post(LoopCommand::Type::Play), 1.0 },
+                { "parallel off", [](LoopEngine& e) { e.setParallelLayerRendering(false); }, 0.1 },
+            } },
+            { "layer mode bounce", {
+                { "layer mode on", [](LoopEngine& e) { e.setLayerModeEnabled(true); }, 0.1 },
+                { "overdub", post(LoopCommand::Type::Overdub), 2.5 },
+                { "play", post(LoopCommand::Type::Play), 0.5 },
+                { "layer mode off", [](LoopEngine& e) { e.setLayerModeEnabled(false); }, 0.1 },
+            } },
+            { "ADD+ capture", {
+                { "ADD+ on", post(LoopCommand::Type::SetAdditiveMode, true), 0.1 },
+                { "start capture", post(LoopCommand::Type::Overdub), 2.5 },
+                { "ADD+ off", post(LoopCommand::Type::SetAdditiveMode, false), 0.5 },
+            } },
+            { "quantized transport", {
+                { "quantize to bar", [](LoopEngine& e) { e.setTransportQuantize(LoopCommand::Quantize::Bar); }, 0.1 },
+                { "overdub on bar", post(LoopCommand::Type::Overdub), 2.5 },
+                { "play on bar", post(LoopCommand::Type::Play), 2.5 },
+                { "quantize off", [](LoopEngine& e) { e.setTransportQuantize(LoopCommand::Quantize::Off); }, 0.1 },
+            } },
+            { "flatten", {
+                { "flatten", post(LoopCommand::Type::Flatten), 3.0 },
+                { "play", post(LoopCommand::Type::Play), 0.5 },
+            } },
+            { "clear", {
+                { "clear", post(LoopCommand::Type::Clear), 0.5 },
+                { "record again", post(LoopCommand::Type::Record), 1.0 },
+                { "stop recording", post(LoopCommand::Type::StopRecording, true), 1.5 },
+            } },
+        };
+    }
+
+    // Deterministic input: two detuned sines, so every layer has non-trivial content
+    void fillInput(juce::AudioBuffer<float>& buffer, double sampleRate, juce::int64& sampleClock)
+    {
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            const double t = static_cast<double>(sampleClock + i) / sampleRate;
+            const float left = 0.3f * static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * 220.0 * t));
+            const float right = 0.3f * static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * 331.0 * t));
+            buffer.setSample(0, i, left);
+            buffer.setSample(1, i, right);
+        }
+        sampleClock += buffer.getNumSamples();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const double sampleRate = argc > 1 ? std::atof(argv[1]) : 48000.0;
+    const int blockSize = argc > 2 ? std::atoi(argv[2]) : 512;
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    LoopEngineProcessor processor;
+    processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+    juce::int64 sampleClock = 0;
+    auto& engine = processor.getLoopEngine();
+
+    std::printf("LoopEngineRTCheck: %.0f Hz, %d-sample blocks\n", sampleRate, blockSize);
+
+    int scenariosWithViolations = 0;
+    for (const auto& scenario : buildScenarios())
+    {
+        std::printf("\n== %s\n", scenario.name);
+        RealtimeSafetyChecker::resetCounts();
+
+        for (const auto& step : scenario.steps)
+        {
+            // Posted from this thread like the UI's message thread; applied by the next block
+            if (step.action)
+                step.action(engine);
+
+            const int numBlocks = static_cast<int>(std::ceil(step.seconds * sampleRate / blockSize));
+            const int before = RealtimeSafetyChecker::getViolationCount();
+
+            RealtimeSafetyChecker::enable();
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                fillInput(buffer, sampleRate, sampleClock);
+                processor.processBlock(buffer, midi);
+            }
+            RealtimeSafetyChecker::disable();
+
+            // Let the message thread drain anything the audio thread posted
+            juce::MessageManager::getInstance()->runDispatchLoopUntil(1);
+
+            std::printf("   %-18s %d violation(s)\n", step.description,
+                        RealtimeSafetyChecker::getViolationCount() - before);
+        }
+
+        if (RealtimeSafetyChecker::getViolationCount() > 0)
+        {
+            ++scenariosWithViolations;
+            for (int k = 0; k < RealtimeSafetyChecker::NUM_KINDS; ++k)
+            {
+                const auto kind = static_cast<RealtimeSafetyChecker::Kind>(k);
+                if (const int count = RealtimeSafetyChecker::getViolationCount(kind))
+                    std::printf("   -> %d x %s\n", count, RealtimeSafetyChecker::getKindName(kind));
+            }
+        }
+    }
+
+    processor.releaseResources();
+
+    std::printf("\n%s\n", scenariosWithViolations == 0 ? "PASS: no real-time violations"
+                                                      : "FAIL: real-time violations found (stacks above)");
+    return scenariosWithViolations == 0 ? 0 : 1;
+}
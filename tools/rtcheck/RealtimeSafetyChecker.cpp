@@ -0,0 +1,347 @@
+/**
+ * RealtimeSafetyChecker - Traps real-time violations inside LOOPENGINE_AUDIO_THREAD_SCOPE()
+ *
+ * Linux/glibc only. Linked into the LoopEngineRTCheck executable, where these
+ * definitions interpose the libc symbols for the whole process:
+ *
+ *   - malloc/calloc/realloc/free and the aligned variants (operator new/delete and
+ *     juce::HeapBlock both end up here)
+ *   - pthread_mutex_lock / pthread_rwlock_*lock (juce::CriticalSection, std::mutex)
+ *   - open/openat/fopen and read/write on non-stdio descriptors (juce::File I/O)
+ *
+ * A call made while the calling thread has a scope open is a violation. Each distinct
+ * call stack is printed once with its backtrace; getViolationCount() reports the total.
+ * Reporting itself never allocates: stacks are deduplicated in a fixed table and written
+ * with backtrace_symbols_fd().
+ */
+#include "RealtimeSafetyChecker.h"
+#include "RealtimeSafety.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+extern "C"
+{
+    // glibc's own allocator entry points, so the allocation interposers never recurse
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+}
+
+namespace
+{
+    constexpr int MAX_FRAMES = 48;
+    constexpr int MAX_DISTINCT_STACKS = 1024;
+
+    thread_local int scopeDepth = 0;
+    thread_local bool reporting = false;
+
+    std::atomic<bool> checkingEnabled { false };
+    std::atomic<int> violationCounts[RealtimeSafetyChecker::NUM_KINDS] {};
+    std::atomic<unsigned long long> seenStacks[MAX_DISTINCT_STACKS] {};
+
+    const char* kindName(RealtimeSafetyChecker::Kind kind)
+    {
+        switch (kind)
+        {
+            case RealtimeSafetyChecker::Kind::Allocation:   return "heap allocation";
+            case RealtimeSafetyChecker::Kind::Deallocation: return "heap free";
+            case RealtimeSafetyChecker::Kind::Lock:         return "mutex lock";
+            case RealtimeSafetyChecker::Kind::FileIO:       return "file I/O";
+            default:                                        return "unknown";
+        }
+    }
+
+    void writeString(const char* text)
+    {
+        const ssize_t ignored = ::write(STDERR_FILENO, text, std::strlen(text));
+        (void) ignored;
+    }
+
+    // Returns false if this stack was already reported
+    bool markStackSeen(void* const* frames, int numFrames)
+    {
+        unsigned long long hash = 1469598103934665603ull;  // FNV-1a over the return addresses
+        for (int i = 0; i < numFrames; ++i)
+        {
+            hash ^= reinterpret_cast<unsigned long long>(frames[i]);
+            hash *= 1099511628211ull;
+        }
+        if (hash == 0)
+            hash = 1;
+
+        for (int probe = 0; probe < MAX_DISTINCT_STACKS; ++probe)
+        {
+            auto& slot = seenStacks[(hash + static_cast<unsigned long long>(probe)) % MAX_DISTINCT_STACKS];
+            unsigned long long expected = 0;
+            if (slot.compare_exchange_strong(expected, hash))
+                return true;
+            if (expected == hash)
+                return false;
+        }
+        return false;  // Table full - count but stop printing
+    }
+
+    bool shouldTrap()
+    {
+        return scopeDepth > 0 && !reporting && checkingEnabled.load(std::memory_order_relaxed);
+    }
+
+    void reportViolation(RealtimeSafetyChecker::Kind kind, const char* detail)
+    {
+        reporting = true;
+        violationCounts[static_cast<int>(kind)].fetch_add(1);
+
+        void* frames[MAX_FRAMES];
+        const int numFrames = backtrace(frames, MAX_FRAMES);
+        if (markStackSeen(frames, numFrames))
+        {
+            char header[256];
+            std::snprintf(header, sizeof(header), "\n[rtcheck] %s on the audio thread (%s)\n",
+                          kindName(kind), detail);
+            writeString(header);
+            backtrace_symbols_fd(frames + 2, numFrames > 2 ? numFrames - 2 : 0, STDERR_FILENO);
+        }
+        reporting = false;
+    }
+
+    // The next definitions of the interposed symbols (libc's), resolved by enable()
+    // before any scope opens so the interposers never call dlsym on the audio thread
+    struct NextFunctions
+    {
+        int (*mutexLock)(pthread_mutex_t*) = nullptr;
+        int (*rwlockRead)(pthread_rwlock_t*) = nullptr;
+        int (*rwlockWrite)(pthread_rwlock_t*) = nullptr;
+        int (*open)(const char*, int, ...) = nullptr;
+        int (*open64)(const char*, int, ...) = nullptr;
+        int (*openat)(int, const char*, int, ...) = nullptr;
+        FILE* (*fopen)(const char*, const char*) = nullptr;
+        FILE* (*fopen64)(const char*, const char*) = nullptr;
+        ssize_t (*write)(int, const void*, size_t) = nullptr;
+        ssize_t (*read)(int, void*, size_t) = nullptr;
+    };
+
+    NextFunctions next;
+
+    template <typename Fn>
+    Fn resolveNext(Fn& cached, const char* name)
+    {
+        if (cached == nullptr)
+            cached = reinterpret_cast<Fn>(dlsym(RTLD_NEXT, name));
+        return cached;
+    }
+
+    bool isStdioDescriptor(int fd)
+    {
+        return fd == STDIN_FILENO || fd == STDOUT_FILENO || fd == STDERR_FILENO;
+    }
+}
+
+namespace RealtimeSafety
+{
+    void enterAudioThreadScope() noexcept { ++scopeDepth; }
+    void exitAudioThreadScope() noexcept { --scopeDepth; }
+}
+
+namespace RealtimeSafetyChecker
+{
+    void enable()
+    {
+        // backtrace() loads libgcc on first use - do it now, outside any scope
+        void* frames[4];
+        backtrace(frames, 4);
+
+        resolveNext(next.mutexLock, "pthread_mutex_lock");
+        resolveNext(next.rwlockRead, "pthread_rwlock_rdlock");
+        resolveNext(next.rwlockWrite, "pthread_rwlock_wrlock");
+        resolveNext(next.open, "open");
+        resolveNext(next.open64, "open64");
+        resolveNext(next.openat, "openat");
+        resolveNext(next.fopen, "fopen");
+        resolveNext(next.fopen64, "fopen64");
+        resolveNext(next.write, "write");
+        resolveNext(next.read, "read");
+
+        checkingEnabled.store(true);
+    }
+
+    void disable() { checkingEnabled.store(false); }
+
+    int getViolationCount(Kind kind) { return violationCounts[static_cast<int>(kind)].load(); }
+
+    int getViolationCount()
+    {
+        int total = 0;
+        for (int k = 0; k < NUM_KINDS; ++k)
+            total += violationCounts[k].load();
+        return total;
+    }
+
+    void resetCounts()
+    {
+        for (auto& count : violationCounts)
+            count.store(0);
+    }
+
+    const char* getKindName(Kind kind) { return kindName(kind); }
+}
+
+// ============================================
+// Interposed libc entry points
+// ============================================
+
+extern "C"
+{
+    void* malloc(size_t size)
+    {
+        if (shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::Allocation, "malloc/new");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        if (shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::Allocation, "calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* ptr, size_t size)
+    {
+        if (shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::Allocation, "realloc");
+        return __libc_realloc(ptr, size);
+    }
+
+    void free(void* ptr)
+    {
+        if (ptr != nullptr && shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::Deallocation, "free/delete");
+        __libc_free(ptr);
+    }
+
+    void* memalign(size_t alignment, size_t size)
+    {
+        if (shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::Allocation, "memalign");
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        if (shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::Allocation, "aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size)
+    {
+        if (shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::Allocation, "posix_memalign");
+        *result = __libc_memalign(alignment, size);
+        return *result != nullptr ? 0 : 12;  // ENOMEM
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        if (shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::Lock, "pthread_mutex_lock");
+        return resolveNext(next.mutexLock, "pthread_mutex_lock")(mutex);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* lock)
+    {
+        if (shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::Lock, "pthread_rwlock_rdlock");
+        return resolveNext(next.rwlockRead, "pthread_rwlock_rdlock")(lock);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* lock)
+    {
+        if (shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::Lock, "pthread_rwlock_wrlock");
+        return resolveNext(next.rwlockWrite, "pthread_rwlock_wrlock")(lock);
+    }
+
+    int open(const char* path, int flags, ...)
+    {
+        mode_t mode = 0;
+        if ((flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE)
+        {
+            va_list args;
+            va_start(args, flags);
+            mode = static_cast<mode_t>(va_arg(args, int));
+            va_end(args);
+        }
+        if (shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::FileIO, path);
+        return resolveNext(next.open, "open")(path, flags, mode);
+    }
+
+    int open64(const char* path, int flags, ...)
+    {
+        mode_t mode = 0;
+        if ((flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE)
+        {
+            va_list args;
+            va_start(args, flags);
+            mode = static_cast<mode_t>(va_arg(args, int));
+            va_end(args);
+        }
+        if (shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::FileIO, path);
+        return resolveNext(next.open64, "open64")(path, flags, mode);
+    }
+
+    int openat(int dirfd, const char* path, int flags, ...)
+    {
+        mode_t mode = 0;
+        if ((flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE)
+        {
+            va_list args;
+            va_start(args, flags);
+            mode = static_cast<mode_t>(va_arg(args, int));
+            va_end(args);
+        }
+        if (shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::FileIO, path);
+        return resolveNext(next.openat, "openat")(dirfd, path, flags, mode);
+    }
+
+    FILE* fopen(const char* path, const char* mode)
+    {
+        if (shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::FileIO, path);
+        return resolveNext(next.fopen, "fopen")(path, mode);
+    }
+
+    FILE* fopen64(const char* path, const char* mode)
+    {
+        if (shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::FileIO, path);
+        return resolveNext(next.fopen64, "fopen64")(path, mode);
+    }
+
+    ssize_t write(int fd, const void* data, size_t size)
+    {
+        if (!isStdioDescriptor(fd) && shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::FileIO, "write");
+        return resolveNext(next.write, "write")(fd, data, size);
+    }
+
+    ssize_t read(int fd, void* data, size_t size)
+    {
+        if (!isStdioDescriptor(fd) && shouldTrap())
+            reportViolation(RealtimeSafetyChecker::Kind::FileIO, "read");
+        return resolveNext(next.read, "read")(fd, data, size);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+/**
+ * RealtimeSafetyChecker - Control and results of the audio-thread violation trap
+ *
+ * Nothing is trapped until enable() is called, so setup (prepareToPlay, scenario
+ * scripting) can allocate freely. See RealtimeSafetyChecker.cpp for what is trapped.
+ */
+namespace RealtimeSafetyChecker
+{
+    enum class Kind
+    {
+        Allocation = 0,
+        Deallocation,
+        Lock,
+        FileIO
+    };
+
+    constexpr int NUM_KINDS = 4;
+
+    void enable();
+    void disable();
+
+    int getViolationCount();
+    int getViolationCount(Kind kind);
+    void resetCounts();
+
+    const char* getKindName(Kind kind);
+}
@@ -2487,6 +2487,18 @@ class LooperController {
                         }
                     }
 
+                    // Loop memory budget exhausted - recording was closed early / overdub writes dropped
+                    if (typeof state.memoryExhausted !== 'undefined' && state.memoryExhausted !== this.memoryExhausted) {
+                        this.memoryExhausted = state.memoryExhausted;
+                        if (this.recBtn) {
+                            this.recBtn.classList.toggle('memory-exhausted', this.memoryExhausted);
+                            this.recBtn.title = this.memoryExhausted ? 'Loop memory budget exhausted' : '';
+                        }
+                        if (this.memoryExhausted) {
+                            console.warn('[LOOP] Loop memory budget exhausted - free layers or raise the budget');
+                        }
+                    }
+
                     // Update recording time if recording
                     if (this.state === 'recording') {
                         this.updateRecordingTime();